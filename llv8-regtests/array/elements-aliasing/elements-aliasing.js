@@ -0,0 +1,25 @@
+// The stores to the elements must not be reordered with the stores to the
+// length and to the in-object fields, even though they now have different
+// TBAA types.
+var N = 100000;
+
+function foo(a, o, n) {
+    var sum = 0;
+    for (var i = 0; i < n; i++) {
+        a[i & 7] = i;
+        o.x = a.length;
+        if (i % 1000 == 999) a.length = 4;
+        sum += a[i & 3] + o.x;
+        if (a.length < 8) a.push(i, i, i, i);
+    }
+    return sum;
+}
+
+var a = [0, 1, 2, 3, 4, 5, 6, 7];
+var o = { x: 0 };
+var sum = 0;
+for (var i = 0; i < 100; i++) {
+    sum += foo(a, o, N / 100);
+}
+
+print(sum + " " + a.length + " " + o.x);
@@ -0,0 +1,57 @@
+#!/usr/bin/python
+
+import argparse
+import os
+import re
+import subprocess
+
+file_suffix = ".js"
+llv8_options = [
+    "--allow-natives-syntax",
+    "--expose-gc",
+    "--llvm-filter=foo*",
+    "--noturbo",
+    "--noturbo-asm",
+    # Vectorization is opt-in: the loops must lose their interrupt checks
+    # and per-iteration bounds checks first (this implies the hoisting of
+    # the latter, --llvm-bounds-checks-hoisting).
+    "--llvm-drop-loop-stack-checks",
+    ]
+
+# Packed SSE/AVX arithmetic and moves, which only show up in the code of
+# foo() if llvm has vectorized its loop.
+packed_re = re.compile(r"\b(v?(add|sub|mul|div|mov[au])p[sd]|"
+                       r"v?padd[bwdq]|v?psub[bwdq]|v?pmull[dw]|"
+                       r"v?movdq[au]|vbroadcasts[sd]|vpbroadcast[bwdq])\b")
+
+arg_parser = argparse.ArgumentParser(
+    description="Run the vectorization microbenchmarks and report how many "
+    "packed (SIMD) instructions llvm generated for each of them, with the "
+    "stack and bounds checks taken out of the loops (which is opt-in). "
+    "The code is only disassembled by debug builds of d8.")
+arg_parser.add_argument('--filter',
+                        help="Use only tests which have FILTER as a substring")
+arg_parser.add_argument('--src_root',
+                        default=os.path.join(
+                            os.path.dirname(os.path.realpath(__file__)),
+                            "vectorize"),
+                        help="Root directory with tests")
+arg_parser.add_argument('v8_path', help="Debug build of d8")
+args = arg_parser.parse_args()
+
+failed = 0
+for root, dirs, files in os.walk(args.src_root):
+    lst = [root + '/' + i for i in files if i.endswith(file_suffix)]
+    for src_file in sorted(lst):
+        if args.filter and args.filter not in src_file: continue
+        proc = subprocess.Popen([args.v8_path] + llv8_options + [src_file],
+                                stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        (out, err) = proc.communicate()
+        packed = len(packed_re.findall(err))
+        print "%-50s %5d packed instructions" % (
+            os.path.relpath(src_file, args.src_root), packed)
+        if proc.returncode != 0 or packed == 0:
+            failed += 1
+
+print "\n=======RESULTS======="
+print failed, "tests not vectorized (or crashed)"
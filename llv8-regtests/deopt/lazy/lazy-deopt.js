@@ -0,0 +1,24 @@
+// Flags: --allow-natives-syntax
+var N = 10000;
+var o = { x: 1 };
+
+function change(i) {
+    // Runs while the llvmed foo() is on the stack. Adding a property
+    // makes the map of o unstable, and foo() relies on it being stable,
+    // so foo() gets lazily deoptimized when this returns.
+    if (i == N - 10) o.y = 2;
+    return i;
+}
+%NeverOptimizeFunction(change);
+
+function foo(i) {
+    var r = change(i);
+    return r + o.x;
+}
+
+var sum = 0;
+for (var i = 0; i < N; i++) {
+    sum += foo(i);
+}
+
+print(sum + o.y);
@@ -0,0 +1,26 @@
+// The loop branches on an invariant condition, which LoopUnswitch would
+// hoist out of the loop by cloning the body, and the body makes calls
+// that bail out lazily (the call to bar() and the stack check). Their
+// patchpoint ids must not get duplicated.
+function bar(x) {
+    return x + 1;
+}
+%NeverOptimizeFunction(bar);
+
+function foo(n, flag) {
+    var sum = 0;
+    for (var i = 0; i < n; i++) {
+        if (flag) {
+            sum += bar(i);
+        } else {
+            sum -= i;
+        }
+    }
+    return sum;
+}
+
+var acc = 0;
+for (var i = 0; i < 1000; i++) {
+    acc += foo(100, i & 1);
+}
+print(acc);
@@ -0,0 +1,17 @@
+// Reads the arguments straight from the frame, with and without
+// the arguments adaptor in between.
+function foo(a, b) {
+    var sum = 0;
+    for (var i = 0; i < arguments.length; i++) {
+        sum += arguments[i];
+    }
+    return sum * 10 + arguments.length;
+}
+
+var acc = 0;
+for (var i = 0; i < 100000; i++) {
+    acc += foo(i, 1);
+    acc += foo(i);
+    acc += foo(i, 2, 3, 4);
+}
+print(acc);
@@ -0,0 +1,20 @@
+// fn.apply(this, arguments) with more arguments than get a call site of
+// their own, in a hot loop (they go through the runtime, not a deopt).
+function sum() {
+    var s = 0;
+    for (var i = 0; i < arguments.length; i++) {
+        s += arguments[i];
+    }
+    return s * 100 + arguments.length;
+}
+
+function foo() {
+    return sum.apply(this, arguments);
+}
+
+var acc = 0;
+for (var i = 0; i < 100000; i++) {
+    acc += foo(i, 1, 2, 3, 4, 5, 6, 7, 8);
+    acc += foo(i, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+}
+print(acc);
@@ -0,0 +1,22 @@
+// fn.apply(this, arguments) for argument counts around the ones
+// that get a call site of their own, and past them (the runtime).
+function sum() {
+    var s = 0;
+    for (var i = 0; i < arguments.length; i++) {
+        s += arguments[i];
+    }
+    return s * 100 + arguments.length;
+}
+
+function foo() {
+    return sum.apply(this, arguments);
+}
+
+var acc = 0;
+for (var i = 0; i < 100000; i++) {
+    acc += foo();
+    acc += foo(i);
+    acc += foo(i, 1, 2, 3, 4, 5, 6, 7);
+}
+print(acc);
+print(foo(1, 2, 3, 4, 5, 6, 7, 8, 9, 10));
@@ -0,0 +1,30 @@
+// Flags: --llvm-code-cache
+// The same source compiled in several realms lowers to the same IR, so
+// all the realms but the first get their foo from the llvm code cache.
+// Each copy must read its own realm's global cell and objects.
+var src =
+    "var g = 0;\n" +
+    "var o = { x: 1 };\n" +
+    "function foo(n) {\n" +
+    "    var sum = 0;\n" +
+    "    for (var i = 0; i < n; i++) {\n" +
+    "        g += i & 3;\n" +
+    "        sum += g + o.x;\n" +
+    "    }\n" +
+    "    return sum;\n" +
+    "}\n" +
+    "function run(x) {\n" +
+    "    o.x = x;\n" +
+    "    var sum = 0;\n" +
+    "    for (var i = 0; i < 100; i++) sum += foo(1000);\n" +
+    "    return sum + g;\n" +
+    "}\n";
+
+var result = "";
+for (var r = 0; r < 4; r++) {
+    var realm = Realm.create();
+    Realm.eval(realm, src);
+    result += Realm.eval(realm, "run(" + r + ")") + " ";
+}
+
+print(result);
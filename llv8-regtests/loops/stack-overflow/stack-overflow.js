@@ -0,0 +1,24 @@
+// Flags: --allow-natives-syntax
+
+// The stack check at the function entry must throw a RangeError
+// instead of letting the llvmed code run off the end of the stack.
+function foo(n, depth) {
+    if (n >= depth) return 0;
+    return foo(n + 1, depth) + 1;
+}
+
+var total = 0;
+for (var i = 0; i < 100; i++)
+    total += foo(0, 10);
+
+%OptimizeFunctionOnNextCall(foo);
+total += foo(0, 10);
+
+var result = "no exception";
+try {
+    foo(0, 1000000000);
+} catch (e) {
+    result = e instanceof RangeError;
+}
+print(total);
+print(result);
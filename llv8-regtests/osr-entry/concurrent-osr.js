@@ -0,0 +1,80 @@
+// foo is big enough (see Runtime_CompileForOnStackReplacement) to be
+// compiled for OSR on the concurrent recompilation thread. The unoptimized
+// code keeps running the loop until the llvm code is ready.
+function foo(n) {
+    var a = 1, b = 2, c = 3, d = 4;
+    var x = 0.25, y = 0.75;
+    for (var i = 0; i < n; i++) {
+        a = (a + b * 1 + (i & 1)) & 0xffff;
+        x = x * 0.5 + b / 1.5;
+        b = (b + c * 2 + (i & 2)) & 0xffff;
+        y = y * 0.75 + (b & 3) * 0.125;
+        c = (c + d * 3 + (i & 3)) & 0xffff;
+        d = (d + a * 4 + (i & 4)) & 0xffff;
+        x = x * 0.5 + a / 4.5;
+        a = (a + b * 5 + (i & 5)) & 0xffff;
+        y = y * 0.75 + (a & 3) * 0.125;
+        b = (b + c * 6 + (i & 6)) & 0xffff;
+        c = (c + d * 7 + (i & 7)) & 0xffff;
+        x = x * 0.5 + d / 7.5;
+        d = (d + a * 8 + (i & 1)) & 0xffff;
+        y = y * 0.75 + (d & 3) * 0.125;
+        a = (a + b * 9 + (i & 2)) & 0xffff;
+        b = (b + c * 10 + (i & 3)) & 0xffff;
+        x = x * 0.5 + c / 10.5;
+        c = (c + d * 11 + (i & 4)) & 0xffff;
+        y = y * 0.75 + (c & 3) * 0.125;
+        d = (d + a * 12 + (i & 5)) & 0xffff;
+        a = (a + b * 13 + (i & 6)) & 0xffff;
+        x = x * 0.5 + b / 13.5;
+        b = (b + c * 14 + (i & 7)) & 0xffff;
+        y = y * 0.75 + (b & 3) * 0.125;
+        c = (c + d * 15 + (i & 1)) & 0xffff;
+        d = (d + a * 16 + (i & 2)) & 0xffff;
+        x = x * 0.5 + a / 16.5;
+        a = (a + b * 17 + (i & 3)) & 0xffff;
+        y = y * 0.75 + (a & 3) * 0.125;
+        b = (b + c * 18 + (i & 4)) & 0xffff;
+        c = (c + d * 19 + (i & 5)) & 0xffff;
+        x = x * 0.5 + d / 19.5;
+        d = (d + a * 20 + (i & 6)) & 0xffff;
+        y = y * 0.75 + (d & 3) * 0.125;
+        a = (a + b * 21 + (i & 7)) & 0xffff;
+        b = (b + c * 22 + (i & 1)) & 0xffff;
+        x = x * 0.5 + c / 22.5;
+        c = (c + d * 23 + (i & 2)) & 0xffff;
+        y = y * 0.75 + (c & 3) * 0.125;
+        d = (d + a * 24 + (i & 3)) & 0xffff;
+        a = (a + b * 25 + (i & 4)) & 0xffff;
+        x = x * 0.5 + b / 25.5;
+        b = (b + c * 26 + (i & 5)) & 0xffff;
+        y = y * 0.75 + (b & 3) * 0.125;
+        c = (c + d * 27 + (i & 6)) & 0xffff;
+        d = (d + a * 28 + (i & 7)) & 0xffff;
+        x = x * 0.5 + a / 28.5;
+        a = (a + b * 29 + (i & 1)) & 0xffff;
+        y = y * 0.75 + (a & 3) * 0.125;
+        b = (b + c * 30 + (i & 2)) & 0xffff;
+        c = (c + d * 31 + (i & 3)) & 0xffff;
+        x = x * 0.5 + d / 31.5;
+        d = (d + a * 32 + (i & 4)) & 0xffff;
+        y = y * 0.75 + (d & 3) * 0.125;
+        a = (a + b * 33 + (i & 5)) & 0xffff;
+        b = (b + c * 34 + (i & 6)) & 0xffff;
+        x = x * 0.5 + c / 34.5;
+        c = (c + d * 35 + (i & 7)) & 0xffff;
+        y = y * 0.75 + (c & 3) * 0.125;
+        d = (d + a * 36 + (i & 1)) & 0xffff;
+        a = (a + b * 37 + (i & 2)) & 0xffff;
+        x = x * 0.5 + b / 37.5;
+        b = (b + c * 38 + (i & 3)) & 0xffff;
+        y = y * 0.75 + (b & 3) * 0.125;
+        c = (c + d * 39 + (i & 4)) & 0xffff;
+        d = (d + a * 40 + (i & 5)) & 0xffff;
+        x = x * 0.5 + a / 40.5;
+    }
+    return a + " " + b + " " + c + " " + d + " " + x.toFixed(6) + " " +
+        y.toFixed(6);
+}
+
+print(foo(2000000));
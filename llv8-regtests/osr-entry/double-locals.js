@@ -0,0 +1,17 @@
+// The double-valued locals live boxed in the unoptimized frame and are
+// unboxed on OSR entry.
+function foo(n) {
+    var x = 0.5;
+    var y = 1.25;
+    var acc = 0.1;
+    var k = 0;
+    for (var i = 0; i < n; i++) {
+        x = x * 0.999 + y;
+        y = y / 1.0001 - 0.0001;
+        acc += Math.sqrt(x * x + y * y) / (i + 1.5);
+        k += i & 1;
+    }
+    return acc.toFixed(6) + " " + x.toFixed(6) + " " + y.toFixed(6) + " " + k;
+}
+
+print(foo(3000000));
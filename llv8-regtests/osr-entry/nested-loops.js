@@ -0,0 +1,18 @@
+// foo is only called once, so its loops are entered through OSR, at the
+// back edge of the inner loop. The outer loop's counter and the sums
+// have to survive the replacement of the frame.
+function foo(n, m) {
+    var sum = 0;
+    var count = 0;
+    for (var i = 0; i < n; i++) {
+        var row = i & 15;
+        for (var j = 0; j < m; j++) {
+            sum = (sum + row * j + i) | 0;
+            count++;
+        }
+        sum ^= count;
+    }
+    return sum + " " + count;
+}
+
+print(foo(300, 10000));
@@ -1,10 +1,14 @@
 #!/usr/bin/python
 
 import argparse
+import json
+import math
 import os
+import re
 import sys
 import subprocess
 import inspect
+import time
 
 file_suffix = ".js"
 v8_options = ["--allow-natives-syntax", "--expose-gc",]
@@ -19,6 +23,10 @@ llv8_options = v8_options + [
 #    "--nouse-inlining",
     ]
 
+# Flags of the extra run which collects the stats of a benchmark.
+stats_options = ["--trace-opt", "--trace-deopt", "--dump-counters"]
+bench_suites = "LongSpider,asmjs-jetstream,asmjs-ubench"
+
 null_file = open("/dev/null", "w")
 
 arg_parser = argparse.ArgumentParser(
@@ -32,6 +40,25 @@ arg_parser.add_argument('--exclude',
 arg_parser.add_argument('--src_root',
                         default=os.path.dirname(os.path.realpath(__file__)),
                         help="Root directory with tests")
+arg_parser.add_argument('--bench', action='store_true',
+                        help="Instead of checking outputs, time the tests of "
+                        "the benchmark suites under Crankshaft and llv8 and "
+                        "write the results as JSON")
+arg_parser.add_argument('--suites', default=bench_suites,
+                        help="Comma separated directories (relative to "
+                        "SRC_ROOT) with the benchmarks (default: %(default)s)")
+arg_parser.add_argument('--base',
+                        help="With --bench, also time llv8 under the BASE d8 "
+                        "(e.g. a build from before a change to the backend) "
+                        "and report the speedup of V8_PATH over it")
+arg_parser.add_argument('--runs', type=int, default=5,
+                        help="Number of timed runs of each benchmark under "
+                        "each compiler")
+arg_parser.add_argument('--json', default="llv8-bench.json",
+                        help="Where to write the benchmark results")
+arg_parser.add_argument('--revision',
+                        help="Revision to tag the benchmark results with "
+                        "(git HEAD of SRC_ROOT by default)")
 arg_parser.add_argument('v8_path',
                         nargs='?', # 0 or 1
                         default="/home/vlad/code/blessed-v8/v8/out/x64.debug/d8")
@@ -44,9 +71,23 @@ src_root = args.src_root
 class WrongAnswerException(Exception):
     pass
 
+# Extra options a test asks for, as in mjsunit (some of the older tests
+# separate them with commas). The --llvm ones only go to the llv8 run, the
+# rest to both runs.
+flags_regexp = re.compile(r"^// Flags:(.*)$", re.MULTILINE)
+
+def test_flags(filename):
+    with open(filename) as src:
+        flags = " ".join(flags_regexp.findall(src.read()))
+    return flags.replace(",", " ").split()
+
 def do_test(filename):
-    llv8_out = subprocess.check_output([v8_path] + llv8_options + [filename], stderr=null_file)
-    v8_out = subprocess.check_output([v8_path] + v8_options + [filename], stderr=null_file)
+    flags = test_flags(filename)
+    common_flags = [f for f in flags if not f.startswith("--llvm")]
+    llv8_out = subprocess.check_output([v8_path] + llv8_options + flags +
+                                       [filename], stderr=null_file)
+    v8_out = subprocess.check_output([v8_path] + v8_options + common_flags +
+                                     [filename], stderr=null_file)
     split_lambda = lambda output: filter(lambda x: x, output.split("\n"))
     llv8_out = split_lambda(llv8_out)
     v8_out = split_lambda(v8_out)
@@ -59,13 +100,18 @@ def do_test(filename):
         print "v8:\t", v8_out[-1]
         raise WrongAnswerException("llv8 error: WA")
 
-failed = []
-tested_cnt = 0
-for root, dirs, files in os.walk(src_root):
-    lst = [root + '/' + i for i in files if i.endswith(file_suffix)]
-    for src_file in lst:
-        if args.exclude and args.exclude in src_file: continue
-        if args.filter and args.filter not in src_file: continue
+def test_files(root_dir):
+    for root, dirs, files in os.walk(root_dir):
+        lst = [root + '/' + i for i in files if i.endswith(file_suffix)]
+        for src_file in sorted(lst):
+            if args.exclude and args.exclude in src_file: continue
+            if args.filter and args.filter not in src_file: continue
+            yield src_file
+
+def run_tests():
+    failed = []
+    tested_cnt = 0
+    for src_file in test_files(src_root):
         tested_cnt += 1
         try:
             print src_file
@@ -75,8 +121,111 @@ for root, dirs, files in os.walk(src_root):
             failed += [src_file]
             print "\tFAILED!"
             print e
-print "\n=======RESULTS======="
-print str(len(failed)) + "/" + str(tested_cnt), "tests failed"
-for test in failed:
-    print test
+    print "\n=======RESULTS======="
+    print str(len(failed)) + "/" + str(tested_cnt), "tests failed"
+    for test in failed:
+        print test
+
+# Optimizing compile time as reported by --trace-opt (graph creation,
+# optimization and code generation).
+took_regexp = re.compile(r"^\[optimizing .* - took ([\d.]+), ([\d.]+), "
+                         r"([\d.]+) ms\]")
+# The per-phase times --trace-opt prints for llvmed functions.
+llvm_phases_prefix = "[llvm phases:"
+phase_time_regexp = re.compile(r" ([\d.]+) ms ")
+code_size_regexp = re.compile(r"c:V8\.TotalCompiledCodeSize\s*\|\s*(\d+)")
+deopt_prefix = "[deoptimizing (DEOPT"
+
+def collect_stats(d8, options, filename):
+    out = subprocess.check_output([d8] + options + stats_options +
+                                  [filename], stderr=null_file)
+    stats = {"compile_ms": 0.0, "llvm_compile_ms": 0.0, "code_size": None,
+             "deopts": 0, "optimized_functions": 0}
+    for line in out.split("\n"):
+        match = took_regexp.match(line)
+        if match:
+            stats["compile_ms"] += sum(float(t) for t in match.groups())
+            stats["optimized_functions"] += 1
+        elif line.startswith(llvm_phases_prefix):
+            stats["llvm_compile_ms"] += sum(
+                float(t) for t in phase_time_regexp.findall(line + " "))
+        elif line.startswith(deopt_prefix):
+            stats["deopts"] += 1
+        else:
+            match = code_size_regexp.search(line)
+            if match: stats["code_size"] = int(match.group(1))
+    return stats
+
+def bench(d8, options, filename):
+    times = []
+    for _ in range(args.runs):
+        start = time.time()
+        subprocess.check_call([d8] + options + [filename],
+                              stdout=null_file, stderr=null_file)
+        times.append(time.time() - start)
+    # Tracing slows things down, so the stats come from a separate run.
+    result = collect_stats(d8, options, filename)
+    result["times"] = times
+    result["best_time"] = min(times)
+    result["mean_time"] = sum(times) / len(times)
+    return result
+
+def source_revision():
+    if args.revision: return args.revision
+    try:
+        return subprocess.check_output(["git", "rev-parse", "HEAD"],
+                                       cwd=src_root, stderr=null_file).strip()
+    except (subprocess.CalledProcessError, OSError):
+        return None
+
+# Geometric mean of the best time ratios of the benchmarks both d8s ran,
+# > 0 means llv8 is faster under V8_PATH than under the base d8.
+def base_speedup(results):
+    ratios = [math.log(r["llv8_base"]["best_time"] / r["llv8"]["best_time"])
+              for r in results
+              if "failed" not in r["llv8"] and "failed" not in r["llv8_base"]]
+    if not ratios: return None
+    return math.exp(sum(ratios) / len(ratios)) - 1
+
+def run_benchmarks():
+    configs = [("crankshaft", v8_path, v8_options),
+               ("llv8", v8_path, llv8_options)]
+    if args.base: configs.append(("llv8_base", args.base, llv8_options))
+    results = []
+    for suite in args.suites.split(","):
+        suite_root = os.path.join(src_root, suite)
+        for src_file in test_files(suite_root):
+            print src_file
+            result = {"suite": suite,
+                      "test": os.path.relpath(src_file, src_root)}
+            for name, d8, options in configs:
+                try:
+                    result[name] = bench(d8, options, src_file)
+                    print "\t%-10s %8.3fs" % (name, result[name]["best_time"])
+                except subprocess.CalledProcessError as e:
+                    result[name] = {"failed": True}
+                    print "\t%-10s FAILED!" % name
+                    print e
+            results.append(result)
+    report = {"d8": v8_path,
+              "base_d8": args.base,
+              "revision": source_revision(),
+              "timestamp": time.time(),
+              "runs": args.runs,
+              "llv8_options": llv8_options,
+              "results": results}
+    with open(args.json, "w") as json_file:
+        json.dump(report, json_file, indent=2, sort_keys=True)
+    print "\n=======RESULTS======="
+    print len(results), "benchmarks, results written to", args.json
+    if args.base:
+        speedup = base_speedup(results)
+        if speedup is not None:
+            print "llv8 geometric mean speedup over the base d8: %+.1f%%" % (
+                speedup * 100)
+
+if args.bench:
+    run_benchmarks()
+else:
+    run_tests()
 null_file.close()
@@ -0,0 +1,20 @@
+var N = 4096;
+
+function foo(src, dst, scale, n) {
+    for (var i = 0; i < n; i++) {
+        dst[i] = src[i] * scale;
+    }
+}
+
+var src = new Float32Array(N);
+var dst = new Float32Array(N);
+for (var i = 0; i < N; i++) {
+    src[i] = Math.sin(i);
+}
+for (var i = 0; i < 2000; i++) {
+    foo(src, dst, 0.5 + i / 4000, N);
+}
+
+var sum = 0;
+for (var i = 0; i < N; i++) sum += dst[i];
+print(sum);
@@ -0,0 +1,23 @@
+var N = 4096;
+
+function foo(a, b, c) {
+    for (var i = 0; i < c.length; i++) {
+        c[i] = (a[i] + b[i]) | 0;
+    }
+}
+
+var a = new Int32Array(N);
+var b = new Int32Array(N);
+var c = new Int32Array(N);
+for (var i = 0; i < N; i++) {
+    a[i] = i * 7;
+    b[i] = 0x7fffffff - i;
+}
+for (var i = 0; i < 2000; i++) {
+    foo(a, b, c);
+    foo(c, b, a);
+}
+
+var sum = 0;
+for (var i = 0; i < N; i++) sum = (sum + c[i]) | 0;
+print(sum);
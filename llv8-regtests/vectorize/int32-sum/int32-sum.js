@@ -0,0 +1,19 @@
+var N = 4096;
+
+function foo(a, n) {
+    var sum = 0;
+    for (var i = 0; i < n; i++) {
+        sum = (sum + a[i]) | 0;
+    }
+    return sum;
+}
+
+var a = new Int32Array(N);
+for (var i = 0; i < N; i++) {
+    a[i] = i * i;
+}
+var result = 0;
+for (var i = 0; i < 5000; i++) {
+    result = (result + foo(a, N - (i & 15))) | 0;
+}
+print(result);
@@ -0,0 +1,21 @@
+var N = 4096;
+
+function foo(a, x, y, n) {
+    for (var i = 0; i < n; i++) {
+        y[i] = a * x[i] + y[i];
+    }
+}
+
+var x = new Float64Array(N);
+var y = new Float64Array(N);
+for (var i = 0; i < N; i++) {
+    x[i] = i / 3;
+    y[i] = N - i;
+}
+for (var i = 0; i < 2000; i++) {
+    foo(1.5, x, y, N);
+}
+
+var sum = 0;
+for (var i = 0; i < N; i++) sum += y[i];
+print(sum);
@@ -0,0 +1,25 @@
+var N = 8192;
+
+// The two arrays are views of the same buffer, so the vectorized loop
+// has to check at run time that they don't overlap.
+function foo(src, dst, n) {
+    for (var i = 0; i < n; i++) {
+        dst[i] = src[i] + 1;
+    }
+}
+
+var buffer = new ArrayBuffer(N * 2);
+var src = new Uint8Array(buffer, 0, N);
+var dst = new Uint8Array(buffer, 16, N);
+var other = new Uint8Array(N);
+for (var i = 0; i < N; i++) {
+    src[i] = i;
+}
+for (var i = 0; i < 2000; i++) {
+    foo(src, other, N - 16);
+    foo(src, dst, N - 16);
+}
+
+var sum = 0;
+for (var i = 0; i < N; i++) sum += dst[i] + other[i];
+print(sum);
@@ -29,7 +29,9 @@ static LowChunk* OptimizeGraph(HGraph* graph) {
   LowChunk* chunk;
   if (!graph->info()->closure().is_null() &&
       graph->info()->closure()->PassesFilter(FLAG_llvm_filter)) {
-    chunk = LLVMChunk::NewChunk(graph);
+    LLVMChunk* llvm_chunk = LLVMChunk::NewChunk(graph);
+    if (llvm_chunk != NULL) llvm_chunk->EmitMachineCode();
+    chunk = llvm_chunk;
     // TODO(llvm): add logging
   } else {
     chunk = LChunk::NewChunk(graph);
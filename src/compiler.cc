@@ -170,6 +170,7 @@ CompilationInfo::CompilationInfo(ParseInfo* parse_info, CodeStub* code_stub,
       osr_ast_id_(BailoutId::None()),
       zone_(zone),
       deferred_handles_(nullptr),
+      lowering_deferred_handles_(nullptr),
       dependencies_(isolate, zone),
       bailout_reason_(kNoReason),
       prologue_offset_(Code::kPrologueOffsetNotSet),
@@ -198,6 +199,7 @@ CompilationInfo::CompilationInfo(ParseInfo* parse_info, CodeStub* code_stub,
 CompilationInfo::~CompilationInfo() {
   DisableFutureOptimization();
   delete deferred_handles_;
+  delete lowering_deferred_handles_;
 #ifdef DEBUG
   // Check that no dependent maps have been added or added dependent maps have
   // been rolled back or committed.
@@ -507,13 +509,22 @@ OptimizedCompileJob::Status OptimizedCompileJob::CreateGraph() {
         info()->shared_info()->disable_optimization_reason());
   }
 
+  // Decided before the graph is built, since its optimization depends on
+  // the backend (see HGraph::Optimize).
+  if (!info()->closure().is_null() && LLVMChunk::SupportsFlags() &&
+      (info()->closure()->PassesFilter(FLAG_llvm_filter) || IsLLVMTierUp())) {
+    info()->MarkAsLLVM();
+  }
+
   graph_builder_ = (info()->is_tracking_positions() || FLAG_trace_ic)
                        ? new (info()->zone())
                              HOptimizedGraphBuilderWithPositions(info())
                        : new (info()->zone()) HOptimizedGraphBuilder(info());
 
-  Timer t(this, &time_taken_to_create_graph_);
-  graph_ = graph_builder_->CreateGraph();
+  {
+    Timer t(this, &time_taken_to_create_graph_);
+    graph_ = graph_builder_->CreateGraph();
+  }
 
   if (isolate()->has_pending_exception()) {
     return SetLastStatus(FAILED);
@@ -526,6 +537,59 @@ OptimizedCompileJob::Status OptimizedCompileJob::CreateGraph() {
     return RetryOptimization(kBailedOutDueToDependencyChange);
   }
 
+  use_llvm_ = info()->is_llvm();
+  return SetLastStatus(SUCCEEDED);
+}
+
+
+void OptimizedCompileJob::ReleaseLLVMChunk() {
+  if (use_llvm_ && chunk_ != NULL) {
+    static_cast<LLVMChunk*>(chunk_)->ReleaseBackend();
+  }
+}
+
+
+bool OptimizedCompileJob::IsLLVMTierUp() const {
+  // See RuntimeProfiler::TierUpToLLVM.
+  return FLAG_llvm_tier_up && !info()->is_osr() &&
+         info()->unoptimized_code()->tier_up_to_llvm();
+}
+
+
+OptimizedCompileJob::Status OptimizedCompileJob::LowerToLLVM() {
+  DCHECK(IsAwaitingLLVMLowering());
+  // Lowering Hydrogen to LLVM IR needs code stubs, cells and deoptimization
+  // entries, which can only be created on the main thread.  The graph has
+  // been optimized on the concurrent thread already, and the (much more
+  // expensive) LLVM pass pipeline and MCJIT go back there afterwards.
+  CompilationHandleScope handle_scope(info());
+  Timer t(this, &time_taken_to_optimize_);
+  if (info()->dependencies()->HasAborted()) {
+    return RetryOptimization(kBailedOutDueToDependencyChange);
+  }
+  // The pre-scan saves building the IR of a graph that is bound to go to
+  // Lithium, NewChunk() still gives up on whatever it misses.
+  HInstruction* unsupported = LLVMChunk::FindUnsupportedInstruction(graph_);
+  if (unsupported == NULL) {
+    chunk_ = LLVMChunk::NewChunk(graph_);
+    if (chunk_ != NULL) return SetLastStatus(SUCCEEDED);
+  }
+  bool has_crankshaft_code =
+      info()->shared_info()->SearchOptimizedCodeMap(
+          info()->context()->native_context(),
+          info()->osr_ast_id()).code != nullptr;
+  if (FLAG_trace_opt) {
+    OFStream os(stdout);
+    os << "[llvm can't lower ";
+    if (unsupported != NULL) os << unsupported->Mnemonic() << " in ";
+    os << Brief(*info()->closure())
+       << (has_crankshaft_code ? ", keeping" : ", using") << " Lithium]"
+       << std::endl;
+  }
+  // A function promoted from Crankshaft already has Lithium code.
+  if (has_crankshaft_code) return RetryOptimization(kLLVMCannotLowerGraph);
+  // The next OptimizeGraph() builds the Lithium chunk instead.
+  use_llvm_ = false;
   return SetLastStatus(SUCCEEDED);
 }
 
@@ -544,20 +608,27 @@ OptimizedCompileJob::Status OptimizedCompileJob::OptimizeGraph() {
 
   Timer t(this, &time_taken_to_optimize_);
   DCHECK(graph_ != NULL);
-  BailoutReason bailout_reason = kNoReason;
 
-  if (graph_->Optimize(&bailout_reason)) {
-    if (!graph_->info()->closure().is_null() &&
-      graph_->info()->closure()->PassesFilter(FLAG_llvm_filter)) {
-      // We cant build llvm chunk here if concurrent recompilation is enabled
-      // It must be moved to GenerateCode() function
-      //chunk_ = LLVMChunk::NewChunk(graph_);
-      // TODO(llvm): add logging
-      // FIXME(llvm): We actualy need to handle non succeeded cases
+  if (use_llvm_ && graph_optimized_) {
+    // Second trip, the graph has been lowered by LowerToLLVM().
+    DCHECK(chunk_ != NULL);
+    static_cast<LLVMChunk*>(chunk_)->EmitMachineCode();
+    return SetLastStatus(SUCCEEDED);
+  }
+
+  BailoutReason bailout_reason = kNoReason;
+  if (use_llvm_) {
+    // First trip, LowerToLLVM() takes it from here.
+    if (graph_->Optimize(&bailout_reason)) {
+      graph_optimized_ = true;
       return SetLastStatus(SUCCEEDED);
-    } else {
-      chunk_ = LChunk::NewChunk(graph_);
     }
+    if (bailout_reason != kNoReason) graph_builder_->Bailout(bailout_reason);
+    return SetLastStatus(BAILED_OUT);
+  }
+
+  if (graph_optimized_ || graph_->Optimize(&bailout_reason)) {
+    chunk_ = LChunk::NewChunk(graph_);
     if (chunk_ != NULL) return SetLastStatus(SUCCEEDED);
   } else if (bailout_reason != kNoReason) {
     graph_builder_->Bailout(bailout_reason);
@@ -585,19 +656,13 @@ OptimizedCompileJob::Status OptimizedCompileJob::GenerateCode() {
   DisallowJavascriptExecution no_js(isolate());
   {  // Scope for timer.
     Timer timer(this, &time_taken_to_codegen_);
-    // DCHECK(chunk_ != NULL);
+    DCHECK(chunk_ != NULL);
     DCHECK(graph_ != NULL);
     // Deferred handles reference objects that were accessible during
     // graph creation.  To make sure that we don't encounter inconsistencies
     // between graph creation and code generation, we disallow accessing
     // objects through deferred handles during the latter, with exceptions.
     DisallowDeferredHandleDereference no_deferred_handle_deref;
-    if (!graph_->info()->closure().is_null() &&
-        graph_->info()->closure()->PassesFilter(FLAG_llvm_filter)) {
-      chunk_ = LLVMChunk::NewChunk(graph_);
-    }
-    // FIXME(llvm). chunk can be null, we need to abort if so.
-    DCHECK(chunk_ != NULL);
     Handle<Code> optimized_code = chunk_->Codegen();
     if (optimized_code.is_null()) {
       if (info()->bailout_reason() == kNoReason) {
@@ -629,6 +694,9 @@ void OptimizedCompileJob::RecordOptimizationStats() {
     function->ShortPrint();
     PrintF(" - took %0.3f, %0.3f, %0.3f ms]\n", ms_creategraph, ms_optimize,
            ms_codegen);
+    if (use_llvm_ && chunk_ != NULL) {
+      static_cast<LLVMChunk*>(chunk_)->PrintPhaseStats();
+    }
   }
   if (FLAG_trace_opt_stats) {
     static double compilation_time = 0.0;
@@ -831,6 +899,15 @@ static void InsertCodeIntoOptimizedCodeMap(CompilationInfo* info) {
   Handle<SharedFunctionInfo> shared(function->shared());
   Handle<LiteralsArray> literals(function->literals());
   Handle<Context> native_context(function->context()->native_context());
+  if (code->is_llvmed()) {
+    // Functions promoted from Crankshaft (see RuntimeProfiler::TierUpToLLVM)
+    // still have their Crankshaft code cached.
+    Code* cached = shared->SearchOptimizedCodeMap(*native_context,
+                                                  info->osr_ast_id()).code;
+    if (cached != nullptr) {
+      shared->EvictFromOptimizedCodeMap(cached, "promoted to llvm");
+    }
+  }
   SharedFunctionInfo::AddToOptimizedCodeMap(shared, native_context, code,
                                             literals, info->osr_ast_id());
 
@@ -889,6 +966,9 @@ static bool GetOptimizedCodeNow(CompilationInfo* info) {
   OptimizedCompileJob job(info);
   if (job.CreateGraph() != OptimizedCompileJob::SUCCEEDED ||
       job.OptimizeGraph() != OptimizedCompileJob::SUCCEEDED ||
+      (job.IsAwaitingLLVMLowering() &&
+       (job.LowerToLLVM() != OptimizedCompileJob::SUCCEEDED ||
+        job.OptimizeGraph() != OptimizedCompileJob::SUCCEEDED)) ||
       job.GenerateCode() != OptimizedCompileJob::SUCCEEDED) {
     if (FLAG_trace_opt) {
       PrintF("[aborted optimizing ");
@@ -1660,6 +1740,31 @@ Handle<SharedFunctionInfo> Compiler::GetSharedFunctionInfo(
 }
 
 
+// Whether a function found in the optimized code map should nevertheless be
+// recompiled, because it has been promoted from Crankshaft to LLVM (see
+// RuntimeProfiler::TierUpToLLVM).
+static bool IsPromotedToLLVM(Handle<Code> current_code,
+                             Handle<Code> cached_code, BailoutId osr_ast_id) {
+  return FLAG_llvm_tier_up && osr_ast_id.IsNone() &&
+         current_code->kind() == Code::FUNCTION &&
+         current_code->tier_up_to_llvm() && !cached_code->is_llvmed();
+}
+
+
+// A promotion to LLVM ends with the compilation it triggered, whether that
+// produced LLVM code or not. Unless it did, the function goes back to being
+// an ordinary Crankshaft function, which may be promoted again once it has
+// been stable for long enough.
+static void EndTierUpToLLVM(CompilationInfo* info) {
+  if (!FLAG_llvm_tier_up || info->is_osr()) return;
+  if (!info->code().is_null() && info->code()->is_llvmed()) return;
+  Code* shared_code = info->shared_info()->code();
+  if (shared_code->kind() != Code::FUNCTION) return;
+  if (!shared_code->tier_up_to_llvm()) return;
+  RuntimeProfiler::ResetTierUpToLLVM(*info->shared_info());
+}
+
+
 MaybeHandle<Code> Compiler::GetOptimizedCode(Handle<JSFunction> function,
                                              Handle<Code> current_code,
                                              ConcurrencyMode mode,
@@ -1671,7 +1776,8 @@ MaybeHandle<Code> Compiler::GetOptimizedCode(Handle<JSFunction> function,
 
   Handle<Code> cached_code;
   if (GetCodeFromOptimizedCodeMap(
-          function, osr_ast_id).ToHandle(&cached_code)) {
+          function, osr_ast_id).ToHandle(&cached_code) &&
+      !IsPromotedToLLVM(current_code, cached_code, osr_ast_id)) {
     if (FLAG_trace_opt) {
       PrintF("[found optimized code for ");
       function->ShortPrint();
@@ -1722,14 +1828,22 @@ MaybeHandle<Code> Compiler::GetOptimizedCode(Handle<JSFunction> function,
   if (mode == CONCURRENT) {
     if (GetOptimizedCodeLater(info.get())) {
       info.Detach();  // The background recompile job owns this now.
+      // Keep running the Crankshaft code until the LLVM code is installed.
+      if (!cached_code.is_null()) return cached_code;
       return isolate->builtins()->InOptimizationQueue();
     }
   } else {
     info->set_osr_frame(osr_frame);
-    if (GetOptimizedCodeNow(info.get())) return info->code();
+    bool succeeded = GetOptimizedCodeNow(info.get());
+    EndTierUpToLLVM(info.get());
+    if (succeeded) return info->code();
   }
 
   if (isolate->has_pending_exception()) isolate->clear_pending_exception();
+  // Either the job was not queued or it failed.
+  EndTierUpToLLVM(info.get());
+  // A failed promotion to LLVM leaves us with the Crankshaft code.
+  if (!cached_code.is_null()) return cached_code;
   return MaybeHandle<Code>();
 }
 
@@ -1760,7 +1874,9 @@ Handle<Code> Compiler::GetConcurrentlyOptimizedCode(OptimizedCompileJob* job) {
       job->RetryOptimization(kBailedOutDueToDependencyChange);
     } else if (job->GenerateCode() == OptimizedCompileJob::SUCCEEDED) {
       RecordFunctionCompilation(Logger::LAZY_COMPILE_TAG, info.get(), shared);
-      if (shared->SearchOptimizedCodeMap(info->context()->native_context(),
+      EndTierUpToLLVM(info.get());
+      if (info->code()->is_llvmed() ||
+          shared->SearchOptimizedCodeMap(info->context()->native_context(),
                                          info->osr_ast_id()).code == nullptr) {
         InsertCodeIntoOptimizedCodeMap(info.get());
       }
@@ -1774,6 +1890,8 @@ Handle<Code> Compiler::GetConcurrentlyOptimizedCode(OptimizedCompileJob* job) {
   }
 
   DCHECK(job->last_status() != OptimizedCompileJob::SUCCEEDED);
+  job->ReleaseLLVMChunk();
+  EndTierUpToLLVM(info.get());
   if (FLAG_trace_opt) {
     PrintF("[aborted optimizing ");
     info->closure()->ShortPrint();
@@ -127,6 +127,7 @@ class CompilationInfo {
     kDeoptimizationEnabled = 1 << 16,
     kSourcePositionsEnabled = 1 << 17,
     kFirstCompile = 1 << 18,
+    kLLVM = 1 << 19,
   };
 
   explicit CompilationInfo(ParseInfo* parse_info);
@@ -276,6 +277,11 @@ class CompilationInfo {
 
   bool is_first_compile() const { return GetFlag(kFirstCompile); }
 
+  // The graph is going to be lowered to LLVM IR rather than Lithium.
+  void MarkAsLLVM() { SetFlag(kLLVM); }
+
+  bool is_llvm() const { return GetFlag(kLLVM); }
+
   bool IsCodePreAgingActive() const {
     return FLAG_optimize_for_size && FLAG_age_code && !will_serialize() &&
            !is_debug();
@@ -340,8 +346,14 @@ class CompilationInfo {
   bool ShouldSelfOptimize();
 
   void set_deferred_handles(DeferredHandles* deferred_handles) {
-    DCHECK(deferred_handles_ == NULL);
-    deferred_handles_ = deferred_handles;
+    // An LLVM job detaches a second set once it has been lowered to LLVM IR
+    // (see OptimizedCompileJob::LowerToLLVM).
+    DCHECK(lowering_deferred_handles_ == NULL);
+    if (deferred_handles_ == NULL) {
+      deferred_handles_ = deferred_handles;
+    } else {
+      lowering_deferred_handles_ = deferred_handles;
+    }
   }
 
   void ReopenHandlesInNewHandleScope() {
@@ -486,6 +498,7 @@ class CompilationInfo {
   Zone* zone_;
 
   DeferredHandles* deferred_handles_;
+  DeferredHandles* lowering_deferred_handles_;
 
   // Dependencies for this compilation, e.g. stable maps.
   CompilationDependencies dependencies_;
@@ -557,7 +570,10 @@ class OptimizedCompileJob: public ZoneObject {
         graph_(NULL),
         chunk_(NULL),
         last_status_(FAILED),
-        awaiting_install_(false) { }
+        awaiting_install_(false),
+        use_llvm_(false),
+        graph_optimized_(false) { }
+  ~OptimizedCompileJob() { ReleaseLLVMChunk(); }
 
   enum Status {
     FAILED, BAILED_OUT, SUCCEEDED
@@ -567,6 +583,15 @@ class OptimizedCompileJob: public ZoneObject {
   MUST_USE_RESULT Status OptimizeGraph();
   MUST_USE_RESULT Status GenerateCode();
 
+  // An LLVM job takes two trips through OptimizeGraph(): the first one
+  // optimizes the graph, then the main thread lowers it to LLVM IR and the
+  // second one runs the LLVM passes and MCJIT.
+  MUST_USE_RESULT Status LowerToLLVM();
+  bool IsAwaitingLLVMLowering() const {
+    return use_llvm_ && graph_optimized_ && chunk_ == NULL &&
+           last_status_ == SUCCEEDED;
+  }
+
   Status last_status() const { return last_status_; }
   CompilationInfo* info() const { return info_; }
   Isolate* isolate() const { return info()->isolate(); }
@@ -587,6 +612,14 @@ class OptimizedCompileJob: public ZoneObject {
   }
 
   bool IsWaitingForInstall() { return awaiting_install_; }
+  bool use_llvm() const { return use_llvm_; }
+  bool graph_optimized() const { return graph_optimized_; }
+
+  // Gives the LLVM backend (and the module, if MCJIT hasn't got it yet) of
+  // an LLVM chunk back unless Codegen() has already done it. Concurrent jobs
+  // live in the zone of their CompilationInfo and are never destructed, so
+  // whoever disposes of them must call this.
+  void ReleaseLLVMChunk();
 
  private:
   CompilationInfo* info_;
@@ -598,11 +631,18 @@ class OptimizedCompileJob: public ZoneObject {
   base::TimeDelta time_taken_to_codegen_;
   Status last_status_;
   bool awaiting_install_;
+  // Decided in CreateGraph() (the filter needs the closure,
+  // which can't be dereferenced on the concurrent thread).
+  bool use_llvm_;
+  // Set by the first OptimizeGraph() of an LLVM job.  LowerToLLVM() may
+  // still leave the optimized graph to Lithium.
+  bool graph_optimized_;
 
   MUST_USE_RESULT Status SetLastStatus(Status status) {
     last_status_ = status;
     return last_status_;
   }
+  bool IsLLVMTierUp() const;
   void RecordOptimizationStats();
 
   struct Timer {
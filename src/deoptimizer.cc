@@ -13,6 +13,7 @@
 #include "src/macro-assembler.h"
 #include "src/prettyprinter.h"
 #include "src/profiler/cpu-profiler.h"
+#include "src/runtime-profiler.h"
 #include "src/v8.h"
 
 
@@ -306,6 +307,7 @@ void Deoptimizer::DeoptimizeMarkedCodeForContext(Context* context) {
       // Unlink this function and evict from optimized code map.
       SharedFunctionInfo* shared = function->shared();
       function->set_code(shared->code());
+      RuntimeProfiler::ResetTierUpToLLVM(shared);
 
       if (FLAG_trace_deopt) {
         CodeTracer::Scope scope(code->GetHeap()->isolate()->GetCodeTracer());
@@ -545,6 +547,7 @@ Deoptimizer::Deoptimizer(Isolate* isolate, JSFunction* function,
       if (opt_count > 0) opt_count--;
       function->shared()->set_opt_count(opt_count);
     }
+    RuntimeProfiler::ResetTierUpToLLVM(function->shared());
   }
   compiled_code_ = FindOptimizedCode(function, optimized_code);
 #if DEBUG
@@ -389,6 +389,9 @@ DEFINE_BOOL(trace_concurrent_recompilation, false,
             "track concurrent recompilation")
 DEFINE_INT(concurrent_recompilation_queue_length, 8,
            "the length of the concurrent compilation queue")
+DEFINE_INT(concurrent_recompilation_workers, 4,
+           "the maximum number of background threads draining the "
+           "concurrent compilation queue")
 DEFINE_INT(concurrent_recompilation_delay, 0,
            "artificial compilation delay in ms")
 DEFINE_BOOL(block_concurrent_recompilation, false,
@@ -405,6 +408,36 @@ DEFINE_STRING(llvm_filter, "~", "filter for functions to be lowered to "
     "llvm instead of Lithium")
 DEFINE_BOOL(phi_normalize, true, "enable phi normalization phaze"
     " (it's a temporary hack, phis must always be normalized")
+DEFINE_BOOL(llvm_tier_up, false, "recompile hot Crankshaft code with llvm "
+    "(in addition to the functions passing --llvm-filter)")
+DEFINE_INT(llvm_tier_up_ticks, 20, "number of profiler ticks a function "
+    "has to spend in its Crankshaft code without deoptimizing before it is "
+    "recompiled with llvm")
+DEFINE_BOOL(llvm_stack_checks, true, "check the stack limit (and thus for "
+    "interrupts) on function entry and loop back edges of llvmed code "
+    "(only meant to be turned off to measure the overhead)")
+DEFINE_STRING(llvm_mcpu, "auto", "the cpu llvm tunes and generates code for, "
+    "e.g. haswell (the host cpu and the features V8 detected on it if auto)")
+DEFINE_STRING(llvm_opt, "balanced", "the llvm optimization pipeline: fast "
+    "(cleanups only), balanced (scalar and loop optimizations) or max (also "
+    "unrolling and more rounds of redundancy elimination)")
+DEFINE_BOOL(llvm_time_passes, false, "print the time each llvm optimization "
+    "pass took for every llvmed function (the loop passes then run one at "
+    "a time)")
+DEFINE_BOOL(llvm_vectorize, true, "run the llvm loop and SLP vectorizers "
+    "on llvmed code")
+DEFINE_BOOL(llvm_bounds_checks_hoisting, false, "hoist the bounds checks of "
+    "counted loops of llvmed code out of the loop, so that llvm can "
+    "vectorize them")
+DEFINE_BOOL(llvm_drop_loop_stack_checks, false, "drop the interrupt checks "
+    "on the back edges of counted innermost loops of llvmed code, so that "
+    "llvm can vectorize them (interrupts then wait until the loop is done)")
+DEFINE_IMPLICATION(llvm_drop_loop_stack_checks, llvm_bounds_checks_hoisting)
+DEFINE_BOOL(llvm_code_cache, false, "reuse the machine code llvm emitted "
+    "for an identical function (modulo the heap objects it embeds) instead "
+    "of optimizing and compiling it again")
+DEFINE_INT(llvm_code_cache_size, 256, "maximum number of functions kept "
+    "in the llvm code cache")
 
 // Flags for TurboFan.
 DEFINE_BOOL(turbo, false, "enable TurboFan compiler")
@@ -1860,7 +1860,9 @@ Range* HAdd::InferRange(Zone* zone) {
     Range* a = left()->range();
     Range* b = right()->range();
     Range* res = a->Copy(zone);
-    if (!res->AddAndCheckOverflow(r, b) ||
+    bool overflow = res->AddAndCheckOverflow(r, b);
+    if (!overflow) SetFlag(kCannotWrap);
+    if (!overflow ||
         (r.IsInteger32() && CheckFlag(kAllUsesTruncatingToInt32)) ||
         (r.IsSmi() && CheckFlag(kAllUsesTruncatingToSmi))) {
       ClearFlag(kCanOverflow);
@@ -1881,7 +1883,9 @@ Range* HSub::InferRange(Zone* zone) {
     Range* a = left()->range();
     Range* b = right()->range();
     Range* res = a->Copy(zone);
-    if (!res->SubAndCheckOverflow(r, b) ||
+    bool overflow = res->SubAndCheckOverflow(r, b);
+    if (!overflow) SetFlag(kCannotWrap);
+    if (!overflow ||
         (r.IsInteger32() && CheckFlag(kAllUsesTruncatingToInt32)) ||
         (r.IsSmi() && CheckFlag(kAllUsesTruncatingToSmi))) {
       ClearFlag(kCanOverflow);
@@ -1902,7 +1906,9 @@ Range* HMul::InferRange(Zone* zone) {
     Range* a = left()->range();
     Range* b = right()->range();
     Range* res = a->Copy(zone);
-    if (!res->MulAndCheckOverflow(r, b) ||
+    bool overflow = res->MulAndCheckOverflow(r, b);
+    if (!overflow) SetFlag(kCannotWrap);
+    if (!overflow ||
         (((r.IsInteger32() && CheckFlag(kAllUsesTruncatingToInt32)) ||
          (r.IsSmi() && CheckFlag(kAllUsesTruncatingToSmi))) &&
          MulMinusOne())) {
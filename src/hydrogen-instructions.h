@@ -433,6 +433,11 @@ class HValue : public ZoneObject {
     // indicate which side effects to track by setting GVN flags.
     kTrackSideEffectDominators,
     kCanOverflow,
+    // Set by range analysis on integer additions, subtractions and
+    // multiplications whose result is known to fit the representation.
+    // Unlike the absence of kCanOverflow (which truncating uses imply as
+    // well), it survives the ranges being thrown away after the analysis.
+    kCannotWrap,
     kBailoutOnMinusZero,
     kCanBeDivByZero,
     kLeftCanBeMinInt,
@@ -5922,6 +5927,22 @@ class HObjectAccess final {
     return portion() == kMaps;
   }
 
+  inline bool IsArrayLength() const {
+    return portion() == kArrayLengths;
+  }
+
+  inline bool IsElementsPointer() const {
+    return portion() == kElementsPointer;
+  }
+
+  inline bool IsBackingStore() const {
+    return portion() == kBackingStore;
+  }
+
+  inline bool IsDoubleField() const {
+    return portion() == kDouble;
+  }
+
   inline int offset() const {
     return OffsetField::decode(value_);
   }
@@ -4586,7 +4586,12 @@ bool HGraph::Optimize(BailoutReason* bailout_reason) {
   Run<HStackCheckEliminationPhase>();
 
   if (FLAG_array_bounds_checks_elimination) Run<HBoundsCheckEliminationPhase>();
-  if (FLAG_array_bounds_checks_hoisting) Run<HBoundsCheckHoistingPhase>();
+  // Hoisted bounds checks leave counted loops without deopts, which is what
+  // the llvm loop vectorizer needs.
+  if (FLAG_array_bounds_checks_hoisting ||
+      (info()->is_llvm() && FLAG_llvm_bounds_checks_hoisting)) {
+    Run<HBoundsCheckHoistingPhase>();
+  }
   if (FLAG_array_index_dehoisting) Run<HDehoistIndexComputationsPhase>();
   if (FLAG_dead_code_elimination) Run<HDeadCodeEliminationPhase>();
 
@@ -1,12 +1,19 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <cstdio>
 #include <iomanip>
 #include <set>
 
+#if V8_LIBC_GLIBC
+#include <malloc.h>  // NOLINT
+#endif
+
+#include "src/base/cpu.h"
 #include "src/code-factory.h"
 #include "src/disassembler.h"
+#include "src/frames.h"
 #include "src/hydrogen-osr.h"
 #include "src/ic/ic.h"
 #include "src/safepoint-table.h"
@@ -21,25 +28,37 @@ namespace internal {
 
 #define __ llvm_ir_builder_->
 
+// Gives up on a case a Do* handler can't lower (yet). NewChunk() then
+// returns NULL and the graph goes to Lithium instead.
+#define UNSUPPORTED()               \
+  do {                              \
+    Retry(kLLVMCannotLowerGraph);   \
+    return;                         \
+  } while (false)
+
 auto LLVMGranularity::x64_target_triple = "x86_64-unknown-linux-gnu";
 const char* LLVMChunkBuilder::kGcStrategyName = "v8-gc";
 const std::string LLVMChunkBuilder::kPointersPrefix = "pointer_";
-llvm::Type* Types::i8 = nullptr;
-llvm::Type* Types::i16 = nullptr;
-llvm::Type* Types::i32 = nullptr;
-llvm::Type* Types::i64 = nullptr;
-llvm::Type* Types::float32 = nullptr;
-llvm::Type* Types::float64 = nullptr;
-llvm::PointerType* Types::ptr_i8 = nullptr;
-llvm::PointerType* Types::ptr_i16 = nullptr;
-llvm::PointerType* Types::ptr_i32 = nullptr;
-llvm::PointerType* Types::ptr_i64 = nullptr;
-llvm::PointerType* Types::ptr_float32 = nullptr;
-llvm::PointerType* Types::ptr_float64 = nullptr;
-llvm::Type* Types::tagged = nullptr;
-llvm::PointerType* Types::ptr_tagged = nullptr;
-llvm::Type* Types::smi = nullptr;
-llvm::Type* Types::ptr_smi = nullptr;
+const char* LLVMRelocationData::kRelocRecordsSectionName = ".llvm_v8_relocs";
+
+llvm::Type* Types::ForRepresentation(Representation r) const {
+  switch (r.kind()) {
+    case Representation::Kind::kInteger32:
+      return i32;
+    case Representation::Kind::kTagged:
+    case Representation::Kind::kExternal: // For now.
+      return tagged;
+    case Representation::Kind::kSmi:
+      return smi;
+    case Representation::Kind::kDouble:
+      return float64;
+    case Representation::Kind::kNone:
+      return nullptr;
+    default:
+      UNIMPLEMENTED();
+      return nullptr;
+  }
+}
 
 LLVMChunk::~LLVMChunk() {}
 
@@ -66,77 +85,244 @@ static void DumpSafepoints(Code* code) {
   std::cerr << "\n";
 }
 
-Handle<Code> LLVMChunk::Codegen() {
-  uint64_t address = LLVMGranularity::getInstance().GetFunctionAddress(
-      llvm_function_id_);
-  auto buf = LLVMGranularity::getInstance().memory_manager_ref()
-      ->LastAllocatedCode().buffer;
-  USE(buf);
+#if V8_LIBC_GLIBC
+// Bytes in use on the C++ heap of the whole process. Whatever the other
+// threads (e.g. the other concurrent recompilation workers) allocate or
+// free meanwhile is counted too, so this never goes into the size of a
+// phase, it is only printed next to it.
+static size_t ProcessHeapBytes() {
+  struct mallinfo info = mallinfo();
+  // Both are ints, which wrap past 2GB.
+  return static_cast<size_t>(static_cast<unsigned>(info.uordblks)) +
+         static_cast<size_t>(static_cast<unsigned>(info.hblkhd));
+}
+#endif
+
+LLVMPhase::LLVMPhase(const char* name, LLVMChunk* chunk)
+    : name_(name),
+      chunk_(chunk),
+      zone_start_allocation_size_(0),
+#if V8_LIBC_GLIBC
+      process_heap_start_size_(0),
+#endif
+      extra_allocated_bytes_(0),
+      timer_() {
+  if (FLAG_hydrogen_stats || FLAG_trace_opt) {
+    zone_start_allocation_size_ = chunk->zone()->allocation_size();
+#if V8_LIBC_GLIBC
+    process_heap_start_size_ = ProcessHeapBytes();
+#endif
+    timer_.Start();
+  }
+}
+
+LLVMPhase::~LLVMPhase() {
+  if (!FLAG_hydrogen_stats && !FLAG_trace_opt) return;
+  base::TimeDelta time = timer_.Elapsed();
+  size_t size = chunk_->zone()->allocation_size() -
+      zone_start_allocation_size_ + extra_allocated_bytes_;
+  if (FLAG_hydrogen_stats) {
+    chunk_->isolate()->GetHStatistics()->SaveTiming(name_, time, size);
+  }
+  if (FLAG_trace_opt) {
+    size_t process_heap_growth = 0;
+#if V8_LIBC_GLIBC
+    size_t process_heap_size = ProcessHeapBytes();
+    if (process_heap_size > process_heap_start_size_) {
+      process_heap_growth = process_heap_size - process_heap_start_size_;
+    }
+#endif
+    chunk_->AddPhaseStats(name_, time, size, process_heap_growth);
+  }
+}
+
+void LLVMChunk::AddPhaseStats(const char* name, base::TimeDelta time,
+                              size_t size, size_t process_heap_growth) {
+  PhaseStats stats = { name, time, size, process_heap_growth };
+  phase_stats_.Add(stats, zone());
+}
+
+void LLVMChunk::PrintPhaseStats() {
+  PrintF("[llvm phases:");
+  for (int i = 0; i < phase_stats_.length(); i++) {
+    const PhaseStats& stats = phase_stats_[i];
+    PrintF("%s %s %0.3f ms %zu bytes", i == 0 ? "" : ",", stats.name,
+           stats.time.InMillisecondsF(), stats.size);
+#if V8_LIBC_GLIBC
+    PrintF(" (process heap +%zu)", stats.process_heap_growth);
+#endif
+  }
+  PrintF("]\n");
+}
+
+// Feeds whatever is printed to it to an MD5 digest, so that the IR the
+// code cache key is computed from never has to be kept around as text.
+class MD5Stream final : public llvm::raw_ostream {
+ public:
+  explicit MD5Stream(llvm::MD5* md5) : md5_(md5), pos_(0) {}
+  ~MD5Stream() override { flush(); }
+
+ private:
+  void write_impl(const char* ptr, size_t size) override {
+    md5_->update(llvm::StringRef(ptr, size));
+    pos_ += size;
+  }
+  uint64_t current_pos() const override { return pos_; }
+
+  llvm::MD5* md5_;
+  uint64_t pos_;
+};
+
+std::string LLVMChunk::CodeCacheKey() {
+  llvm::MD5 md5;
+  {
+    MD5Stream os(&md5);
+    // Everything besides the IR which affects the machine code.
+    std::vector<std::string> machine_attributes;
+    LLVMGranularity::SetMachineAttributes(machine_attributes);
+    os << LLVMGranularity::CPUName();
+    for (auto& attribute : machine_attributes) os << " " << attribute;
+    os << " opt=" << FLAG_llvm_opt << " vectorize=" << FLAG_llvm_vectorize
+       << " pointers=" << number_of_pointers_ << "\n";
+    // The names are generated per compilation. The heap objects are indices
+    // already (see LLVMRelocationData::Add()). The external references stay:
+    // the code embeds them as immediates which nothing patches afterwards.
+    std::string module_id = module_->getModuleIdentifier();
+    std::string function_name = function_->getName();
+    module_->setModuleIdentifier("");
+    function_->setName("llvm_code_cache_key");
+    module_->print(os, nullptr);
+    module_->setModuleIdentifier(module_id);
+    function_->setName(function_name);
+    DCHECK(function_->getName() == function_name);
+  }
+  llvm::MD5::MD5Result digest;
+  md5.final(digest);
+  return std::string(reinterpret_cast<const char*>(digest), sizeof(digest));
+}
+
+void LLVMChunk::EmitMachineCode() {
+  DCHECK(module_);
+  DCHECK(backend_);
+
+  LLVMCodeCache& code_cache = LLVMGranularity::getInstance().code_cache();
+  std::string code_cache_key;
+  if (FLAG_llvm_code_cache) {
+    LLVMPhase phase("L_LLVM code cache lookup", this);
+    code_cache_key = CodeCacheKey();
+    if (code_cache.Lookup(code_cache_key, zone(), &code_desc_,
+                          &stackmaps_section_, &reloc_records_section_)) {
+      if (FLAG_trace_opt) PrintF("[llvm code cache hit]\n");
+      function_ = nullptr;
+      module_.reset();
+      return;
+    }
+  }
+
+  MergeEmbeddedObjects();
+  PlaceStatePoints();
+  RewriteStatePoints();
+  PinEmbeddedObjects();
+  Optimize();
+  function_ = nullptr; // Owned by the engine from now on.
+  uint64_t address;
+  {
+    LLVMPhase phase("L_LLVM machine code emission", this);
+    size_t sections_size = backend_->sections_size();
+    backend_->AddModule(std::move(module_));
+    address = backend_->GetFunctionAddress(llvm_function_id_);
+    phase.AddAllocatedBytes(backend_->sections_size() - sections_size);
+  }
+  MCJITMemoryManager* memory_manager = backend_->memory_manager_ref();
+  code_desc_ = memory_manager->CodeStartingAt(reinterpret_cast<byte*>(address));
+  List<Vector<byte>>& stackmap_list = memory_manager->stackmaps();
+  DCHECK_LE(stackmap_list.length(), 1);
+  if (stackmap_list.length() == 1) stackmaps_section_ = stackmap_list[0];
+  memory_manager->DropStackmaps();
+  reloc_records_section_ = memory_manager->reloc_records();
+  // Codegen() is yet to patch the code.
+  if (FLAG_llvm_code_cache) {
+    code_cache.Insert(code_cache_key, code_desc_, stackmaps_section_,
+                      reloc_records_section_);
+  }
 #ifdef DEBUG
   std::cerr << "\taddress == " <<  reinterpret_cast<void*>(address) << std::endl;
-  std::cerr << "\tlast allocated code section start == "
-      << static_cast<void*>(buf) << std::endl;
-  // FIXME(llvm):
-  // The right thing is address. But for now it's harder to get. So there.
-  if (reinterpret_cast<void*>(address) != static_cast<void*>(buf))
-    UNIMPLEMENTED();
-  LLVMGranularity::getInstance().Err();
-#else
-  USE(address);
+  backend_->Err();
 #endif
+}
 
+Handle<Code> LLVMChunk::Codegen() {
+  auto buf = code_desc_.buffer;
   Isolate* isolate = info()->isolate();
-  CodeDesc& code_desc =
-      LLVMGranularity::getInstance().memory_manager_ref()->LastAllocatedCode();
+  CodeDesc& code_desc = code_desc_;
 
   // This is of course totally untrue.
   code_desc.origin = &masm_;
 
 #ifdef DEBUG
-  LLVMGranularity::getInstance().Disass(
+  backend_->disassembler().Disass(
       code_desc.buffer, code_desc.buffer + code_desc.instr_size);
 #endif
 
-  StackMaps stackmaps = GetStackMaps();
+  StackMaps stackmaps;
+  {
+    LLVMPhase phase("Z_LLVM stackmap parsing", this);
+    stackmaps = GetStackMaps();
+  }
 
   // It is important that this call goes before EmitSafepointTable()
   // because it patches nop sequences to calls (and EmitSafepointTable
   // looks for calls in the instruction stream to determine their sizes).
-  std::vector<RelocInfo> reloc_info_from_patchpoints =
-      SetUpRelativeCalls(buf, stackmaps);
+  std::vector<RelocInfo> reloc_info_from_patchpoints;
+  {
+    LLVMPhase phase("Z_LLVM call patching", this);
+    reloc_info_from_patchpoints = SetUpRelativeCalls(buf, stackmaps);
+  }
 
   // This assembler owns it's buffer (it contains our SafepointTable).
   // FIXME(llvm): assembler shouldn't care for kGap for our case...
   auto initial_buffer_size = Max(code_desc.buffer_size / 6, 32);
   Assembler assembler(isolate, nullptr, initial_buffer_size);
-  EmitSafepointTable(&assembler, stackmaps, buf);
   CodeDesc safepoint_table_desc;
-  assembler.GetCode(&safepoint_table_desc);
-
-  Vector<byte> reloc_bytevector = GetFullRelocationInfo(
-      code_desc, reloc_info_from_patchpoints);
+  {
+    LLVMPhase phase("Z_LLVM safepoint table", this);
+    OrderLazyBailoutsByPc(stackmaps, buf);
+    EmitSafepointTable(&assembler, stackmaps, buf);
+    if (graph()->has_osr()) {
+      EmitOsrEntry(&assembler, code_desc, &reloc_info_from_patchpoints);
+    }
+    assembler.GetCode(&safepoint_table_desc);
+    phase.AddAllocatedBytes(safepoint_table_desc.buffer_size);
+  }
 
-  // Allocate and install the code.
-  if (info()->IsStub()) UNIMPLEMENTED(); // Probably different flags for stubs.
-  Code::Flags flags = Code::ComputeFlags(info()->output_code_kind());
-  Handle<Code> code = isolate->factory()->NewLLVMCode(
-      code_desc, safepoint_table_desc, &reloc_bytevector, flags);
-  isolate->counters()->total_compiled_code_size()->Increment(
-      code->instruction_size());
+  Handle<Code> code;
+  {
+    LLVMPhase phase("Z_LLVM code installation", this);
+    Vector<byte> reloc_bytevector = GetFullRelocationInfo(
+        code_desc, reloc_info_from_patchpoints);
 
-  SetUpDeoptimizationData(code, stackmaps);
+    // Allocate and install the code.
+    // Probably different flags for stubs.
+    if (info()->IsStub()) UNIMPLEMENTED();
+    Code::Flags flags = Code::ComputeFlags(info()->output_code_kind());
+    code = isolate->factory()->NewLLVMCode(
+        code_desc, safepoint_table_desc, &reloc_bytevector, flags);
+    isolate->counters()->total_compiled_code_size()->Increment(
+        code->instruction_size());
+    phase.AddAllocatedBytes(code->Size());
+  }
 
-  // TODO(llvm): it is not thread-safe. It's not anything-safe.
-  // We assume a new function gets attention after the previous one
-  // has been fully processed by llv8.
-  LLVMGranularity::getInstance().memory_manager_ref()->DropStackmaps();
+  {
+    LLVMPhase phase("Z_LLVM deoptimization data", this);
+    SetUpDeoptimizationData(code, stackmaps);
+  }
 #ifdef DEBUG
   std::cerr << "Instruction start: "
       << reinterpret_cast<void*>(code->instruction_start()) << std::endl;
 #endif
 
 #ifdef DEBUG
-  LLVMGranularity::getInstance().Disass(
+  backend_->disassembler().Disass(
       code->instruction_start(),
       code->instruction_start() + code->instruction_size());
 
@@ -150,9 +336,24 @@ Handle<Code> LLVMChunk::Codegen() {
 #else
   USE(DumpSafepoints);
 #endif
+  // Everything we need is in the heap by now.
+  ReleaseBackend();
   return code;
 }
 
+void LLVMChunk::ReleaseBackend() {
+  if (backend_ == nullptr) return;
+  code_desc_.buffer = nullptr;
+  stackmaps_section_ = Vector<byte>();
+  reloc_records_section_ = Vector<byte>();
+  // Not handed over to MCJIT yet. Must die before the context does.
+  module_.reset();
+  function_ = nullptr;
+  backend_->ReleaseCompiledCode();
+  LLVMGranularity::getInstance().ReleaseBackend(backend_);
+  backend_ = nullptr;
+}
+
 
 void LLVMChunk::WriteTranslation(LLVMEnvironment* environment,
                                  Translation* translation,
@@ -169,6 +370,9 @@ void LLVMChunk::WriteTranslation(LLVMEnvironment* environment,
   // TODO(llvm): this isn't very good performance-wise. Esp. considering
   // the result of this call is the same across recursive invocations.
   auto stackmap_record = stackmaps.computeRecordMap()[patchpoint_id];
+  // The deoptimizer reads the frame of a lazy bailout after the call,
+  // and so after any GC which has happened meanwhile.
+  bool is_lazy = reloc_data_->IsPatchpointIdLazyDeopt(patchpoint_id);
 
   // The translation includes one command per value in the environment.
   int translation_size = environment->translation_size();
@@ -234,8 +438,19 @@ void LLVMChunk::WriteTranslation(LLVMEnvironment* environment,
     // since we generated them optimization has happened
     // (therefore those values are now invalid).
 
+    if (environment->IsCallResultAt(i)) {
+      // Lazy bailout right after the call which has produced the value.
+      // The deoptimization entry saves the registers, rax included.
+      DCHECK(environment->HasTaggedValueAt(i));
+      translation->StoreRegister(rax);
+      continue;
+    }
+
     llvm::Value* value = environment->values()->at(i);
     StackMaps::Location location = stackmap_record.locations[i + start_index];
+    if (is_lazy && environment->IsGcPointerAt(i)) {
+      location = RelocatedLocation(stackmap_record, location);
+    }
     AddToTranslation(environment,
                      translation,
                      value,
@@ -249,6 +464,35 @@ void LLVMChunk::WriteTranslation(LLVMEnvironment* environment,
   }
 }
 
+StackMaps::Location LLVMChunk::RelocatedLocation(
+    const StackMaps::Record& record, const StackMaps::Location& location) {
+  // Deopt arguments are followed by the (base, derived) pairs of the gc
+  // pointers live across the call. RewriteStatePoints() makes the pointers
+  // among our deopt arguments live across it, and the statepoint lowering
+  // spills a value once, so the deopt argument shares its slot with the
+  // pointer. Should that ever change, fail here rather than have the
+  // deoptimizer read a stale pointer.
+  if (location.kind == StackMaps::Location::kConstant ||
+      location.kind == StackMaps::Location::kConstantIndex) {
+    return location;  // Not a heap pointer after all (e.g. a null).
+  }
+  auto num_deopt_args = record.locations[2].offset;
+  for (size_t i = 3 + num_deopt_args; i < record.locations.size(); i++) {
+    const StackMaps::Location& relocated = record.locations[i];
+    if ((relocated.kind == StackMaps::Location::kDirect ||
+         relocated.kind == StackMaps::Location::kIndirect) &&
+        (location.kind == StackMaps::Location::kDirect ||
+         location.kind == StackMaps::Location::kIndirect) &&
+        relocated.dwarf_reg.reg().IntReg().is(
+            location.dwarf_reg.reg().IntReg()) &&
+        relocated.offset == location.offset) {
+      return relocated;
+    }
+  }
+  FATAL("A gc pointer of a lazy bailout is not relocated by the statepoint");
+  return location;
+}
+
 // As far as I understand, index is CallerPC-relative offset
 // i.e. relative to the stack cell holding the ret address.
 static int FpRelativeOffsetToIndex(int32_t offset) {
@@ -285,9 +529,11 @@ void LLVMChunk::AddToTranslation(
 
   // TODO(llvm): What about StoreDouble..()?
   // It's an unimplemented case which might be hidden
-  if (location.kind == StackMaps::Location::kDirect) {
-    UNIMPLEMENTED();
-  } else if (location.kind == StackMaps::Location::kIndirect) {
+  // FIXME(llvm): LLVM bug (should be Indirect), see EmitSafepointTable().
+  // Deopt arguments of statepoints (lazy bailouts) are spilled and reported
+  // as kDirect, patchpoint live values are kIndirect. Both mean [rbp + offset].
+  if (location.kind == StackMaps::Location::kDirect ||
+      location.kind == StackMaps::Location::kIndirect) {
     Register reg = location.dwarf_reg.reg().IntReg();
     if (!reg.is(rbp)) UNIMPLEMENTED();
     auto index = FpRelativeOffsetToIndex(location.offset);
@@ -335,14 +581,6 @@ void LLVMChunk::AddToTranslation(
           isolate()->factory()->NewNumberFromInt(int_val, TENURED));
       translation->StoreLiteral(literal_id);
     } else {
-      if (reloc_data_->reloc_map().count(value)) {
-        auto pair = reloc_data_->reloc_map()[value];
-        LLVMRelocationData::ExtendedInfo minfo = pair.second;
-        if (minfo.cell_extended) {
-          DCHECK((value & 0xffffffff) == LLVMChunkBuilder::kExtFillingValue);
-          value >>= 32;
-        }
-      }
       Handle<Object> const_obj =  bit_cast<Handle<HeapObject> >(
           static_cast<intptr_t>(value));
       int literal_id = deopt_data_->DefineDeoptimizationLiteral(const_obj);
@@ -378,6 +616,14 @@ int LLVMChunk::WriteTranslationFor(LLVMEnvironment* env,
   // is the same as that of the TranslationBuffer i.e. the most outer first.
   auto stackmap_record = stackmaps.computeRecordMap()[patchpoint_id];
   auto total_size = IntHelper::AsInt(stackmap_record.locations.size());
+  if (reloc_data_->IsPatchpointIdLazyDeopt(patchpoint_id)) {
+    // A statepoint. Its deopt arguments (our environment) are preceded by
+    // the three constants (see EmitSafepointTable) and followed by the gc
+    // pointers, so they don't run up to the end of the record.
+    DCHECK_EQ(stackmap_record.locations[2].kind,
+              StackMaps::Location::kConstant);
+    total_size = 3 + stackmap_record.locations[2].offset;
+  }
   auto start_index_inner = total_size - env->translation_size();
   WriteTranslation(
       env, &translation, stackmaps, patchpoint_id, start_index_inner);
@@ -476,18 +722,13 @@ std::vector<RelocInfo> LLVMChunk::SetUpRelativeCalls(
 }
 
 StackMaps LLVMChunk::GetStackMaps() {
-  List<byte*>& stackmap_list =
-      LLVMGranularity::getInstance().memory_manager_ref()->stackmaps();
-
-  if (stackmap_list.length() == 0) {
+  if (stackmaps_section_.is_empty()) {
     StackMaps empty;
     return empty;
   }
 
-  DCHECK(stackmap_list.length() == 1);
-
   StackMaps stackmaps;
-  DataView view(stackmap_list[0]);
+  DataView view(stackmaps_section_.start());
   stackmaps.parse(&view);
 #ifdef DEBUG
   stackmaps.dumpMultiline(std::cerr, "  ");
@@ -499,6 +740,20 @@ StackMaps LLVMChunk::GetStackMaps() {
   return stackmaps;
 }
 
+unsigned LLVMChunk::CallReturnOffset(const StackMaps::Record& record,
+                                     Address instruction_start) {
+  auto patchpoint_id = record.patchpointID;
+  unsigned pc_offset = record.instructionOffset;
+  // We have written the calls of patchpoints ourselves
+  // (see SetUpRelativeCalls), so there's nothing to decode.
+  int call_instr_size = reloc_data_->IsPatchpointIdReloc(patchpoint_id)
+      ? Assembler::kShortCallInstructionLength
+      : backend_->disassembler().CallInstructionSizeAt(
+            instruction_start + pc_offset);
+  DCHECK_GT(call_instr_size, 0);
+  return pc_offset + call_instr_size;
+}
+
 void LLVMChunk::EmitSafepointTable(Assembler* assembler,
                                    StackMaps& stackmaps,
                                    Address instruction_start) {
@@ -510,7 +765,6 @@ void LLVMChunk::EmitSafepointTable(Assembler* assembler,
   int safepoint_arguments = 0;
   // TODO(llvm): There's also kWithRegisters. And with doubles...
   Safepoint::Kind kind = Safepoint::kSimple;
-  Safepoint::DeoptMode deopt_mode = Safepoint::kLazyDeopt;
 
   for (auto stackmap_record : stackmaps.records) {
     auto patchpoint_id = stackmap_record.patchpointID;
@@ -518,39 +772,65 @@ void LLVMChunk::EmitSafepointTable(Assembler* assembler,
 
     auto num_passed_args =
         reloc_data_->GetNumSafepointFuncionArgs(patchpoint_id);
-    unsigned pc_offset = stackmap_record.instructionOffset;
-    int call_instr_size = LLVMGranularity::getInstance().CallInstructionSizeAt(
-        instruction_start + pc_offset);
-    DCHECK_GT(call_instr_size, 0);
-    pc_offset += call_instr_size;
+    unsigned pc_offset = CallReturnOffset(stackmap_record, instruction_start);
+    // RecordLazyDeoptimizationIndex() hands its index out to every
+    // kLazyDeopt safepoint defined since the previous call, so only
+    // the calls which do have a lazy bailout may be kLazyDeopt.
+    bool has_lazy_bailout = reloc_data_->IsPatchpointIdLazyDeopt(patchpoint_id);
+    Safepoint::DeoptMode deopt_mode = has_lazy_bailout
+        ? Safepoint::kLazyDeopt
+        : Safepoint::kNoLazyDeopt;
     Safepoint safepoint = safepoints_builder.DefineSafepoint(
         pc_offset, kind, safepoint_arguments, deopt_mode, num_passed_args);
+    if (has_lazy_bailout) {
+      safepoints_builder.RecordLazyDeoptimizationIndex(
+          reloc_data_->GetLazyBailoutId(patchpoint_id));
+    }
 
     // First three locations are constants describing the calling convention,
     // flags passed to the statepoint intrinsic and the number of following
-    // deopt Locations.
+    // deopt Locations. The deopt Locations (the lazy bailout environment)
+    // may hold untagged values, the gc pointers come after them.
     CHECK(stackmap_record.locations.size() >= 3);
+    DCHECK_EQ(stackmap_record.locations[2].kind,
+              StackMaps::Location::kConstant);
+    auto num_deopt_args = stackmap_record.locations[2].offset;
+    DCHECK_EQ(num_deopt_args == 0, !has_lazy_bailout);
 
-    for (auto i = 3; i < stackmap_record.locations.size(); i++) {
+    for (auto i = 3 + num_deopt_args;
+         i < stackmap_record.locations.size(); i++) {
       auto location = stackmap_record.locations[i];
-      // FIXME(llvm): LLVM bug (should be Indirect). See discussion here:
-      // http://lists.llvm.org/pipermail/llvm-dev/2015-November/092394.html
-      if (location.kind == StackMaps::Location::kDirect) {
-        Register reg = location.dwarf_reg.reg().IntReg();
-        if (!reg.is(rbp)) UNIMPLEMENTED();
-        DCHECK_LT(location.offset, 0);
-        DCHECK_EQ(location.size, kPointerSize);
-        auto index = -location.offset / kPointerSize;
-        // Safepoint table indices are 0-based from the beginning of the spill
-        // slot area, adjust appropriately.
-        index -= kPhonySpillCount;
-        safepoint.DefinePointerSlot(index, zone());
-      } else if (location.kind == StackMaps::Location::kIndirect) {
-        UNIMPLEMENTED();
-      } else if (location.kind == StackMaps::Location::kConstantIndex) {
-        // FIXME(llvm): why do we have these kinds of locations?
-      } else {
-        UNIMPLEMENTED();
+      switch (location.kind) {
+        // FIXME(llvm): LLVM bug (should be Indirect). See discussion here:
+        // http://lists.llvm.org/pipermail/llvm-dev/2015-November/092394.html
+        // Both kinds name the same [rbp + offset] spill slot.
+        case StackMaps::Location::kDirect:
+        case StackMaps::Location::kIndirect: {
+          Register reg = location.dwarf_reg.reg().IntReg();
+          if (!reg.is(rbp)) UNIMPLEMENTED();
+          DCHECK_LT(location.offset, 0);
+          DCHECK_EQ(location.size, kPointerSize);
+          auto index = -location.offset / kPointerSize;
+          // Safepoint table indices are 0-based from the beginning of the
+          // spill slot area, adjust appropriately.
+          index -= kPhonySpillCount;
+          DCHECK_GE(index, 0);
+          DCHECK_LT(index, SpilledCount(stackmaps));
+          safepoint.DefinePointerSlot(index, zone());
+          break;
+        }
+        case StackMaps::Location::kRegister:
+          // A tagged value living in a register across the call. Our calling
+          // conventions don't preserve any registers over a call, so nobody
+          // would visit (let alone update) it. This is a lowering bug.
+          FATAL("Statepoint keeps a tagged value in a register");
+          break;
+        case StackMaps::Location::kConstant:
+        case StackMaps::Location::kConstantIndex:
+          // Constants are not heap pointers.
+          break;
+        default:
+          UNIMPLEMENTED();
       }
     }
   }
@@ -559,6 +839,72 @@ void LLVMChunk::EmitSafepointTable(Assembler* assembler,
   safepoints_builder.Emit(assembler, SpilledCount(stackmaps), llvmed);
 }
 
+void LLVMChunk::EmitOsrEntry(Assembler* assembler, const CodeDesc& code_desc,
+                             std::vector<RelocInfo>* reloc_info) {
+  // Generate_OnStackReplacement() gets here with rbp pointing to the
+  // unoptimized frame and rsp to its top. Our frame is going to have the
+  // same rbp (both are frames of the same function called with the same
+  // arguments), and thus to overwrite the slots. So they go to a buffer.
+  // Nothing can run between the copying and the (volatile, so that LLVM
+  // keeps them ahead of any statepoint) loads in the OSR entry block (see
+  // DoUnknownOSRValue), so one buffer per code object is enough.
+  int slots = graph()->osr()->UnoptimizedFrameSlots();
+  Handle<ByteArray> buffer = isolate()->factory()->NewByteArray(
+      Max(slots, 1) * kPointerSize, TENURED);
+  // See Factory::NewLLVMCode() for where the assembler's code goes.
+  int table_offset = RoundUp(code_desc.instr_size, kIntSize);
+  osr_pc_offset_ = table_offset + assembler->pc_offset();
+
+  intptr_t buffer_location = reinterpret_cast<intptr_t>(buffer.location());
+  assembler->movq(rbx, static_cast<int64_t>(buffer_location));
+  RelocInfo rinfo(RelocInfo::EMBEDDED_OBJECT, buffer_location);
+  rinfo.set_pc(code_desc.buffer + table_offset +
+               assembler->pc_offset() - kInt64Size);
+  reloc_info->push_back(rinfo);
+  assembler->leap(rbx, Operand(rbx, ByteArray::kHeaderSize - kHeapObjectTag));
+  for (int i = 0; i < slots; i++) {
+    int offset = StandardFrameConstants::kExpressionsOffset - i * kPointerSize;
+    assembler->movp(r10, Operand(rbp, offset));
+    assembler->movp(Operand(rbx, i * kPointerSize), r10);
+  }
+  assembler->movp(rsi, Operand(rbp, StandardFrameConstants::kContextOffset));
+  assembler->movp(rdi, Operand(rbp, JavaScriptFrameConstants::kFunctionOffset));
+  // Back to the state right after the call, the return address on top.
+  assembler->movp(rsp, rbp);
+  assembler->popq(rbp);
+  // jmp rel32 to the start of the function.
+  assembler->db(0xE9);
+  int jmp_end = table_offset + assembler->pc_offset() + kInt32Size;
+  assembler->dd(static_cast<uint32_t>(-jmp_end));
+}
+
+std::vector<RelocInfo> LLVMChunk::GetRelocInfoFromRecords(
+    CodeDesc& code_desc) {
+  std::vector<RelocInfo> result;
+  Address start = code_desc.buffer;
+  Address end = code_desc.buffer + code_desc.instr_size;
+  LLVMRelocationData::RelocMap& reloc_map = reloc_data_->reloc_map();
+  DCHECK_EQ(reloc_records_section_.length() % kInt64Size, 0);
+  for (int offset = 0; offset < reloc_records_section_.length();
+       offset += kInt64Size) {
+    // The immediate is the last 8 bytes of the movabs.
+    Address imm_end = reinterpret_cast<Address>(
+        Memory::uint64_at(reloc_records_section_.start() + offset));
+    Address pc = imm_end - kInt64Size;
+    CHECK(start <= pc && imm_end <= end);
+    uint64_t index = Memory::uint64_at(pc);
+    DCHECK(reloc_map.count(index));
+    RelocInfo rinfo = reloc_map[index];
+    DCHECK(rinfo.rmode() == RelocInfo::CELL ||
+           rinfo.rmode() == RelocInfo::EMBEDDED_OBJECT);
+    // Code::CopyFrom() expects the handle location.
+    Memory::uint64_at(pc) = static_cast<uint64_t>(rinfo.data());
+    rinfo.set_pc(pc);
+    result.push_back(rinfo);
+  }
+  return result;
+}
+
 Vector<byte> LLVMChunk::GetFullRelocationInfo(
     CodeDesc& code_desc,
     const std::vector<RelocInfo>& reloc_data_from_patchpoints) {
@@ -566,9 +912,7 @@ Vector<byte> LLVMChunk::GetFullRelocationInfo(
   // 1) reloc info already present in reloc_data_;
   // 2) patchpoints (CODE_TARGET reloc info has to be extracted from them).
   const std::vector<RelocInfo>& reloc_data_2 = reloc_data_from_patchpoints;
-  std::vector<RelocInfo> reloc_data_1 = LLVMGranularity::getInstance().Patch(
-      code_desc.buffer, code_desc.buffer + code_desc.instr_size,
-      reloc_data_->reloc_map());
+  std::vector<RelocInfo> reloc_data_1 = GetRelocInfoFromRecords(code_desc);
   RelocInfoBuffer buffer_writer(8, code_desc.buffer);
   // Mege reloc infos, sort all of them by pc_ and write to the buffer.
   std::vector<RelocInfo> reloc_data_merged;
@@ -592,41 +936,72 @@ int LLVMChunk::SpilledCount(const StackMaps& stackmaps) {
   return stack_size / kStackSlotSize - kPhonySpillCount;
 }
 
+void LLVMChunk::OrderLazyBailoutsByPc(const StackMaps& stackmaps,
+                                      Address instruction_start) {
+  // The ids are handed out in the order the calls are built, but LLVM lays
+  // out the blocks as it pleases. Only the lazy bailouts have pcs, so it's
+  // enough to shuffle their ids among themselves. That leaves alone the ids
+  // of the eager ones, which their deopt exits have been patched to use.
+  std::vector<std::pair<unsigned, int32_t>> pcs_and_patchpoint_ids;
+  std::vector<int> bailout_ids;
+  for (const auto& record : stackmaps.records) {
+    int32_t patchpoint_id = record.patchpointID;
+    if (!reloc_data_->IsPatchpointIdLazyDeopt(patchpoint_id)) continue;
+    pcs_and_patchpoint_ids.push_back(std::make_pair(
+        CallReturnOffset(record, instruction_start), patchpoint_id));
+    bailout_ids.push_back(reloc_data_->GetLazyBailoutId(patchpoint_id));
+  }
+  std::sort(pcs_and_patchpoint_ids.begin(), pcs_and_patchpoint_ids.end());
+  std::sort(bailout_ids.begin(), bailout_ids.end());
+  for (size_t i = 0; i < bailout_ids.size(); i++) {
+    reloc_data_->SetLazyBailoutId(pcs_and_patchpoint_ids[i].second,
+                                  bailout_ids[i]);
+  }
+}
+
 void LLVMChunk::SetUpDeoptimizationData(Handle<Code> code,
                                         StackMaps& stackmaps) {
   code->set_stack_slots(SpilledCount(stackmaps));
 
-  std::vector<uint32_t> sorted_ids;
+  // Patchpoint id -> the stack map record.
+  std::map<uint32_t, StackMaps::Record*> deopt_records;
   int max_deopt = 0;
   for (auto i = 0; i < stackmaps.records.size(); i++) {
     auto id = stackmaps.records[i].patchpointID;
+    int bailout_id;
     if (reloc_data_->IsPatchpointIdDeopt(id)) {
-      sorted_ids.push_back(id);
-      int bailout_id = reloc_data_->GetBailoutId(id);
-      if (bailout_id > max_deopt) max_deopt = bailout_id;
+      bailout_id = reloc_data_->GetBailoutId(id);
+    } else if (reloc_data_->IsPatchpointIdLazyDeopt(id)) {
+      bailout_id = reloc_data_->GetLazyBailoutId(id);
+    } else {
+      continue;
     }
+    // The calls with deopt ids are noduplicate (see CallStatePoint()).
+    CHECK(!deopt_records.count(id));
+    deopt_records[id] = &stackmaps.records[i];
+    if (bailout_id > max_deopt) max_deopt = bailout_id;
   }
   CHECK(max_deopt >= 0);
-  std::sort(sorted_ids.begin(), sorted_ids.end());
   size_t true_deopt_count = max_deopt + 1;
   Handle<DeoptimizationInputData> data =
       DeoptimizationInputData::New(isolate(),
                                    IntHelper::AsInt(true_deopt_count), TENURED);
 
-  // FIXME(llvm): This invariant fails when optimizer duplicates a deopt branch.
-  CHECK_EQ(std::set<int>(sorted_ids.begin(), sorted_ids.end()).size(),
-           sorted_ids.size());
   if (true_deopt_count == 0) return;
 
-  // It's important. It seems something expects deopt entries to be stored
-  // is the same order they were added.
-  for (auto deopt_entry_number = 0;
-      deopt_entry_number < sorted_ids.size();
-      deopt_entry_number++) {
+  // Deoptimizer::PatchCodeForDeoptimization() patches every entry whose
+  // pc is not -1, so that includes the entries whose patchpoints didn't
+  // survive optimization.
+  for (auto i = 0; i < true_deopt_count; i++)
+    data->SetPc(i, Smi::FromInt(-1));
 
-    auto stackmap_id = sorted_ids[deopt_entry_number];
-    CHECK(reloc_data_->IsPatchpointIdDeopt(stackmap_id));
-    int bailout_id = reloc_data_->GetBailoutId(stackmap_id);
+  // It's important. It seems something expects deopt entries to be stored
+  // is the same order they were added (std::map iterates ids in order).
+  for (auto& id_and_record : deopt_records) {
+    auto stackmap_id = id_and_record.first;
+    bool is_lazy = reloc_data_->IsPatchpointIdLazyDeopt(stackmap_id);
+    int bailout_id = is_lazy ? reloc_data_->GetLazyBailoutId(stackmap_id)
+                             : reloc_data_->GetBailoutId(stackmap_id);
 
     auto env = deopt_data_->GetEnvironmentByPatchpointId(stackmap_id);
 
@@ -634,16 +1009,21 @@ void LLVMChunk::SetUpDeoptimizationData(Handle<Code> code,
     if (env->HasBeenRegistered()) continue;
 
     int translation_index = WriteTranslationFor(env, stackmaps);
-    // pc offset can be obtained from the stackmap TODO(llvm):
-    // but we do not support lazy deopt yet (and for eager it should be -1)
-    env->Register(bailout_id, translation_index, -1);
+    // Eager deopts jump to their entry themselves. Lazy ones get the call
+    // to the entry patched in right where the call they bail out after
+    // returns to (there is room left for it, see EmitLazyDeoptPadding).
+    // Their pcs increase along with their ids, see OrderLazyBailoutsByPc().
+    int pc_offset = is_lazy
+        ? CallReturnOffset(*id_and_record.second, code->instruction_start())
+        : -1;
+    env->Register(bailout_id, translation_index, pc_offset);
 
     data->SetAstId(bailout_id, env->ast_id());
     data->SetTranslationIndex(bailout_id,
                               Smi::FromInt(translation_index));
     data->SetArgumentsStackHeight(bailout_id,
                                   Smi::FromInt(env->arguments_stack_height()));
-    data->SetPc(deopt_entry_number, Smi::FromInt(-1));
+    data->SetPc(bailout_id, Smi::FromInt(pc_offset));
   }
 
   auto length_before = deopt_data_->deoptimization_literals().length();
@@ -679,133 +1059,323 @@ void LLVMChunk::SetUpDeoptimizationData(Handle<Code> code,
   }
   data->SetWeakCellCache(Smi::FromInt(0)); // I don't know what this is.
   data->SetOsrAstId(Smi::FromInt(info()->osr_ast_id().ToInt()));
-  data->SetOsrPcOffset(Smi::FromInt(6));
+  data->SetOsrPcOffset(Smi::FromInt(osr_pc_offset_));
 
   code->set_deoptimization_data(*data);
 }
 
-// TODO(llvm): refactor. DRY + move disass features to a separate file.
-// Also, we shall not need an instance of LLVMGranularity for such things.
-// Returns size of the instruction starting at pc or -1 if an error occurs.
-int LLVMGranularity::CallInstructionSizeAt(Address pc) {
-  auto triple = x64_target_triple;
+void LLVMBackend::AddModule(std::unique_ptr<llvm::Module> module) {
+  if (!engine_) {
+    std::vector<std::string> machine_attributes;
+    LLVMGranularity::SetMachineAttributes(machine_attributes);
+
+    std::unique_ptr<MCJITMemoryManager> manager =
+        MCJITMemoryManager::Create(&sections_zone_);
+    memory_manager_ref_ = manager.get(); // non-owning!
+
+    llvm::ExecutionEngine* raw = llvm::EngineBuilder(std::move(module))
+      .setMCJITMemoryManager(std::move(manager))
+      .setErrorStr(&err_str_)
+      .setEngineKind(llvm::EngineKind::JIT)
+      .setMAttrs(machine_attributes)
+      .setMCPU(LLVMGranularity::CPUName())
+      .setRelocationModel(llvm::Reloc::PIC_) // position independent code
+      // A good read on code models can be found here:
+      // eli.thegreenplace.net/2012/01/03/understanding-the-x64-code-models
+      // We use a modified Large code model, which uses rip-relative
+      // addressing for jump tables.
+      .setCodeModel(llvm::CodeModel::Large)
+      .setOptLevel(llvm::CodeGenOpt::Aggressive) // backend opt level
+      .create();
+    engine_ = std::unique_ptr<llvm::ExecutionEngine>(raw);
+    CHECK(engine_);
+  } else {
+    engine_->addModule(std::move(module));
+  }
+  // Finalize each time after adding a new module
+  // (assuming the added module is constructed and won't change)
+  engine_->finalizeObject();
+}
+
+llvm::TargetMachine* LLVMBackend::target_machine() {
+  if (!target_machine_) {
+    std::vector<std::string> machine_attributes;
+    LLVMGranularity::SetMachineAttributes(machine_attributes);
+    llvm::SmallVector<std::string, 16> attrs(machine_attributes.begin(),
+                                             machine_attributes.end());
+    target_machine_.reset(llvm::EngineBuilder().selectTarget(
+        llvm::Triple(LLVMGranularity::x64_target_triple), "",
+        LLVMGranularity::CPUName(), attrs));
+    CHECK(target_machine_);
+  }
+  return target_machine_.get();
+}
+
+// See LLVMBackend::RecordPassTime(). Only follows function passes, so it
+// splits up the loop pass pipelines (each loop pass then walks the loops on
+// its own), which is fine for a measurement.
+class PassTimer final : public llvm::FunctionPass {
+ public:
+  static char ID;
+
+  PassTimer(const char* pass_name, LLVMBackend* backend)
+      : llvm::FunctionPass(ID), pass_name_(pass_name), backend_(backend) {}
+
+  void getAnalysisUsage(llvm::AnalysisUsage& usage) const override {
+    usage.setPreservesAll();
+  }
+
+  bool runOnFunction(llvm::Function& function) override {
+    backend_->RecordPassTime(pass_name_);
+    return false;
+  }
+
+ private:
+  const char* pass_name_;
+  LLVMBackend* backend_;
+};
+
+char PassTimer::ID = 0;
+
+// Every module holds a single function with no globals of interest, so
+// the interprocedural part of -O3 is of no use to us, and neither are the
+// passes that turn code into library calls (LoopIdiom) or care about C
+// and C++ semantics. Our memory operations come with TBAA and the
+// functions have few allocas, so a few rounds of CSE, instcombine and
+// LICM do most of the job.
+void LLVMBackend::BuildPassManager() {
+  bool fast = strcmp(FLAG_llvm_opt, "fast") == 0;
+  bool max = strcmp(FLAG_llvm_opt, "max") == 0;
+  if (!fast && !max && strcmp(FLAG_llvm_opt, "balanced") != 0) {
+    FATAL("--llvm-opt must be one of fast, balanced and max");
+  }
+  pass_manager_.reset(new llvm::legacy::PassManager());
+  llvm::legacy::PassManager& pm = *pass_manager_;
+  // Starts the clock of the first pass.
+  if (FLAG_llvm_time_passes) pm.add(new PassTimer(nullptr, this));
+  // Without the target's cost model the vectorizers think there are
+  // no vector registers.
+  pm.add(llvm::createTargetTransformInfoWrapperPass(
+      target_machine()->getTargetIRAnalysis()));
+  pm.add(llvm::createTypeBasedAAWrapperPass());
+  pm.add(llvm::createScopedNoAliasAAWrapperPass());
+  pm.add(llvm::createBasicAAWrapperPass());
+
+  AddPass(llvm::createSROAPass());
+  AddPass(llvm::createEarlyCSEPass());
+  AddPass(llvm::createCFGSimplificationPass());
+  AddPass(llvm::createInstructionCombiningPass());
+  if (fast) {
+    AddPass(llvm::createCFGSimplificationPass());
+    return;
+  }
+
+  AddPass(llvm::createCorrelatedValuePropagationPass());
+  AddPass(llvm::createJumpThreadingPass());
+  AddPass(llvm::createCFGSimplificationPass());
+  AddPass(llvm::createReassociatePass());
+  // Loops.
+  AddPass(llvm::createLoopRotatePass());
+  AddPass(llvm::createLICMPass());
+  AddPass(llvm::createLoopUnswitchPass());
+  AddPass(llvm::createInstructionCombiningPass());
+  AddPass(llvm::createIndVarSimplifyPass());
+  AddPass(llvm::createLoopDeletionPass());
+  // Redundancies left over by Hydrogen and the lowering.
+  if (max) AddPass(llvm::createMergedLoadStoreMotionPass());
+  AddPass(llvm::createGVNPass());
+  AddPass(llvm::createSCCPPass());
+  AddPass(llvm::createInstructionCombiningPass());
+  if (max) {
+    AddPass(llvm::createJumpThreadingPass());
+    AddPass(llvm::createCorrelatedValuePropagationPass());
+  }
+  AddPass(llvm::createDeadStoreEliminationPass());
+  AddPass(llvm::createLICMPass());
+  AddPass(llvm::createAggressiveDCEPass());
+  AddPass(llvm::createCFGSimplificationPass());
+  AddPass(llvm::createInstructionCombiningPass());
+
+  if (FLAG_llvm_vectorize) {
+    AddPass(llvm::createLoopRotatePass());
+    bool no_unrolling = !max;
+    AddPass(llvm::createLoopVectorizePass(no_unrolling));
+    AddPass(llvm::createInstructionCombiningPass());
+    AddPass(llvm::createSLPVectorizerPass());
+    AddPass(llvm::createEarlyCSEPass());
+  }
+  if (max) {
+    AddPass(llvm::createLoopUnrollPass());
+    AddPass(llvm::createInstructionCombiningPass());
+    AddPass(llvm::createLICMPass());
+  }
+  AddPass(llvm::createCFGSimplificationPass());
+}
+
+void LLVMBackend::AddPass(llvm::Pass* pass) {
+  DCHECK(pass_manager_);
+  const char* pass_name = pass->getPassName();
+  pass_manager_->add(pass);
+  if (FLAG_llvm_time_passes) {
+    pass_manager_->add(new PassTimer(pass_name, this));
+  }
+}
+
+void LLVMBackend::RecordPassTime(const char* pass_name) {
+  if (!pass_timer_.IsStarted()) {
+    DCHECK_NULL(pass_name);
+    pass_timer_.Start();
+    return;
+  }
+  PassTime pass_time = { pass_name, pass_timer_.Restart() };
+  pass_times_.push_back(pass_time);
+}
+
+void LLVMBackend::Optimize(llvm::Module* module) {
+  if (!pass_manager_) BuildPassManager();
+  pass_manager_->run(*module);
+  if (FLAG_llvm_time_passes) {
+    pass_timer_.Stop();
+    PrintF("[llvm passes for %s:", module->getModuleIdentifier().c_str());
+    for (size_t i = 0; i < pass_times_.size(); i++) {
+      PrintF("%s %s %0.3f ms", i == 0 ? "" : ",", pass_times_[i].name,
+             pass_times_[i].time.InMillisecondsF());
+    }
+    PrintF("]\n");
+    pass_times_.clear();
+  }
+}
+
+void LLVMBackend::ReleaseCompiledCode() {
+  // The engine has to go before the context its modules live in.
+  engine_.reset();
+  memory_manager_ref_ = nullptr;
+  // Keeps a small segment around for the next compilation.
+  sections_zone_.DeleteAll();
+  context_.reset(new LLVMContext());
+}
+
+std::string LLVMGranularity::CPUName() {
+  if (strcmp(FLAG_llvm_mcpu, "auto") != 0) return FLAG_llvm_mcpu;
+  return llvm::sys::getHostCPUName();
+}
+
+void LLVMGranularity::SetMachineAttributes(
+    std::vector<std::string>& machine_attributes) {
+  // A cpu given explicitly comes with its own features, so that the code
+  // doesn't depend on the machine it's compiled on.
+  if (strcmp(FLAG_llvm_mcpu, "auto") != 0) return;
+  // The host cpu name alone doesn't tell whether e.g. the OS saves the AVX
+  // registers, or may be unknown to llvm (and so generic). So spell out
+  // the features the assemblers use (--noenable-avx and friends apply),
+  // turning off the ones that are not there. Turning off a feature also
+  // turns off the features implying it (e.g. avx2 with avx).
+  base::CPU cpu;
+  struct {
+    bool supported;
+    const char* name;
+  } features[] = {
+    { CpuFeatures::IsSupported(SSE3), "sse3" },
+    { cpu.has_ssse3(), "ssse3" },
+    { CpuFeatures::IsSupported(SSE4_1), "sse4.1" },
+    { cpu.has_sse42(), "sse4.2" },
+    { CpuFeatures::IsSupported(SAHF), "sahf" },
+    { CpuFeatures::IsSupported(AVX), "avx" },
+    { CpuFeatures::IsSupported(FMA3), "fma" },
+    { CpuFeatures::IsSupported(BMI1), "bmi" },
+    { CpuFeatures::IsSupported(BMI2), "bmi2" },
+    { CpuFeatures::IsSupported(LZCNT), "lzcnt" },
+    { CpuFeatures::IsSupported(POPCNT), "popcnt" },
+  };
+  for (auto feature : features) {
+    machine_attributes.push_back(
+        std::string(feature.supported ? "+" : "-") + feature.name);
+  }
+}
+
+LLVMBackend* LLVMGranularity::AcquireBackend() {
+  {
+    base::LockGuard<base::Mutex> lock_guard(&backends_mutex_);
+    if (!free_backends_.empty()) {
+      LLVMBackend* backend = free_backends_.back().release();
+      free_backends_.pop_back();
+      return backend;
+    }
+  }
+  return new LLVMBackend();
+}
+
+void LLVMGranularity::ReleaseBackend(LLVMBackend* backend) {
+  DCHECK_NOT_NULL(backend);
+  base::LockGuard<base::Mutex> lock_guard(&backends_mutex_);
+  free_backends_.push_back(std::unique_ptr<LLVMBackend>(backend));
+}
+
+LLVMDisassembler::LLVMDisassembler() {
+  auto triple = LLVMGranularity::x64_target_triple;
   std::string err;
   const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple,
                                                                   err);
   DCHECK(target);
-  std::unique_ptr<llvm::MCRegisterInfo> mri(target->createMCRegInfo(triple));
-  DCHECK(mri);
-  std::unique_ptr<llvm::MCAsmInfo> mai(target->createMCAsmInfo(*mri, triple));
-  DCHECK(mai);
-  std::unique_ptr<llvm::MCInstrInfo> mii(target->createMCInstrInfo());
-  DCHECK(mii);
+  mri_.reset(target->createMCRegInfo(triple));
+  DCHECK(mri_);
+  mai_.reset(target->createMCAsmInfo(*mri_, triple));
+  DCHECK(mai_);
+  mii_.reset(target->createMCInstrInfo());
+  DCHECK(mii_);
   std::string feature_str;
   const llvm::StringRef cpu = "";
-  std::unique_ptr<llvm::MCSubtargetInfo> sti(
-      target->createMCSubtargetInfo(triple, cpu, feature_str));
-  DCHECK(sti);
-  llvm::MCContext mc_context(mai.get(), mri.get(), nullptr);
-  std::unique_ptr<llvm::MCDisassembler> disasm(
-      target->createMCDisassembler(*sti, mc_context));
-  DCHECK(disasm);
+  sti_.reset(target->createMCSubtargetInfo(triple, cpu, feature_str));
+  DCHECK(sti_);
+  mc_context_.reset(new llvm::MCContext(mai_.get(), mri_.get(), nullptr));
+  disasm_.reset(target->createMCDisassembler(*sti_, *mc_context_));
+  DCHECK(disasm_);
+  mia_.reset(target->createMCInstrAnalysis(mii_.get()));
+  DCHECK(mia_);
+  auto intel_syntax = 1;
+  inst_printer_.reset(
+      target->createMCInstPrinter(llvm::Triple(llvm::Triple::normalize(triple)),
+                                  intel_syntax, *mai_, *mii_, *mri_));
+  DCHECK(inst_printer_);
+  inst_printer_->setPrintImmHex(true);
+}
 
+int LLVMDisassembler::CallInstructionSizeAt(Address pc) {
   llvm::MCInst inst;
   uint64_t size;
   auto max_instruction_lenght = 15; // True for x64.
 
-  llvm::MCDisassembler::DecodeStatus s = disasm->getInstruction(
+  llvm::MCDisassembler::DecodeStatus s = disasm_->getInstruction(
       inst /* out */, size /* out */,
       llvm::ArrayRef<uint8_t>(pc, pc + max_instruction_lenght),
       0, llvm::nulls(), llvm::nulls());
 
-  std::unique_ptr<const llvm::MCInstrAnalysis> mia(
-      target->createMCInstrAnalysis(mii.get()));
-  DCHECK(mia);
-
-  if (s == llvm::MCDisassembler::Success && mia->isCall(inst))
+  if (s == llvm::MCDisassembler::Success && mia_->isCall(inst))
     return IntHelper::AsInt(size);
   else
     return -1;
 }
 
-std::vector<RelocInfo> LLVMGranularity::Patch(
-    Address start, Address end, LLVMRelocationData::RelocMap& reloc_map) {
-  std::vector<RelocInfo> updated_reloc_infos;
-
-  // TODO(llvm):
-  // This dumb duplication from Disass() looks like it has to be refactored.
-  // But this Patch() technique itself is not a production quality solution
-  // so it should be gone and is not worth refactoring.
-  auto triple = x64_target_triple;
-  std::string err;
-  const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple,
-                                                                  err);
-  DCHECK(target);
-  std::unique_ptr<llvm::MCRegisterInfo> mri(target->createMCRegInfo(triple));
-  DCHECK(mri);
-  std::unique_ptr<llvm::MCAsmInfo> mai(target->createMCAsmInfo(*mri, triple));
-  DCHECK(mai);
-  std::unique_ptr<llvm::MCInstrInfo> mii(target->createMCInstrInfo());
-  DCHECK(mii);
-  std::string feature_str;
-  const llvm::StringRef cpu = "";
-  std::unique_ptr<llvm::MCSubtargetInfo> sti(
-      target->createMCSubtargetInfo(triple, cpu, feature_str));
-  DCHECK(sti);
-  auto intel_syntax = 1;
-  inst_printer_ = std::unique_ptr<llvm::MCInstPrinter>(
-      target->createMCInstPrinter(llvm::Triple(llvm::Triple::normalize(triple)),
-                                  intel_syntax, *mai, *mii, *mri));
-  inst_printer_->setPrintImmHex(true);
-  DCHECK(inst_printer_);
-  llvm::MCContext mc_context(mai.get(), mri.get(), nullptr);
-  std::unique_ptr<llvm::MCDisassembler> disasm(
-      target->createMCDisassembler(*sti, mc_context));
-  DCHECK(disasm);
-
+void LLVMDisassembler::Disass(Address start, Address end) {
   auto pos = start;
   while (pos < end) {
     llvm::MCInst inst;
     uint64_t size;
     auto address = 0;
 
-    llvm::MCDisassembler::DecodeStatus s = disasm->getInstruction(
+    llvm::MCDisassembler::DecodeStatus s = disasm_->getInstruction(
         inst /* out */, size /* out */, llvm::ArrayRef<uint8_t>(pos, end),
         address, llvm::nulls(), llvm::nulls());
-
-    if (s == llvm::MCDisassembler::Fail) break;
-
-    // const llvm::MCInstrDesc& desc = mii_->get(inst.getOpcode());
-    // and testing desc.isMoveImmediate() did't work :(
-
-    if (inst.getNumOperands() == 2 && inst.getOperand(1).isImm()) {
-      auto imm = static_cast<uint64_t>(inst.getOperand(1).getImm());
-      if (!is_uint32(imm) && reloc_map.count(imm)) {
-        DCHECK(size == 10); // size of mov imm64
-        auto pair = reloc_map[imm];
-        RelocInfo rinfo = pair.first;
-        LLVMRelocationData::ExtendedInfo minfo = pair.second;
-        if (rinfo.rmode() == RelocInfo::CELL ||
-            rinfo.rmode() == RelocInfo::EMBEDDED_OBJECT) {
-          intptr_t data = rinfo.data();
-          // Our invariant which is a hack. See RecrodRelocInfo().
-          DCHECK_EQ(static_cast<uint64_t>(data), imm);
-          if (minfo.cell_extended) { // immediate was extended from 32 bit to 64.
-            DCHECK((imm & 0xffffffff) == LLVMChunkBuilder::kExtFillingValue);
-            Memory::uintptr_at(pos + 2) = imm >> 32;
-            data >>= 32;
-          }
-          rinfo.set_pc(pos + 2);
-          rinfo.set_data(data);
-          updated_reloc_infos.push_back(rinfo);
-        } else {
-          UNIMPLEMENTED();
-        }
-      }
+    if (s == llvm::MCDisassembler::Fail) {
+      std::cerr << "disassembler failed at "
+          << reinterpret_cast<void*>(pos) << std::endl;
+      break;
     }
+    llvm::errs() << pos << "\t";
+    inst_printer_->printInst(&inst, llvm::errs(), "", *sti_);
+    llvm::errs() << "\n";
     pos += size;
   }
-  return updated_reloc_infos;
 }
 
 int LLVMChunk::GetParameterStackSlot(int index) const {
@@ -829,14 +1399,197 @@ LLVMChunk* LLVMChunk::NewChunk(HGraph *graph) {
       .Build()
       .NormalizePhis()
       .GiveNamesToPointerValues()
-      .PlaceStatePoints()
-      .RewriteStatePoints()
-      .Optimize()
       .Create();
   if (chunk == NULL) return NULL;
   return chunk;
 }
 
+bool LLVMChunk::SupportsFlags() {
+  // The checks of --debug-code, the deopts of --deopt-every-n-times and the
+  // runtime calls of --no-inline-new are not emitted (yet).
+  return !FLAG_debug_code && FLAG_deopt_every_n_times == 0 && FLAG_inline_new;
+}
+
+// The cases the Do* handlers of otherwise supported instructions don't lower
+// (yet), i.e. end up in UNSUPPORTED(). Only there to save building the IR
+// that would be thrown away: a case missing here still gets to Lithium.
+static bool IsUnsupportedCase(HInstruction* instr, CompilationInfo* info) {
+  switch (instr->opcode()) {
+    case HValue::kAdd: {
+      Representation r = instr->representation();
+      return !r.IsSmiOrInteger32() && !r.IsDouble() && !r.IsExternal();
+    }
+    case HValue::kSub: {
+      Representation r = instr->representation();
+      return !r.IsSmiOrInteger32() && !r.IsDouble() && !r.IsTagged();
+    }
+    case HValue::kDiv:
+    case HValue::kMul:
+      return !instr->representation().IsSmiOrInteger32() &&
+             !instr->representation().IsDouble();
+    case HValue::kMod: {
+      HMod* mod = HMod::cast(instr);
+      if (mod->representation().IsDouble()) return false;
+      if (!mod->representation().IsSmiOrInteger32()) return true;
+      if (mod->RightIsPowerOf2() || !mod->right()->IsConstant()) return false;
+      return HConstant::cast(mod->right())->Integer32Value() == 0;
+    }
+    case HValue::kSar:
+    case HValue::kShl:
+    case HValue::kShr:
+      return !instr->representation().IsSmiOrInteger32();
+    case HValue::kBranch: {
+      HValue* value = HBranch::cast(instr)->value();
+      Representation r = value->representation();
+      if (r.IsSmi()) return true;
+      if (!r.IsTagged()) return false;
+      HType type = value->type();
+      return type.IsSmi() || type.IsJSArray() || type.IsHeapNumber();
+    }
+    case HValue::kCompareMinusZeroAndBranch:
+      return !HCompareMinusZeroAndBranch::cast(instr)
+                  ->value()->representation().IsDouble();
+    case HValue::kChange: {
+      HChange* change = HChange::cast(instr);
+      Representation from = change->from();
+      Representation to = change->to();
+      bool can_overflow = change->CheckFlag(HValue::kCanOverflow) &&
+                          !change->value()->CheckFlag(HValue::kUint32);
+      if (from.IsTagged() && to.IsDouble()) {
+        return change->deoptimize_on_minus_zero();
+      } else if (from.IsDouble()) {
+        return to.IsInteger32() ? !change->CanTruncateToInt32()
+                                : !to.IsTagged();
+      } else if (from.IsInteger32()) {
+        return (to.IsTagged() || to.IsSmi()) && can_overflow;
+      }
+      return false;
+    }
+    case HValue::kDoubleBits:
+      return HDoubleBits::cast(instr)->bits() != HDoubleBits::HIGH;
+    case HValue::kUnaryMathOperation: {
+      HUnaryMathOperation* math = HUnaryMathOperation::cast(instr);
+      if (math->op() == kMathClz32) return true;
+      return math->op() == kMathAbs && math->representation().IsTagged();
+    }
+    case HValue::kPrologue:
+      // The function context isn't allocated (yet).
+      return info->num_heap_slots() > 0;
+    case HValue::kEnterInlined:
+      return HEnterInlined::cast(instr)->arguments_pushed();
+    case HValue::kReturn:
+      return !HReturn::cast(instr)->parameter_count()->IsConstant();
+    case HValue::kInnerAllocatedObject:
+      return !HInnerAllocatedObject::cast(instr)->offset()->IsConstant();
+    case HValue::kAllocate:
+      return HAllocate::cast(instr)->MustPrefillWithFiller();
+    case HValue::kMaybeGrowElements: {
+      HMaybeGrowElements* grow = HMaybeGrowElements::cast(instr);
+      return grow->current_capacity()->IsConstant() ||
+             (grow->object()->IsConstant() &&
+              grow->object()->representation().IsSmi());
+    }
+    case HValue::kLoadContextSlot: {
+      HLoadContextSlot* load = HLoadContextSlot::cast(instr);
+      return load->RequiresHoleCheck() && load->DeoptimizesOnHole();
+    }
+    case HValue::kStoreContextSlot:
+      return HStoreContextSlot::cast(instr)->RequiresHoleCheck();
+    case HValue::kLoadNamedField:
+      return HLoadNamedField::cast(instr)->access().IsExternalMemory();
+    case HValue::kStoreNamedField: {
+      HStoreNamedField* store = HStoreNamedField::cast(instr);
+      return store->access().IsExternalMemory() ||
+             store->field_representation().IsDouble();
+    }
+    case HValue::kLoadKeyed: {
+      HLoadKeyed* load = HLoadKeyed::cast(instr);
+      if (load->is_fixed_typed_array()) {
+        return load->elements_kind() == UINT32_ELEMENTS &&
+               !load->CheckFlag(HInstruction::kUint32);
+      }
+      return load->representation().IsDouble() && load->RequiresHoleCheck();
+    }
+    case HValue::kStoreKeyed: {
+      HStoreKeyed* store = HStoreKeyed::cast(instr);
+      return !store->is_fixed_typed_array() &&
+             store->value()->representation().IsDouble() &&
+             store->NeedsCanonicalization();
+    }
+    case HValue::kStoreKeyedGeneric:
+      return HStoreKeyedGeneric::cast(instr)->HasVectorAndSlot();
+    case HValue::kStringCharCodeAt:
+      return HStringCharCodeAt::cast(instr)->index()->IsConstant();
+    case HValue::kTypeofIsAndBranch: {
+      Handle<String> type_name =
+          HTypeofIsAndBranch::cast(instr)->type_literal();
+      Factory* factory = info->isolate()->factory();
+      if (String::Equals(type_name, factory->number_string()) ||
+          String::Equals(type_name, factory->undefined_string()) ||
+          String::Equals(type_name, factory->function_string()) ||
+          String::Equals(type_name, factory->object_string())) {
+        return false;
+      }
+#define SIMD128_TYPE(TYPE, Type, type, lane_count, lane_type) \
+      if (String::Equals(type_name, factory->type##_string())) return false;
+      SIMD128_TYPES(SIMD128_TYPE)
+#undef SIMD128_TYPE
+      return true;
+    }
+    case HValue::kCallJSFunction:
+      return !HCallJSFunction::cast(instr)->function()->IsConstant();
+    case HValue::kCallNewArray:
+      return HCallNewArray::cast(instr)->argument_count() == 1;
+    case HValue::kCallWithDescriptor: {
+      HCallWithDescriptor* call = HCallWithDescriptor::cast(instr);
+      CallInterfaceDescriptor descriptor = call->descriptor();
+      return LLVMChunkBuilder::GetCallingConv(descriptor) ==
+                 static_cast<llvm::CallingConv::ID>(-1) ||
+             descriptor.GetRegisterParameterCount() !=
+                 call->OperandCount() - 2 ||
+             call->IsTailCall() || !call->target()->IsConstant();
+    }
+    case HValue::kInvokeFunction: {
+      // Only direct calls of known functions (other than the one being
+      // compiled) which need no arguments adaptation.
+      HInvokeFunction* invoke = HInvokeFunction::cast(instr);
+      Handle<JSFunction> known_function = invoke->known_function();
+      return known_function.is_null() ||
+             known_function.is_identical_to(info->closure()) ||
+             invoke->formal_parameter_count() !=
+                 invoke->argument_count() - 1;
+    }
+    default:
+      return false;
+  }
+}
+
+HInstruction* LLVMChunk::FindUnsupportedInstruction(HGraph* graph) {
+  const ZoneList<HBasicBlock*>* blocks = graph->blocks();
+  for (int i = 0; i < blocks->length(); i++) {
+    for (HInstructionIterator it(blocks->at(i)); !it.Done(); it.Advance()) {
+      HInstruction* instr = it.Current();
+      switch (instr->opcode()) {
+#define UNSUPPORTED_CASE(type) case HValue::k##type:
+        LLVM_UNSUPPORTED_INSTRUCTION_LIST(UNSUPPORTED_CASE)
+#undef UNSUPPORTED_CASE
+          // These never reach the Do* handler (see VisitInstruction).
+          if (instr->CanReplaceWithDummyUses()) break;
+          return instr;
+        case HValue::kArgumentsElements:
+          // The arguments of an inlined function are pushed (see
+          // HPushArguments) without a call to consume them.
+          if (HArgumentsElements::cast(instr)->from_inlined()) return instr;
+          break;
+        default:
+          if (IsUnsupportedCase(instr, graph->info())) return instr;
+          break;
+      }
+    }
+  }
+  return nullptr;
+}
+
 int32_t LLVMRelocationData::GetNextUnaccountedPatchpointId() {
   return ++last_patchpoint_id_;
 }
@@ -919,6 +1672,21 @@ int LLVMRelocationData::GetBailoutId(int32_t patchpoint_id) {
   return -1;
 }
 
+void LLVMRelocationData::SetLazyBailoutId(int32_t patchpoint_id,
+                                          int bailout_id) {
+  CHECK(IsPatchpointIdSafepoint(patchpoint_id));
+  lazy_bailout_ids_[patchpoint_id] = bailout_id;
+}
+
+int LLVMRelocationData::GetLazyBailoutId(int32_t patchpoint_id) {
+  CHECK(IsPatchpointIdLazyDeopt(patchpoint_id));
+  return lazy_bailout_ids_[patchpoint_id];
+}
+
+bool LLVMRelocationData::IsPatchpointIdLazyDeopt(int32_t patchpoint_id) {
+  return lazy_bailout_ids_.count(patchpoint_id) > 0;
+}
+
 bool LLVMRelocationData::IsPatchpointIdDeopt(int32_t patchpoint_id) {
   for (int i = 0; i < is_deopt_.length(); ++i) {
      if (is_deopt_[i].patchpoint_id == patchpoint_id)
@@ -940,41 +1708,27 @@ bool LLVMRelocationData::IsPatchpointIdRelocNop(int32_t patchpoint_id) {
 }
 
 
-// TODO(llvm): I haven't yet decided if it's profitable to use llvm statepoint
-// mechanism to place safepoint polls. This function should either be used
-// or removed.
-void LLVMChunkBuilder::CreateSafepointPollFunction() {
-  DCHECK(module_);
-  DCHECK(llvm_ir_builder_);
-  auto new_func = module_->getOrInsertFunction("gc.safepoint_poll",
-                                               __ getVoidTy(), nullptr);
-  safepoint_poll_ = llvm::cast<llvm::Function>(new_func);
-  __ SetInsertPoint(NewBlock("Safepoint poll entry", safepoint_poll_));
-  __ CreateRetVoid();
-}
-
 LLVMChunkBuilder& LLVMChunkBuilder::Build() {
-  llvm::LLVMContext& llvm_context = LLVMGranularity::getInstance().context();
   chunk_ = new(zone()) LLVMChunk(info(), graph());
-  module_ = LLVMGranularity::getInstance().CreateModule();
+  LLVMPhase phase("L_LLVM IR building", chunk());
+  chunk()->set_backend(LLVMGranularity::getInstance().AcquireBackend());
+  llvm::LLVMContext& llvm_context = backend()->context();
+  module_ = backend()->CreateModule();
   module_->setTargetTriple(LLVMGranularity::x64_target_triple);
   llvm_ir_builder_ = llvm::make_unique<llvm::IRBuilder<>>(llvm_context);
   pointers_.clear();
-  Types::Init(llvm_ir_builder_.get());
+  types_ = llvm::make_unique<Types>(llvm_context);
   status_ = BUILDING;
 
-  // TODO(llvm): decide whether to have llvm insert safepoint polls.
-  //  CreateSafepointPollFunction();
-
   // First param is context (v8, js context) which goes to rsi,
   // second param is the callee's JSFunction object (rdi),
   // third param is rbx for detecting osr entry,
   // fourth param is Parameter 0 which is `this`.
   int num_parameters = info()->num_parameters() + 4;
 
-  std::vector<llvm::Type*> params(num_parameters, Types::tagged);
+  std::vector<llvm::Type*> params(num_parameters, types_->tagged);
   llvm::FunctionType* function_type = llvm::FunctionType::get(
-      Types::tagged, params, false);
+      types_->tagged, params, false);
   function_ = llvm::cast<llvm::Function>(
       module_->getOrInsertFunction(module_->getModuleIdentifier(),
                                    function_type));
@@ -1002,10 +1756,11 @@ LLVMChunkBuilder& LLVMChunkBuilder::Build() {
     HBasicBlock* next = NULL;
     if (i < blocks->length() - 1) next = blocks->at(i + 1);
     DoBasicBlock(blocks->at(i), next);
-    DCHECK(!is_aborted());
+    if (is_aborted()) return *this;
   }
 
   ResolvePhis();
+  SinkDeoptBlocks();
 
   DCHECK(module_);
   chunk()->set_llvm_function_id(std::stoi(module_->getModuleIdentifier()));
@@ -1017,10 +1772,30 @@ LLVMChunkBuilder& LLVMChunkBuilder::Build() {
 }
 
 LLVMChunk* LLVMChunkBuilder::Create() {
-  LLVMGranularity::getInstance().AddModule(std::move(module_));
+  if (is_aborted()) {
+    // The module must die before the backend goes back to the pool.
+    pointers_.clear();
+    module_.reset();
+    chunk()->ReleaseBackend();
+    return NULL;
+  }
+  chunk()->set_module(std::move(module_), function_, number_of_pointers_);
   return chunk();
 }
 
+void LLVMChunkBuilder::SinkDeoptBlocks() {
+  // Deopt blocks are created in the middle of the code of the instruction
+  // they guard. Put them (in their original order) after everything else,
+  // so that the hot code stays together even if the block placement
+  // doesn't move them itself.
+  for (int i = 0; i < deopt_blocks_.length(); i++) {
+    llvm::BasicBlock* block = deopt_blocks_[i];
+    llvm::BasicBlock* last = &function_->back();
+    if (block != last) block->moveAfter(last);
+  }
+  deopt_blocks_.Clear();
+}
+
 void LLVMChunkBuilder::ResolvePhis() {
   // Process the blocks in reverse order.
   const ZoneList<HBasicBlock*>* blocks = graph_->blocks();
@@ -1051,24 +1826,6 @@ void LLVMChunkBuilder::ResolvePhis(HBasicBlock* block) {
 }
 
 
-llvm::Type* LLVMChunkBuilder::GetLLVMType(Representation r) {
-  switch (r.kind()) {
-    case Representation::Kind::kInteger32:
-      return Types::i32;
-    case Representation::Kind::kTagged:
-    case Representation::Kind::kExternal: // For now.
-      return Types::tagged;
-    case Representation::Kind::kSmi:
-      return Types::smi;
-    case Representation::Kind::kDouble:
-      return Types::float64;
-    case Representation::Kind::kNone:
-      return nullptr;
-    default:
-      UNIMPLEMENTED();
-      return nullptr;
-  }
-}
 
 void LLVMChunkBuilder::DoDummyUse(HInstruction* instr) {
   Representation r = instr->representation();
@@ -1124,14 +1881,14 @@ llvm::Value* LLVMChunkBuilder::CreateConstant(HConstant* instr,
   } else if (r.IsInteger32()) {
     return __ getInt32(instr->Integer32Value());
   } else if (r.IsDouble()) {
-    return llvm::ConstantFP::get(Types::float64,
+    return llvm::ConstantFP::get(types_->float64,
                                  instr->DoubleValue());
   } else if (r.IsExternal()) {
     // TODO(llvm): tagged type
     // TODO(llvm): RelocInfo::EXTERNAL_REFERENCE
     Address external_address = instr->ExternalReferenceValue().address();
     auto as_i64 = __ getInt64(reinterpret_cast<uint64_t>(external_address));
-    return __ CreateBitOrPointerCast(as_i64, Types::tagged);
+    return __ CreateBitOrPointerCast(as_i64, types_->tagged);
   } else if (r.IsTagged()) {
     AllowHandleAllocation allow_handle_allocation;
     AllowHeapAllocation allow_heap_allocation;
@@ -1167,7 +1924,7 @@ llvm::Value* LLVMChunkBuilder::CreateConstant(HConstant* instr,
 
 llvm::BasicBlock* LLVMChunkBuilder::NewBlock(const std::string& name,
                                              llvm::Function* function) {
-  LLVMContext& llvm_context = LLVMGranularity::getInstance().context();
+  LLVMContext& llvm_context = backend()->context();
   if (!function) function = function_;
   return llvm::BasicBlock::Create(llvm_context, name, function);
 }
@@ -1199,9 +1956,9 @@ llvm::Value* LLVMChunkBuilder::SmiToInteger32(HValue* value) {
   llvm::Value* res = nullptr;
   if (SmiValuesAre32Bits()) {
     // The smi can have tagged representation.
-    auto as_smi = __ CreateBitOrPointerCast(Use(value), Types::smi);
+    auto as_smi = __ CreateBitOrPointerCast(Use(value), types_->smi);
     res = __ CreateLShr(as_smi, kSmiShift);
-    res = __ CreateTrunc(res, Types::i32);
+    res = __ CreateTrunc(res, types_->i32);
   } else {
     DCHECK(SmiValuesAre31Bits());
     UNIMPLEMENTED();
@@ -1211,7 +1968,7 @@ llvm::Value* LLVMChunkBuilder::SmiToInteger32(HValue* value) {
 }
 
 llvm::Value* LLVMChunkBuilder::SmiCheck(llvm::Value* value, bool negate) {
-  llvm::Value* value_as_smi = __ CreateBitOrPointerCast(value, Types::smi);
+  llvm::Value* value_as_smi = __ CreateBitOrPointerCast(value, types_->smi);
   llvm::Value* res = __ CreateAnd(value_as_smi, __ getInt64(1));
   return __ CreateICmp(negate ? llvm::CmpInst::ICMP_NE : llvm::CmpInst::ICMP_EQ,
       res, __ getInt64(0));
@@ -1239,7 +1996,7 @@ void LLVMChunkBuilder::IncrementCounter(StatsCounter* counter, int value) {
   if (!FLAG_native_code_counters || !counter->Enabled()) return;
   Address conter_addr = ExternalReference(counter).address();
   auto llvm_counter_addr = __ getInt64(reinterpret_cast<uint64_t>(conter_addr));
-  auto casted_address = __ CreateIntToPtr(llvm_counter_addr, Types::ptr_i32);
+  auto casted_address = __ CreateIntToPtr(llvm_counter_addr, types_->ptr_i32);
   auto llvm_conunter = __ CreateLoad(casted_address);
   auto llvm_value = __ getInt32(value);
   auto updated_value = __ CreateAdd(llvm_conunter, llvm_value);
@@ -1264,7 +2021,7 @@ llvm::Value* LLVMChunkBuilder::Integer32ToSmi(HValue* value) {
 }
 
 llvm::Value* LLVMChunkBuilder::Integer32ToSmi(llvm::Value* value) {
-  llvm::Value* extended_width_val = __ CreateZExt(value, Types::smi);
+  llvm::Value* extended_width_val = __ CreateZExt(value, types_->smi);
   return __ CreateShl(extended_width_val, kSmiShift);
 }
 
@@ -1365,8 +2122,23 @@ llvm::Value* LLVMChunkBuilder::CallVal(llvm::Value* callable_value,
   llvm::FunctionType* function_type = llvm::FunctionType::get(
       return_type, param_types, is_var_arg);
   llvm::PointerType* ptr_to_function = function_type->getPointerTo();
-  auto casted = __ CreateBitOrPointerCast(callable_value, ptr_to_function);
 
+  // The lazy bailout environment goes into the deopt arguments of the
+  // statepoint, so the statepoint is made explicitly instead of leaving
+  // it to PlaceSafepoints.
+  LLVMEnvironment* lazy_env =
+      record_safepoint ? AssignLazyEnvironment() : nullptr;
+  if (lazy_env) {
+    auto stack_params = number_stack_params(params.size(), calling_conv);
+    int32_t stackmap_id =
+        reloc_data_->GetNextSafepointPatchpointId(stack_params);
+    RegisterLazyBailout(lazy_env, stackmap_id);
+    int nop_size = 0; // Let LLVM emit the call.
+    return CallStatePoint(stackmap_id, callable_value, calling_conv, params,
+                          nop_size, return_type, lazy_env);
+  }
+
+  auto casted = __ CreateBitOrPointerCast(callable_value, ptr_to_function);
   llvm::CallInst* call_inst = __ CreateCall(casted, params);
   call_inst->setCallingConv(calling_conv);
 
@@ -1389,6 +2161,8 @@ llvm::Value* LLVMChunkBuilder::CallCode(Handle<Code> code,
                                         std::vector<llvm::Value*>& params,
                                         bool record_safepoint) {
   auto index = chunk()->masm().GetCodeTargetIndex(code);
+  LLVMEnvironment* lazy_env =
+      record_safepoint ? AssignLazyEnvironment() : nullptr;
   int nop_size;
   int32_t pp_id;
   auto stack_params = number_stack_params(params.size(), calling_conv);
@@ -1408,8 +2182,10 @@ llvm::Value* LLVMChunkBuilder::CallCode(Handle<Code> code,
   // LLVM does not support statepoints upon patchpoints (or any other intrinsics
   // for that matter). Luckily, patchpoint's functionality is a subset of that
   // of the statepoint intrinsic.
-  auto llvm_null = llvm::ConstantPointerNull::get(Types::ptr_i8);
-  auto result = CallStatePoint(pp_id, llvm_null, calling_conv, params, nop_size);
+  if (lazy_env) RegisterLazyBailout(lazy_env, pp_id);
+  auto llvm_null = llvm::ConstantPointerNull::get(types_->ptr_i8);
+  auto result = CallStatePoint(pp_id, llvm_null, calling_conv, params, nop_size,
+                               types_->tagged, lazy_env);
 
   // Map pp_id -> index in code_targets_.
   chunk()->target_index_for_ppid()[pp_id] = index;
@@ -1463,7 +2239,7 @@ llvm::Value* LLVMChunkBuilder::CallRuntime(const Runtime::Function* function) {
 
   auto llvm_nargs = __ getInt64(arg_count);
   auto target_temp = __ getInt64(reinterpret_cast<uint64_t>(rt_target));
-  auto llvm_rt_target = target_temp; //__ CreateIntToPtr(target_temp, Types::ptr_i8);
+  auto llvm_rt_target = target_temp; //__ CreateIntToPtr(target_temp, types_->ptr_i8);
   auto context = GetContext();
   std::vector<llvm::Value*> args(arg_count + 3, nullptr);
   args[0] = llvm_nargs;
@@ -1504,7 +2280,7 @@ llvm::Value* LLVMChunkBuilder::CallRuntimeFromDeferred(Runtime::FunctionId id,
   // bool is_var_arg = false;
   auto llvm_nargs = __ getInt64(arg_count);
   auto target_temp = __ getInt64(reinterpret_cast<uint64_t>(rt_target));
-  auto llvm_rt_target = __ CreateIntToPtr(target_temp, Types::ptr_i8);
+  auto llvm_rt_target = __ CreateIntToPtr(target_temp, types_->ptr_i8);
   std::vector<llvm::Value*> actualParams;
   actualParams.push_back(llvm_nargs);
   actualParams.push_back(llvm_rt_target);
@@ -1521,7 +2297,7 @@ llvm::Value* LLVMChunkBuilder::FieldOperand(llvm::Value* base, int offset) {
   // so...
   auto offset_val = ConstFoldBarrier(__ getInt64(offset - kHeapObjectTag));
   // I don't know why, but it works OK even if base was already an i8*
-  llvm::Value* base_casted = __ CreateIntToPtr(base, Types::ptr_i8);
+  llvm::Value* base_casted = __ CreateIntToPtr(base, types_->ptr_i8);
   return __ CreateGEP(base_casted, offset_val);
 }
 
@@ -1531,15 +2307,124 @@ llvm::Value* LLVMChunkBuilder::LoadFieldOperand(llvm::Value* base, int offset,
                                                 const char* name) {
   llvm::Value* address = FieldOperand(base, offset);
   llvm::Value* casted_address = __ CreatePointerCast(address,
-                                                     Types::ptr_tagged);
-  return __ CreateLoad(casted_address, name);
+                                                     types_->ptr_tagged);
+  llvm::LoadInst* load = __ CreateLoad(casted_address, name);
+  // Other offsets mean different things for different objects, so only
+  // the map word can be typed without knowing what base is.
+  if (offset == HeapObject::kMapOffset) {
+    AnnotateMapLoad(load);
+    SetTbaa(load, kTbaaMap);
+  }
+  return load;
+}
+
+LLVMChunkBuilder::TbaaKind LLVMChunkBuilder::TbaaKindFor(
+    HObjectAccess access) {
+  if (access.IsMap()) return kTbaaMap;
+  if (access.IsArrayLength() || access.IsStringLength()) return kTbaaLength;
+  if (access.IsElementsPointer()) return kTbaaElementsPointer;
+  if (access.IsBackingStore()) return kTbaaBackingStoreField;
+  if (access.IsDoubleField()) return kTbaaHeapNumberValue;
+  DCHECK(access.IsInobject());
+  if (access.offset() == JSObject::kPropertiesOffset) {
+    return kTbaaPropertiesPointer;
+  }
+  return kTbaaInobjectField;
+}
+
+llvm::MDNode* LLVMChunkBuilder::TbaaTag(TbaaKind kind) {
+  // Metadata is uniqued by the context, so the type nodes need no caching.
+  llvm::MDBuilder md_builder(backend()->context());
+  llvm::MDNode* root = md_builder.createTBAARoot("V8 heap");
+  llvm::MDNode* inobject_field =
+      md_builder.createTBAAScalarTypeNode("in-object field", root);
+  llvm::MDNode* type = nullptr;
+  switch (kind) {
+    case kTbaaMap:
+      type = md_builder.createTBAAScalarTypeNode("map", root);
+      break;
+    case kTbaaLength:
+      type = md_builder.createTBAAScalarTypeNode("length", root);
+      break;
+    case kTbaaElementsPointer:
+      type = md_builder.createTBAAScalarTypeNode("elements", root);
+      break;
+    case kTbaaInobjectField:
+      type = inobject_field;
+      break;
+    case kTbaaPropertiesPointer:
+      type = md_builder.createTBAAScalarTypeNode("properties", inobject_field);
+      break;
+    case kTbaaBackingStoreField:
+      type = md_builder.createTBAAScalarTypeNode("backing store field", root);
+      break;
+    case kTbaaHeapNumberValue:
+      type = md_builder.createTBAAScalarTypeNode("heap number value", root);
+      break;
+    case kTbaaFixedArraySlot:
+      type = md_builder.createTBAAScalarTypeNode("fixed array slot", root);
+      break;
+    case kTbaaFixedDoubleArraySlot:
+      type = md_builder.createTBAAScalarTypeNode("double array slot", root);
+      break;
+    case kTbaaTypedArrayData:
+      type = md_builder.createTBAAScalarTypeNode("typed array data", root);
+      break;
+  }
+  return md_builder.createTBAAStructTagNode(type, type, 0);
+}
+
+void LLVMChunkBuilder::SetTbaa(llvm::Value* load_or_store, TbaaKind kind) {
+  DCHECK(llvm::isa<llvm::LoadInst>(load_or_store) ||
+         llvm::isa<llvm::StoreInst>(load_or_store));
+  llvm::cast<llvm::Instruction>(load_or_store)->setMetadata(
+      llvm::LLVMContext::MD_tbaa, TbaaTag(kind));
+}
+
+void LLVMChunkBuilder::AnnotateLoad(llvm::LoadInst* load, HValue* instr) {
+  llvm::LLVMContext& llvm_context = backend()->context();
+  llvm::MDBuilder md_builder(llvm_context);
+  if (instr->representation().IsInteger32()) {
+    // The ranges are not valid anymore after range analysis (see
+    // HRangeAnalysisPhase::PoisonRanges), so only trust the field itself.
+    if (!instr->IsLoadNamedField() ||
+        !HLoadNamedField::cast(instr)->access().IsStringLength()) {
+      return;
+    }
+    // !range is a half-open interval [lower, upper + 1).
+    llvm::APInt lower(32, 0, true);
+    llvm::APInt upper(32, String::kMaxLength + 1, true);
+    load->setMetadata(llvm::LLVMContext::MD_range,
+                      md_builder.createRange(lower, upper));
+  } else if (instr->representation().IsTagged() &&
+             instr->type().IsHeapObject()) {
+    // Smi zero is the null pointer, so only heap objects are nonnull.
+    load->setMetadata(llvm::LLVMContext::MD_nonnull,
+                      llvm::MDNode::get(llvm_context, {}));
+  }
+}
+
+void LLVMChunkBuilder::AnnotateMapLoad(llvm::LoadInst* load) {
+  llvm::LLVMContext& llvm_context = backend()->context();
+  llvm::MDBuilder md_builder(llvm_context);
+  load->setMetadata(llvm::LLVMContext::MD_nonnull,
+                    llvm::MDNode::get(llvm_context, {}));
+  // The tagged pointer points kHeapObjectTag bytes into the map.
+  auto size = md_builder.createConstant(
+      __ getInt64(Map::kSize - kHeapObjectTag));
+  load->setMetadata(llvm::LLVMContext::MD_dereferenceable,
+                    llvm::MDNode::get(llvm_context, { size }));
+  // TODO(llvm): The map of a constant with a stable map could be
+  // !invariant.load (backed by a stability dependency). But the map may
+  // still change during a call, and the code is only thrown away lazily
+  // once it returns, so the load must not be hoisted across calls.
 }
 
 llvm::Value* LLVMChunkBuilder::ConstructAddress(llvm::Value* base, int64_t offset) {
   // The problem is (volatile_0 + imm) + offset == volatile_0 + (imm + offset),
   // so...
   llvm::Value* offset_val = ConstFoldBarrier(__ getInt64(offset));
-  llvm::Value* base_casted = __ CreateBitOrPointerCast(base, Types::ptr_i8);
+  llvm::Value* base_casted = __ CreateBitOrPointerCast(base, types_->ptr_i8);
   auto constructed_address = __ CreateGEP(base_casted, offset_val);
   return __ CreateBitOrPointerCast(constructed_address, base->getType());
 }
@@ -1555,7 +2440,7 @@ llvm::Value* LLVMChunkBuilder::MoveHeapObject(Handle<Object> object) {
     // TODO(llvm): use/write a function for that
     Smi* smi = Smi::cast(*object);
     llvm::Value* value = ValueFromSmi(smi);
-    return __ CreateBitOrPointerCast(value, Types::tagged);
+    return __ CreateBitOrPointerCast(value, types_->tagged);
   } else { // Heap object
     // MacroAssembler::MoveHeapObject
     AllowHeapAllocation allow_allocation;
@@ -1568,10 +2453,10 @@ llvm::Value* LLVMChunkBuilder::MoveHeapObject(Handle<Object> object) {
       auto last_instr = current_block-> getTerminator();
       // if block has terminator we must insert before it
       if (!last_instr) {
-        llvm::Value* ptr = __ CreateBitOrPointerCast(value, Types::ptr_tagged);
+        llvm::Value* ptr = __ CreateBitOrPointerCast(value, types_->ptr_tagged);
         return  __ CreateLoad(ptr);
       }
-      llvm::Value* ptr = new llvm::BitCastInst(value, Types::ptr_tagged, "", last_instr);
+      llvm::Value* ptr = new llvm::BitCastInst(value, types_->ptr_tagged, "", last_instr);
       return new llvm::LoadInst(ptr, "", last_instr);
     } else {
       return Move(object, RelocInfo::EMBEDDED_OBJECT);
@@ -1593,8 +2478,8 @@ llvm::Value* LLVMChunkBuilder::Move(Handle<Object> object,
 }
 
 llvm::Value* LLVMChunkBuilder::Compare(llvm::Value* lhs, llvm::Value* rhs) {
-  llvm::Value* casted_lhs = __ CreateBitOrPointerCast(lhs, Types::ptr_i8);
-  llvm::Value* casted_rhs = __ CreateBitOrPointerCast(rhs, Types::ptr_i8);
+  llvm::Value* casted_lhs = __ CreateBitOrPointerCast(lhs, types_->ptr_i8);
+  llvm::Value* casted_rhs = __ CreateBitOrPointerCast(rhs, types_->ptr_i8);
   return __ CreateICmpEQ(casted_lhs, casted_rhs);
 }
 
@@ -1605,7 +2490,7 @@ llvm::Value* LLVMChunkBuilder::Compare(llvm::Value* lhs, Handle<Object> rhs) {
     //    Cmp(dst, Smi::cast(*rhs));
     return nullptr;
   } else {
-    auto type = Types::tagged;
+    auto type = types_->tagged;
     auto llvm_rhs = __ CreateBitOrPointerCast(MoveHeapObject(rhs), type);
     auto casted_lhs = __ CreateBitOrPointerCast(lhs, type);
     return __ CreateICmpEQ(casted_lhs, llvm_rhs);
@@ -1620,13 +2505,13 @@ llvm::Value* LLVMChunkBuilder::CompareMap(llvm::Value* object,
 llvm::Value* LLVMChunkBuilder::CheckPageFlag(llvm::Value* object, int mask) {
   auto page_align_mask = __ getInt64(~Page::kPageAlignmentMask);
   // TODO(llvm): do the types match?
-  auto object_as_i64 = __ CreateBitOrPointerCast(object, Types::i64);
+  auto object_as_i64 = __ CreateBitOrPointerCast(object, types_->i64);
   auto masked_object = __ CreateAnd(object_as_i64, page_align_mask,
                                     "CheckPageFlag1");
   auto flags_address = ConstructAddress(masked_object,
                                         MemoryChunk::kFlagsOffset);
   auto i32_ptr_flags_address = __ CreateBitOrPointerCast(flags_address,
-                                                         Types::ptr_i32);
+                                                         types_->ptr_i32);
   auto flags = __ CreateLoad(i32_ptr_flags_address);
   auto llvm_mask = __ getInt32(mask);
   auto and_result = __ CreateAnd(flags, llvm_mask);
@@ -1652,7 +2537,7 @@ void LLVMChunkBuilder::UpdateAllocationTopHelper(llvm::Value* result_end,
   // Update new top.
   llvm::Value* top_address = __ getInt64(reinterpret_cast<uint64_t>
                                              (allocation_top.address()));
-  llvm::Value* address = __ CreateIntToPtr(top_address, Types::ptr_i64);
+  llvm::Value* address = __ CreateIntToPtr(top_address, types_->ptr_i64);
   __ CreateStore(result_end, address);
 }
 
@@ -1666,7 +2551,7 @@ llvm::Value* LLVMChunkBuilder::LoadAllocationTopHelper(AllocationFlags flags) {
   // Safe code.
   llvm::Value* top_address = __ getInt64(reinterpret_cast<uint64_t>
                                              (allocation_top.address()));
-  llvm::Value* address = __ CreateIntToPtr(top_address, Types::ptr_i64);
+  llvm::Value* address = __ CreateIntToPtr(top_address, types_->ptr_i64);
   llvm::Value* result = __ CreateLoad(address);
   return result;
 }
@@ -1683,7 +2568,7 @@ llvm::Value* LLVMChunkBuilder::AllocateHeapNumber(MutableMode mode){
   llvm::Value* root = LoadRoot(map_index);
   llvm::Value* address = FieldOperand(result, HeapObject::kMapOffset);
   llvm::Value* casted_address = __ CreatePointerCast(address,
-                                                     Types::ptr_tagged);
+                                                     types_->ptr_tagged);
   __ CreateStore(root, casted_address);
   return result;
 }
@@ -1693,8 +2578,24 @@ llvm::Value* LLVMChunkBuilder::GetContext() {
   return function_->arg_begin();
 }
 
+llvm::Value* LLVMChunkBuilder::GetOsrBuffer() {
+  // Third parameter (rbx) is only meaningful on OSR entry.
+  DCHECK(graph()->has_osr());
+  llvm::Function::arg_iterator it = function_->arg_begin();
+  ++it;
+  ++it;
+  return it;
+}
+
+llvm::Value* LLVMChunkBuilder::GetFramePointer() {
+  // The functions are built with "no-frame-pointer-elim".
+  llvm::Function* frame_address = llvm::Intrinsic::getDeclaration(
+      module_.get(), llvm::Intrinsic::frameaddress);
+  return __ CreateCall(frame_address, __ getInt32(0));
+}
+
 llvm::Value* LLVMChunkBuilder::GetNan() {
-  auto zero = llvm::ConstantFP::get(Types::float64, 0);
+  auto zero = llvm::ConstantFP::get(types_->float64, 0);
   return __ CreateFDiv(zero, zero);
 }
 
@@ -1706,6 +2607,88 @@ LLVMEnvironment* LLVMChunkBuilder::AssignEnvironment() {
       hydrogen_env, &argument_index_accumulator, &objects_to_materialize);
 }
 
+LLVMEnvironment* LLVMChunkBuilder::AssignLazyEnvironment() {
+  HInstruction* instr = current_instruction_;
+  if (info()->IsStub() || instr == nullptr) return nullptr;
+  bool resumes_after = false;
+  switch (instr->opcode()) {
+#define LAZY_BAILOUT_CASE(type) case HValue::k##type:
+    LLVM_LAZY_BAILOUT_INSTRUCTION_LIST(LAZY_BAILOUT_CASE)
+#undef LAZY_BAILOUT_CASE
+      resumes_after = instr->HasObservableSideEffects() &&
+                      !lazy_bailout_redoes_instruction_;
+      break;
+    default:
+      break;
+  }
+
+  // The outgoing arguments are gone once the call returns.
+  int saved_argument_count = argument_count_;
+  argument_count_ += instr->argument_delta();
+  int argument_index_accumulator = 0;
+  ZoneList<HValue*> objects_to_materialize(0, zone());
+  if (!resumes_after) {
+    // Like Lithium does for calls without observable side effects (and for
+    // its deferred calls, e.g. the stack guard): the unoptimized code redoes
+    // the whole instruction.
+    LLVMEnvironment* environment = CreateEnvironment(
+        current_block_->last_environment(), &argument_index_accumulator,
+        &objects_to_materialize);
+    argument_count_ = saved_argument_count;
+    return environment;
+  }
+
+  DCHECK(instr->next()->IsSimulate());
+  HSimulate* simulate = HSimulate::cast(instr->next());
+
+  // Same as simulate->ReplayEnvironment(), but on a copy: the rest of the
+  // instruction still deopts eagerly to the state before it.
+  HEnvironment* hydrogen_env = current_block_->last_environment()->Copy();
+  hydrogen_env->set_ast_id(simulate->ast_id());
+  hydrogen_env->Drop(simulate->pop_count());
+  for (int i = simulate->values()->length() - 1; i >= 0; --i) {
+    HValue* value = simulate->values()->at(i);
+    if (simulate->HasAssignedIndexAt(i)) {
+      hydrogen_env->Bind(simulate->GetAssignedIndexAt(i), value);
+    } else {
+      hydrogen_env->Push(value);
+    }
+  }
+
+  call_result_ = instr;
+  LLVMEnvironment* environment = CreateEnvironment(
+      hydrogen_env, &argument_index_accumulator, &objects_to_materialize);
+  call_result_ = nullptr;
+  argument_count_ = saved_argument_count;
+  return environment;
+}
+
+void LLVMChunkBuilder::RegisterLazyBailout(LLVMEnvironment* lazy_env,
+                                           int32_t stackmap_id) {
+  deopt_data_->Add(lazy_env, stackmap_id);
+  int bailout_id = deopt_data_->DeoptCount() - 1;
+  reloc_data_->SetLazyBailoutId(stackmap_id, bailout_id);
+}
+
+void LLVMChunkBuilder::EmitLazyDeoptPadding() {
+  // Deoptimizer::PatchCodeForDeoptimization() overwrites kCallSequenceLength
+  // bytes at the return address with a call to the deoptimization entry.
+  // That must neither run into the next such place nor past the code end.
+  // Two multi-byte nops (6 + 7 bytes), sideeffect so they stay put.
+  STATIC_ASSERT(Assembler::kCallSequenceLength == 13);
+  llvm::FunctionType* padding_type = llvm::FunctionType::get(
+      __ getVoidTy(), false);
+  std::string asm_string =
+      ".byte 0x66, 0x0f, 0x1f, 0x44, 0x00, 0x00\n"
+      ".byte 0x0f, 0x1f, 0x80, 0x00, 0x00, 0x00, 0x00";
+  bool has_side_effects = true;
+  llvm::InlineAsm* padding = llvm::InlineAsm::get(padding_type,
+                                                  asm_string,
+                                                  "",
+                                                  has_side_effects);
+  __ CreateCall(padding);
+}
+
 void LLVMChunkBuilder::GetAllEnvironmentValues(
     LLVMEnvironment* environment, std::vector<llvm::Value*>& mapped_values) {
   if (!environment) return;
@@ -1719,11 +2702,6 @@ void LLVMChunkBuilder::DeoptimizeIf(llvm::Value* compare,
                                     bool negate,
                                     llvm::BasicBlock* next_block) {
   LLVMEnvironment* environment = AssignEnvironment();
-  auto patchpoint_id = reloc_data_->GetNextDeoptRelocPatchpointId();
-  deopt_data_->Add(environment, patchpoint_id);
-  int bailout_id = deopt_data_->DeoptCount() - 1;
-  reloc_data_->SetBailoutId(patchpoint_id, bailout_id);
-  reloc_data_->SetDeoptReason(patchpoint_id, deopt_reason);
 
   if (!next_block) next_block = NewBlock("BlockCont");
   llvm::BasicBlock* saved_insert_point = __ GetInsertBlock();
@@ -1741,10 +2719,55 @@ void LLVMChunkBuilder::DeoptimizeIf(llvm::Value* compare,
     return;
   }
 
-  Deoptimizer::BailoutType bailout_type = info()->IsStub()
-      ? Deoptimizer::LAZY
-      : Deoptimizer::EAGER;
-  DCHECK_EQ(bailout_type, Deoptimizer::EAGER); // We don't support lazy yet.
+  llvm::BasicBlock* deopt_block = FindDeoptExit(environment, deopt_reason);
+  if (!deopt_block) {
+    deopt_block = EmitDeoptExit(environment, deopt_reason);
+    if (!deopt_block) return;  // Aborted.
+    __ SetInsertPoint(saved_insert_point);
+  }
+
+  // Tell the block placement and the register allocator
+  // the deopt path is (almost) never taken.
+  llvm::MDBuilder md_builder(backend()->context());
+  if (!negate) {
+    auto weights = md_builder.createBranchWeights(kUnlikelyBranchWeight,
+                                                  kLikelyBranchWeight);
+    __ CreateCondBr(compare, deopt_block, next_block, weights);
+  } else {
+    auto weights = md_builder.createBranchWeights(kLikelyBranchWeight,
+                                                  kUnlikelyBranchWeight);
+    __ CreateCondBr(compare, next_block, deopt_block, weights);
+  }
+  __ SetInsertPoint(next_block);
+}
+
+llvm::BasicBlock* LLVMChunkBuilder::FindDeoptExit(
+    LLVMEnvironment* environment, Deoptimizer::DeoptReason deopt_reason) {
+  // Only the exits of the current block are candidates. Everything they
+  // use is either defined at the start of the block (tagged constants),
+  // is an llvm::Constant or dominates both of the deopt sites (for it's in
+  // both environments). Values emitted at their uses never compare equal.
+  for (int i = 0; i < deopt_exits_.length(); i++) {
+    const DeoptExit& exit = deopt_exits_[i];
+    // Keep the reason right for those who are going to see it.
+    if (FLAG_trace_deopt && exit.reason != deopt_reason) continue;
+    if (exit.environment->IsEquivalentTo(environment)) return exit.block;
+  }
+  return nullptr;
+}
+
+llvm::BasicBlock* LLVMChunkBuilder::EmitDeoptExit(
+    LLVMEnvironment* environment, Deoptimizer::DeoptReason deopt_reason) {
+  auto patchpoint_id = reloc_data_->GetNextDeoptRelocPatchpointId();
+  deopt_data_->Add(environment, patchpoint_id);
+  int bailout_id = deopt_data_->DeoptCount() - 1;
+  reloc_data_->SetBailoutId(patchpoint_id, bailout_id);
+  reloc_data_->SetDeoptReason(patchpoint_id, deopt_reason);
+
+  // Lazy bailouts are attached to calls (see AssignLazyEnvironment),
+  // what's left here are the eager ones. Stubs aren't llvmed.
+  DCHECK(!info()->IsStub());
+  Deoptimizer::BailoutType bailout_type = Deoptimizer::EAGER;
 
   Address entry;
   {
@@ -1755,7 +2778,7 @@ void LLVMChunkBuilder::DeoptimizeIf(llvm::Value* compare,
   }
   if (entry == NULL) {
     Abort(kBailoutWasNotPrepared);
-    return;
+    return nullptr;
   }
 
   // TODO(llvm): create Deoptimizer::DeoptInfo & Deoptimizer::JumpTableEntry (?)
@@ -1773,16 +2796,21 @@ void LLVMChunkBuilder::DeoptimizeIf(llvm::Value* compare,
 
   std::vector<llvm::Value*> empty;
   int nop_size = 5; // Call relative i32 takes 5 bytes: `e8` + i32
-  auto llvm_null = llvm::ConstantPointerNull::get(Types::ptr_i8);
-  CallPatchPoint(patchpoint_id, llvm_null, empty, mapped_values, nop_size);
+  auto llvm_null = llvm::ConstantPointerNull::get(types_->ptr_i8);
+  llvm::CallInst* deopt_call = CallPatchPoint(patchpoint_id, llvm_null, empty,
+                                              mapped_values, nop_size);
+  // Never coming back, and hopefully never getting here in the first place.
+  deopt_call->addAttribute(llvm::AttributeSet::FunctionIndex,
+                           llvm::Attribute::Cold);
+  // The patchpoint id must stay unique, see CallStatePoint().
+  deopt_call->setCannotDuplicate();
   __ CreateUnreachable();
+  // Moved out of the way of the fast path once all the code is there.
+  deopt_blocks_.Add(deopt_block, zone());
 
-  __ SetInsertPoint(saved_insert_point);
-  if (!negate)
-    __ CreateCondBr(compare, deopt_block, next_block);
-  else
-    __ CreateCondBr(compare, next_block, deopt_block);
-  __ SetInsertPoint(next_block);
+  DeoptExit exit = { environment, deopt_reason, deopt_block };
+  deopt_exits_.Add(exit, zone());
+  return deopt_block;
 }
 
 llvm::CmpInst::Predicate LLVMChunkBuilder::TokenToPredicate(Token::Value op,
@@ -1886,6 +2914,8 @@ bool PassInfoPrinter::only_after = false;
 // Warning: same method may not work for all transformation passes,
 // because names might not be preserved.
 LLVMChunkBuilder& LLVMChunkBuilder::GiveNamesToPointerValues() {
+  if (is_aborted()) return *this;
+  LLVMPhase phase("L_LLVM pointer naming", chunk());
   PassInfoPrinter printer("GiveNamesToPointerValues", module_.get());
   DCHECK_EQ(number_of_pointers_, -1);
   number_of_pointers_ = 0;
@@ -1897,12 +2927,12 @@ LLVMChunkBuilder& LLVMChunkBuilder::GiveNamesToPointerValues() {
   return *this;
 }
 
-void LLVMChunkBuilder::DumpPointerValues() {
+void LLVMChunk::DumpPointerValues() {
   DCHECK_GE(number_of_pointers_, 0);
 #ifdef DEBUG
   std::cerr << "< POINTERS:" << "\n";
   for (auto i = 0 ; i < number_of_pointers_; i++) {
-    std::string name = kPointersPrefix + std::to_string(i);
+    std::string name = LLVMChunkBuilder::kPointersPrefix + std::to_string(i);
     auto value = function_->getValueSymbolTable().lookup(name);
     if (value)
       llvm::errs() << value->getName() << " | " << *value << "\n";
@@ -1912,6 +2942,8 @@ void LLVMChunkBuilder::DumpPointerValues() {
 }
 
 LLVMChunkBuilder& LLVMChunkBuilder::NormalizePhis() {
+  if (is_aborted()) return *this;
+  LLVMPhase phase("L_LLVM phi normalization", chunk());
   PassInfoPrinter printer("normalization", module_.get());
   llvm::legacy::FunctionPassManager pass_manager(module_.get());
   if (FLAG_phi_normalize) pass_manager.add(createNormalizePhisPass());
@@ -1920,7 +2952,8 @@ LLVMChunkBuilder& LLVMChunkBuilder::NormalizePhis() {
   return *this;
 }
 
-LLVMChunkBuilder& LLVMChunkBuilder::PlaceStatePoints() {
+void LLVMChunk::PlaceStatePoints() {
+  LLVMPhase phase("L_LLVM statepoint placement", this);
   PassInfoPrinter printer("PlaceStatePoints", module_.get());
   DumpPointerValues();
   llvm::legacy::FunctionPassManager pass_manager(module_.get());
@@ -1928,16 +2961,16 @@ LLVMChunkBuilder& LLVMChunkBuilder::PlaceStatePoints() {
   pass_manager.doInitialization();
   pass_manager.run(*function_);
   pass_manager.doFinalization();
-  return *this;
 }
 
-LLVMChunkBuilder& LLVMChunkBuilder::RewriteStatePoints() {
+void LLVMChunk::RewriteStatePoints() {
+  LLVMPhase phase("L_LLVM statepoint rewriting", this);
   PassInfoPrinter printer("RewriteStatepointsForGC", module_.get());
   DumpPointerValues();
 
   std::set<llvm::Value*> pointer_values;
   for (auto i = 0 ; i < number_of_pointers_; i++) {
-    std::string name = kPointersPrefix + std::to_string(i);
+    std::string name = LLVMChunkBuilder::kPointersPrefix + std::to_string(i);
     auto value = function_->getValueSymbolTable().lookup(name);
     if (value)
       pointer_values.insert(value);
@@ -1947,25 +2980,66 @@ LLVMChunkBuilder& LLVMChunkBuilder::RewriteStatePoints() {
   pass_manager.add(v8::internal::createRewriteStatepointsForGCPass(
       pointer_values));
   pass_manager.run(*module_.get());
-  return *this;
 }
 
 
-LLVMChunkBuilder& LLVMChunkBuilder::Optimize() {
+void LLVMChunk::MergeEmbeddedObjects() {
+  LLVMPhase phase("L_LLVM embedded object merging", this);
+  // See RecordRelocInfo(). With no statepoints yet, an object merged or
+  // hoisted here is just a (named) pointer value, which RewriteStatePoints()
+  // relocates wherever it is live across a call.
+  llvm::legacy::FunctionPassManager pass_manager(module_.get());
+  pass_manager.add(llvm::createEarlyCSEPass());
+  pass_manager.add(llvm::createLICMPass());
+  pass_manager.doInitialization();
+  pass_manager.run(*function_);
+  pass_manager.doFinalization();
+}
+
+static bool IsEmbeddedObject(llvm::Instruction* instr) {
+  auto call = llvm::dyn_cast<llvm::CallInst>(instr);
+  if (!call) return false;
+  auto inline_asm = llvm::dyn_cast<llvm::InlineAsm>(call->getCalledValue());
+  return inline_asm && inline_asm->getAsmString().find(
+      LLVMRelocationData::kRelocRecordsSectionName) != std::string::npos;
+}
+
+void LLVMChunk::PinEmbeddedObjects() {
+  // From now on a call to the asm after a statepoint must stay a separate
+  // call: the GC updates the immediate of each one (it's in the reloc info),
+  // but not a value merged with (or hoisted above) the statepoint, for that
+  // would have no gc.relocate. So the calls get their side effects back.
+  llvm::LLVMContext& llvm_context = backend_->context();
+  for (llvm::BasicBlock& block : *function_) {
+    for (llvm::Instruction& instr : block) {
+      if (!IsEmbeddedObject(&instr)) continue;
+      auto call = llvm::cast<llvm::CallInst>(&instr);
+      auto pure_asm = llvm::cast<llvm::InlineAsm>(call->getCalledValue());
+      bool has_side_effects = true;
+      call->setCalledFunction(llvm::InlineAsm::get(
+          pure_asm->getFunctionType(), pure_asm->getAsmString(),
+          pure_asm->getConstraintString(), has_side_effects));
+      call->setAttributes(call->getAttributes().removeAttribute(
+          llvm_context, llvm::AttributeSet::FunctionIndex,
+          llvm::Attribute::ReadNone));
+    }
+  }
+}
+
+void LLVMChunk::Optimize() {
+  LLVMPhase phase("L_LLVM optimization", this);
   DCHECK(module_);
 #ifdef DEBUG
   llvm::verifyFunction(*function_, &llvm::errs());
 #endif
   PassInfoPrinter printer("optimization", module_.get());
 
-  LLVMGranularity::getInstance().OptimizeFunciton(module_.get(), function_);
-  LLVMGranularity::getInstance().OptimizeModule(module_.get());
-  return *this;
+  backend_->Optimize(module_.get());
 }
 
 // FIXME(llvm): obsolete.
 void LLVMChunkBuilder::CreateVolatileZero() {
-  volatile_zero_address_ = __ CreateAlloca(Types::i64);
+  volatile_zero_address_ = __ CreateAlloca(types_->i64);
   bool is_volatile = true;
   __ CreateStore(__ getInt64(0), volatile_zero_address_, is_volatile);
 }
@@ -1989,7 +3063,7 @@ void LLVMChunkBuilder::PatchReceiverToGlobalProxy() {
     __ CreateCondBr(is_undefined, patch_receiver, receiver_ok);
     __ SetInsertPoint(patch_receiver);
     auto context_as_ptr_to_tagged = __ CreateBitOrPointerCast(GetContext(),
-                                                              Types::ptr_tagged);
+                                                              types_->ptr_tagged);
     auto global_object_operand_address = ConstructAddress(
         context_as_ptr_to_tagged,
         Context::SlotOffset(Context::GLOBAL_OBJECT_INDEX));
@@ -1998,7 +3072,7 @@ void LLVMChunkBuilder::PatchReceiverToGlobalProxy() {
                                             GlobalObject::kGlobalProxyOffset);
     __ CreateBr(receiver_ok);
     __ SetInsertPoint(receiver_ok);
-    auto phi = __ CreatePHI(Types::tagged, 2);
+    auto phi = __ CreatePHI(types_->tagged, 2);
     phi->addIncoming(receiver, receiver_ok);
     phi->addIncoming(global_receiver, patch_receiver);
     global_receiver_ = phi;
@@ -2014,38 +3088,31 @@ void LLVMChunkBuilder::DoBasicBlock(HBasicBlock* block,
   __ SetInsertPoint(Use(block));
   current_block_ = block;
   next_block_ = next_block;
+  deopt_exits_.Clear();
   if (block->IsStartBlock()) {
     PatchReceiverToGlobalProxy();
     // Ensure every function has an associated Stack Map section.
     std::vector<llvm::Value*> empty;
     CallStackMap(reloc_data_->GetNextUnaccountedPatchpointId(), empty);
 
-    //If function contains OSR entry, it's first instruction must be osr_branch
-    if (graph_->has_osr()) { 
-      osr_preserved_values_.Clear();
-      // We need to move llvm spill index by UnoptimizedFrameSlots count
-      // in order to preserve Full-Codegen local values
-      for (int i = 0; i < graph_->osr()->UnoptimizedFrameSlots(); ++i) {
-         auto alloc = __ CreateAlloca(Types::tagged);
-         osr_preserved_values_.Add(alloc, info()->zone());
-      }
+    // OSR code is entered through the thunk LLVMChunk::EmitOsrEntry() puts
+    // after the code, which passes the unoptimized frame's slots in a buffer
+    // pointed to by rbx (see DoUnknownOSRValue). It is never called the
+    // regular way (see Runtime_CompileForOnStackReplacement), the other
+    // path is only there to keep the graph as it is.
+    if (graph_->has_osr()) {
       HBasicBlock* osr_block = graph_->osr()->osr_entry();
       llvm::BasicBlock* not_osr_target = NewBlock("NO_OSR_CONTINUE");
       llvm::BasicBlock* osr_target = Use(osr_block);
-      llvm::Value* zero = __ getInt64(0);
-      llvm::Value* zero_as_tagged = __ CreateBitOrPointerCast(zero,
-                                                              Types::tagged);
-      llvm::Function::arg_iterator it = function_->arg_begin();
-      int i = 0;
-      while (++i < 3) ++it;
-      llvm::Value* osr_value  = it;
-      // Branch to OSR block
-      llvm::Value* compare = __ CreateICmpEQ(osr_value, zero_as_tagged);
-      __ CreateCondBr(compare, not_osr_target, osr_target);
+      llvm::Value* is_osr = __ CreateICmpNE(
+          GetOsrBuffer(), llvm::Constant::getNullValue(types_->tagged));
+      __ CreateCondBr(is_osr, osr_target, not_osr_target);
       __ SetInsertPoint(not_osr_target);
     }
     // CreateVolatileZero();
-    block->UpdateEnvironment(graph_->start_environment());
+    // A copy, since the simulates are replayed into it and Lithium may have
+    // to do the same if the lowering gives up (see UNSUPPORTED).
+    block->UpdateEnvironment(graph_->start_environment()->Copy());
     argument_count_ = 0;
   } else if (block->predecessors()->length() == 1) {
     // We have a single predecessor => copy environment and outgoing
@@ -2144,6 +3211,12 @@ LLVMEnvironment* LLVMChunkBuilder::CreateEnvironment(
     if (value->IsArgumentsObject() || value->IsCapturedObject()) {
       op = LLVMEnvironment::materialization_marker();
       UNIMPLEMENTED();
+    } else if (value == call_result_) {
+      // Doesn't exist before the call, so it can't be a deopt argument.
+      // Keep the place in the stack map record with a dummy constant.
+      DCHECK(value->representation().IsTagged());
+      result->MarkCallResultAt(result->values()->length());
+      op = __ getInt64(0);
     } else {
       if (value->IsConstant()) {
         HConstant* instr = HConstant::cast(value);
@@ -2157,6 +3230,11 @@ LLVMEnvironment* LLVMChunkBuilder::CreateEnvironment(
     result->AddValue(op,
                      value->representation(),
                      value->CheckFlag(HInstruction::kUint32));
+    // Named as a pointer value (see GiveNamesToPointerValues), so
+    // RewriteStatePoints() relocates it.
+    if (value != call_result_ && pointers_.count(op)) {
+      result->MarkGcPointerAt(result->values()->length() - 1);
+    }
   }
 
   // Recursively store the nested objects into the environment
@@ -2191,7 +3269,7 @@ void LLVMChunkBuilder::DoBlockEntry(HBlockEntry* instr) {
 void LLVMChunkBuilder::DoContext(HContext* instr) {
   if (instr->HasNoUses()) return;
   if (info()->IsStub()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   instr->set_llvm_value(GetContext());
 }
@@ -2230,7 +3308,7 @@ void LLVMChunkBuilder::DoArgumentsObject(HArgumentsObject* instr) {
 }
 
 void LLVMChunkBuilder::DoGoto(HGoto* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoSimulate(HSimulate* instr) {
@@ -2242,21 +3320,66 @@ void LLVMChunkBuilder::DoSimulate(HSimulate* instr) {
   instr->ReplayEnvironment(current_block_->last_environment());
 }
 
+// Innermost loops iterating an induction variable up (or down) to a limit
+// (the facts come from HBoundsCheckHoistingPhase). They run at most 2^32
+// iterations, so leaving out their interrupt check only delays interrupts.
+static bool IsCountedInnermostLoop(HLoopInformation* loop) {
+  if (!loop) return false;
+  for (int i = 0; i < loop->blocks()->length(); i++) {
+    HBasicBlock* block = loop->blocks()->at(i);
+    if (block != loop->loop_header() && block->IsLoopHeader()) return false;
+  }
+  const ZoneList<HPhi*>* phis = loop->loop_header()->phis();
+  for (int i = 0; i < phis->length(); i++) {
+    if (phis->at(i)->IsLimitedInductionVariable()) return true;
+  }
+  return false;
+}
+
 void LLVMChunkBuilder::DoStackCheck(HStackCheck* instr) {
-#ifdef DEBUG
-  std::cerr << __FUNCTION__ << std::endl;
-#endif
-//  LLVMContext& llvm_context = LLVMGranularity::getInstance().context();
-//  llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
-//      llvm::Intrinsic::read_register, { Types::i64 });
-//  auto metadata =
-//    llvm::MDNode::get(llvm_context, llvm::MDString::get(llvm_context, "rsp"));
-//  llvm::MetadataAsValue* val = llvm::MetadataAsValue::get(
-//      llvm_context, metadata);
-//  llvm::Value* rsp_value = __ CreateCall(intrinsic, val);
-//  auto above_equal = CompareRoot(rsp_value, Heap::kStackLimitRootIndex,
-//                                 llvm::CmpInst::ICMP_UGE);
-//  Assert(above_equal);
+  // Hydrogen puts these at the function entry and on loop back edges,
+  // which is exactly where the interrupts (and pending installs of
+  // concurrently compiled code, termination requests...) must be noticed.
+  // The StackGuard signals them by lowering the stack limit, so the fast
+  // path is a single compare of rsp against the limit.
+  if (!FLAG_llvm_stack_checks) return;
+  // The call on the slow path would keep the loop from being vectorized.
+  if (FLAG_llvm_drop_loop_stack_checks && instr->is_backwards_branch() &&
+      IsCountedInnermostLoop(instr->block()->current_loop())) {
+    return;
+  }
+  LLVMContext& llvm_context = backend()->context();
+  llvm::Function* read_register = llvm::Intrinsic::getDeclaration(
+      module_.get(), llvm::Intrinsic::read_register, { types_->i64 });
+  auto metadata =
+    llvm::MDNode::get(llvm_context, llvm::MDString::get(llvm_context, "rsp"));
+  llvm::MetadataAsValue* val = llvm::MetadataAsValue::get(
+      llvm_context, metadata);
+  llvm::Value* rsp_value = __ CreateCall(read_register, val);
+  // The limit is changed behind our back (by other threads, too),
+  // so the load must not be hoisted out of the loop.
+  auto limit = llvm::cast<llvm::LoadInst>(
+      LoadRoot(Heap::kStackLimitRootIndex));
+  limit->setVolatile(true);
+  llvm::Value* above_equal = __ CreateICmpUGE(
+      rsp_value, __ CreatePtrToInt(limit, types_->i64));
+
+  llvm::BasicBlock* deferred = NewBlock("StackCheck deferred");
+  llvm::BasicBlock* done = NewBlock("StackCheck done");
+  llvm::MDBuilder md_builder(llvm_context);
+  auto weights = md_builder.createBranchWeights(kLikelyBranchWeight,
+                                                kUnlikelyBranchWeight);
+  __ CreateCondBr(above_equal, done, deferred, weights);
+
+  __ SetInsertPoint(deferred);
+  // The stack guard may deoptimize the function, so the call bails out
+  // lazily to the check itself (see AssignLazyEnvironment).
+  std::vector<llvm::Value*> no_args;
+  CallRuntimeFromDeferred(Runtime::kStackGuard, Use(instr->context()),
+                          no_args);
+  __ CreateBr(done);
+
+  __ SetInsertPoint(done);
 }
 
 void LLVMChunkBuilder::CallStackMap(int stackmap_id, llvm::Value* value) {
@@ -2309,9 +3432,11 @@ llvm::Value* LLVMChunkBuilder::CallStatePoint(
     llvm::Value* target_function,
     llvm::CallingConv::ID calling_conv,
     std::vector<llvm::Value*>& function_args,
-    int covering_nop_size) {
-
-  auto return_type = Types::tagged;
+    int covering_nop_size,
+    llvm::Type* return_type,
+    LLVMEnvironment* lazy_env) {
+  std::vector<llvm::Value*> deopt_args;
+  GetAllEnvironmentValues(lazy_env, deopt_args);
 
   // The statepoint intrinsic is overloaded by the function pointer type.
   std::vector<llvm::Type*> params;
@@ -2335,7 +3460,7 @@ llvm::Value* LLVMChunkBuilder::CallStatePoint(
   auto num_args = __ getInt32(IntHelper::AsUInt32(function_args.size()));
   auto flags = __ getInt32(0);
   auto num_transition_args = __ getInt32(0);
-  auto num_deopt_args = __ getInt32(0);
+  auto num_deopt_args = __ getInt32(IntHelper::AsUInt32(deopt_args.size()));
 
   std::vector<llvm::Value*>  statepoint_args =
     { llvm_patchpoint_id, nop_size, casted_target, num_args, flags };
@@ -2345,10 +3470,22 @@ llvm::Value* LLVMChunkBuilder::CallStatePoint(
 
   statepoint_args.insert(statepoint_args.end(),
                          { num_transition_args, num_deopt_args });
+  statepoint_args.insert(statepoint_args.end(),
+                         deopt_args.begin(), deopt_args.end());
 
   auto token = __ CreateCall(statepoint, statepoint_args);
   token->setCallingConv(calling_conv);
 
+  if (lazy_env) {
+    // Each lazy bailout has a deopt entry of its own, keyed by the
+    // patchpoint id, so a copy (e.g. by LoopUnswitch or LoopUnroll) would
+    // leave one of the calls without one.
+    token->setCannotDuplicate();
+    EmitLazyDeoptPadding();
+  }
+
+  if (return_type->isVoidTy()) return token;
+
   llvm::Function* gc_result = llvm::Intrinsic::getDeclaration(
       module_.get(), llvm::Intrinsic::experimental_gc_result, { return_type });
 
@@ -2357,38 +3494,50 @@ llvm::Value* LLVMChunkBuilder::CallStatePoint(
 
 llvm::Value* LLVMChunkBuilder::RecordRelocInfo(uint64_t intptr_value,
                                                RelocInfo::Mode rmode) {
-  bool extended = false;
-  if (is_uint32(intptr_value)) {
-    intptr_value = (intptr_value << 32) | kExtFillingValue;
-    extended = true;
-  }
-
-  // Here we use the intptr_value (data) only to identify the entry in the map
+  // The code only gets the index of the entry in the map (see
+  // GetRelocInfoFromRecords for where the data is put in its place).
   RelocInfo rinfo(rmode, intptr_value);
-  LLVMRelocationData::ExtendedInfo meta_info;
-  meta_info.cell_extended = extended;
-  reloc_data_->Add(rinfo, meta_info);
+  uint64_t index = reloc_data_->Add(rinfo);
 
   bool is_var_arg = false;
-  auto return_type = Types::tagged;
-  auto param_types = { Types::i64 };
+  auto return_type = types_->tagged;
+  auto param_types = { types_->i64 };
   auto func_type = llvm::FunctionType::get(return_type, param_types,
                                            is_var_arg);
   // AT&T syntax.
-  const char* asm_string = "movabsq $1, $0";
+  // Along with the movabs (which always has a 64-bit immediate) we have
+  // the assembler emit a record pointing past it, so that no disassembling
+  // is needed to find the immediate afterwards (see GetRelocInfoFromRecords).
+  // The numeric label survives the inline asm being duplicated.
+  std::string asm_string = std::string("movabsq $1, $0\n1:\n") +
+      ".pushsection " + LLVMRelocationData::kRelocRecordsSectionName +
+      ",\"a\",@progbits\n.quad 1b\n.popsection";
   // i = 64-bit integer (on x64), q = register (like r, but more regs allowed).
   const char* constraints = "=q,i,~{dirflag},~{fpsr},~{flags}";
-  bool has_side_effects = true;
+  // Until the statepoints are in place the asm is a pure function of the
+  // immediate: it neither touches memory nor has side effects. Telling LLVM
+  // so lets LLVMChunk::MergeEmbeddedObjects() merge all the uses of the same
+  // object and hoist it out of loops (the inline asm is uniqued by its
+  // string, so equal immediates make equal calls). LLVMChunk::
+  // PinEmbeddedObjects() takes that back once the statepoints are rewritten.
+  // Every copy which survives gets its own record, so duplicating or
+  // deleting the asm is fine as well.
+  bool has_side_effects = false;
   llvm::InlineAsm* inline_asm = llvm::InlineAsm::get(func_type,
                                                      asm_string,
                                                      constraints,
                                                      has_side_effects);
   llvm::BasicBlock* current_block = __ GetInsertBlock();
   auto last_instr = current_block-> getTerminator();
+  llvm::CallInst* call;
   // if block has terminator we must insert before last instruction
-  if (!last_instr) 
-    return __ CreateCall(inline_asm, __ getInt64(intptr_value));
-  auto call = llvm::CallInst::Create(inline_asm, __ getInt64(intptr_value), "reloc", last_instr);
+  if (!last_instr)
+    call = __ CreateCall(inline_asm, __ getInt64(index));
+  else
+    call = llvm::CallInst::Create(inline_asm, __ getInt64(index),
+                                  "reloc", last_instr);
+  call->setDoesNotAccessMemory();
+  call->setDoesNotThrow();
   return call;
 }
 
@@ -2399,10 +3548,10 @@ void LLVMChunkBuilder::DoConstant(HConstant* instr) {
 
 void LLVMChunkBuilder::DoReturn(HReturn* instr) {
   if (info()->IsStub()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   if (info()->saves_caller_doubles()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   // see NeedsEagerFrame() in lithium-codegen. For now here it's always true.
   DCHECK(!info()->IsStub());
@@ -2412,7 +3561,7 @@ void LLVMChunkBuilder::DoReturn(HReturn* instr) {
     llvm::Value* ret_val = Use(instr->value());
     __ CreateRet(ret_val);
   } else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
@@ -2421,7 +3570,21 @@ void LLVMChunkBuilder::DoAbnormalExit(HAbnormalExit* instr) {
 }
 
 void LLVMChunkBuilder::DoAccessArgumentsAt(HAccessArgumentsAt* instr) {
-  UNIMPLEMENTED();
+  // The arguments are pushed left to right, so the last one is right above
+  // the return address and the caller's rbp. The index has been bounds
+  // checked against the length.
+  llvm::Value* elements = Use(instr->arguments());
+  llvm::Value* length = Use(instr->length());
+  llvm::Value* index = Use(instr->index());
+  llvm::Value* slot = __ CreateSExt(__ CreateSub(length, index), types_->i64);
+  llvm::Value* offset = __ CreateAdd(
+      __ CreateMul(slot, __ getInt64(kPointerSize)),
+      __ getInt64(kFPOnStackSize + kPCOnStackSize - kPointerSize));
+  llvm::Value* address = __ CreateGEP(
+      __ CreateBitOrPointerCast(elements, types_->ptr_i8), offset);
+  llvm::Value* casted_address =
+      __ CreateBitOrPointerCast(address, types_->ptr_tagged);
+  instr->set_llvm_value(__ CreateLoad(casted_address));
 }
 
 void LLVMChunkBuilder::DoAdd(HAdd* instr) {
@@ -2434,10 +3597,13 @@ void LLVMChunkBuilder::DoAdd(HAdd* instr) {
     llvm::Value* llvm_left = Use(left);
     llvm::Value* llvm_right = Use(right);
     if (!can_overflow) {
-      llvm::Value* Add = __ CreateAdd(llvm_left, llvm_right, "");
+      // Hydrogen drops kCanOverflow for truncating uses as well, so the
+      // absence of the flag alone doesn't mean the result fits.
+      bool nsw = instr->CheckFlag(HValue::kCannotWrap);
+      llvm::Value* Add = __ CreateAdd(llvm_left, llvm_right, "", false, nsw);
       instr->set_llvm_value(Add);
     } else {
-      auto type = instr->representation().IsSmi() ? Types::i64 : Types::i32;
+      auto type = instr->representation().IsSmi() ? types_->i64 : types_->i32;
       llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
           llvm::Intrinsic::sadd_with_overflow, type);
 
@@ -2462,20 +3628,20 @@ void LLVMChunkBuilder::DoAdd(HAdd* instr) {
     DCHECK(!instr->CheckFlag(HValue::kCanOverflow));
     //FIXME: possibly wrong
     llvm::Value* left_as_i64 = __ CreateBitOrPointerCast(Use(instr->left()),
-                                                         Types::i64);
+                                                         types_->i64);
     llvm::Value* right_as_i64 = __ CreateBitOrPointerCast(Use(instr->right()),
-                                                          Types::i64);
+                                                          types_->i64);
     llvm::Value* sum = __ CreateAdd(left_as_i64, right_as_i64);
     llvm::Value* sum_as_external = __ CreateBitOrPointerCast(
         sum, GetLLVMType(Representation::External()));
     instr->set_llvm_value(sum_as_external);
   } else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
 void LLVMChunkBuilder::DoAllocateBlockContext(HAllocateBlockContext* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 
@@ -2512,8 +3678,8 @@ llvm::Value* LLVMChunkBuilder::Allocate(llvm::Value* object_size,
   llvm::BasicBlock* merge = NewBlock("Allocate merge");
   llvm::BasicBlock* deferred = NewBlock("Allocate deferred");
   llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
-          llvm::Intrinsic::uadd_with_overflow, Types::i64);
-  llvm::Value* size = __ CreateIntCast(object_size, Types::i64, true);
+          llvm::Intrinsic::uadd_with_overflow, types_->i64);
+  llvm::Value* size = __ CreateIntCast(object_size, types_->i64, true);
   llvm::Value* params[] = { result, size };
   llvm::Value* call = __ CreateCall(intrinsic, params);
   llvm::Value* sum = __ CreateExtractValue(call, 0);
@@ -2523,7 +3689,7 @@ llvm::Value* LLVMChunkBuilder::Allocate(llvm::Value* object_size,
   __ SetInsertPoint(not_carry);
   llvm::Value* top_address = __ getInt64(reinterpret_cast<uint64_t>
                                            (allocation_limit.address()));
-  llvm::Value* address = __ CreateIntToPtr(top_address, Types::ptr_i64);
+  llvm::Value* address = __ CreateIntToPtr(top_address, types_->ptr_i64);
   llvm::Value* limit_operand = __ CreateLoad(address);
   llvm::BasicBlock* limit_is_valid = NewBlock("Allocate limit is valid");
   llvm::Value* cmp_limit = __ CreateICmpUGT(sum, limit_operand);
@@ -2536,10 +3702,10 @@ llvm::Value* LLVMChunkBuilder::Allocate(llvm::Value* object_size,
   llvm::Value* final_result = nullptr;
   if (tag_result) {
     llvm::Value* inc = __ CreateAdd(result, __ getInt64(1));
-    final_result = __ CreateIntToPtr(inc, Types::tagged);
+    final_result = __ CreateIntToPtr(inc, types_->tagged);
     __ CreateBr(merge);
   } else {
-    final_result = __ CreateIntToPtr(result, Types::tagged);
+    final_result = __ CreateIntToPtr(result, types_->tagged);
     __ CreateBr(merge);
   }
 
@@ -2548,7 +3714,7 @@ llvm::Value* LLVMChunkBuilder::Allocate(llvm::Value* object_size,
   __ CreateBr(merge);
 
   __ SetInsertPoint(merge);
-  llvm::PHINode* phi = __ CreatePHI(Types::tagged, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->tagged, 2);
   phi->addIncoming(final_result, limit_is_valid);
   phi->addIncoming(deferred_result, deferred);
   return phi;
@@ -2588,7 +3754,7 @@ void LLVMChunkBuilder::DoAllocate(HAllocate* instr) {
     flags = static_cast<AllocationFlags>(flags | PRETENURE);
   }
   if (instr->MustPrefillWithFiller()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 
   DCHECK(instr->size()->representation().IsInteger32());
@@ -2601,15 +3767,134 @@ void LLVMChunkBuilder::DoAllocate(HAllocate* instr) {
 
 
 void LLVMChunkBuilder::DoApplyArguments(HApplyArguments* instr) {
-  UNIMPLEMENTED();
+  llvm::Value* function = Use(instr->function());
+  llvm::Value* receiver = Use(instr->receiver());
+  llvm::Value* length = Use(instr->length());
+  llvm::Value* elements = __ CreateBitOrPointerCast(Use(instr->elements()),
+                                                    types_->ptr_i8);
+  // A call in the IR has a fixed number of arguments, so unlike Lithium
+  // we can't push them in a loop. Instead there is a call site for each
+  // of the (few) lengths we handle, and the runtime does the rest.
+  Handle<Code> call = isolate()->builtins()->Call();
+  llvm::BasicBlock* done = NewBlock("ApplyArguments done");
+  llvm::BasicBlock* slow = NewBlock("ApplyArguments slow");
+  std::vector<llvm::BasicBlock*> call_blocks;
+  for (int argc = 0; argc <= kMaxApplyArguments; argc++) {
+    call_blocks.push_back(NewBlock("ApplyArguments " + std::to_string(argc)));
+  }
+  llvm::SwitchInst* switch_inst = __ CreateSwitch(
+      length, slow, kMaxApplyArguments + 1);
+  for (int argc = 0; argc <= kMaxApplyArguments; argc++)
+    switch_inst->addCase(__ getInt32(argc), call_blocks[argc]);
+
+  std::vector<llvm::Value*> results;
+  std::vector<llvm::BasicBlock*> result_blocks;
+  for (int argc = 0; argc <= kMaxApplyArguments; argc++) {
+    __ SetInsertPoint(call_blocks[argc]);
+    // Same as DoCallJSFunction: rsi, rdi, rbx, rax and then the arguments
+    // in the reverse order, the receiver being the last.
+    std::vector<llvm::Value*> params;
+    params.push_back(GetContext());
+    params.push_back(function);
+    params.push_back(__ getInt64(0));
+    params.push_back(__ getInt64(argc));
+    for (int i = argc - 1; i >= 0; i--) {
+      // See DoAccessArgumentsAt.
+      int offset = (argc - i) * kPointerSize +
+          kFPOnStackSize + kPCOnStackSize - kPointerSize;
+      llvm::Value* address = __ CreateBitOrPointerCast(
+          ConstructAddress(elements, offset), types_->ptr_tagged);
+      params.push_back(__ CreateLoad(address));
+    }
+    params.push_back(receiver);
+    // The Call builtin goes through the arguments adaptor if need be.
+    results.push_back(CallCode(call, llvm::CallingConv::X86_64_V8_E, params));
+    result_blocks.push_back(__ GetInsertBlock());
+    __ CreateBr(done);
+  }
+
+  // Gather the arguments into an arguments object (from the receiver
+  // slot down, as FastNewStrictArgumentsStub does), then have the runtime
+  // apply the function to it.
+  __ SetInsertPoint(slow);
+  // Second parameter is our JSFunction object (rdi).
+  llvm::Function::arg_iterator it = function_->arg_begin();
+  ++it;
+  llvm::Value* closure = it;
+  llvm::Value* receiver_offset = __ CreateAdd(
+      __ CreateShl(__ CreateZExt(length, types_->i64), kPointerSizeLog2),
+      __ getInt64(kFPOnStackSize + kPCOnStackSize));
+  llvm::Value* parameters = __ CreateBitOrPointerCast(
+      __ CreateGEP(elements, receiver_offset), types_->tagged);
+  llvm::Value* smi_length = Integer32ToSmi(length);
+  std::vector<llvm::Value*> new_arguments_params = { closure, parameters,
+                                                     smi_length };
+  // Nothing has happened yet if the code gets deoptimized meanwhile.
+  lazy_bailout_redoes_instruction_ = true;
+  llvm::Value* arguments = CallRuntimeFromDeferred(
+      Runtime::kNewStrictArguments, GetContext(), new_arguments_params);
+  lazy_bailout_redoes_instruction_ = false;
+  std::vector<llvm::Value*> apply_params = { function, receiver, arguments,
+                                             ValueFromSmi(Smi::FromInt(0)),
+                                             smi_length };
+  results.push_back(CallRuntimeFromDeferred(Runtime::kApply, GetContext(),
+                                            apply_params));
+  result_blocks.push_back(__ GetInsertBlock());
+  __ CreateBr(done);
+
+  __ SetInsertPoint(done);
+  llvm::PHINode* phi = __ CreatePHI(types_->tagged, kMaxApplyArguments + 2);
+  for (size_t i = 0; i < results.size(); i++)
+    phi->addIncoming(results[i], result_blocks[i]);
+  instr->set_llvm_value(phi);
 }
 
 void LLVMChunkBuilder::DoArgumentsElements(HArgumentsElements* instr) {
-  UNIMPLEMENTED();
+  // See LLVMChunk::FindUnsupportedInstruction().
+  DCHECK(!instr->from_inlined());
+  // Our frame if the arguments are where the call has put them, or
+  // the frame of the arguments adaptor below us if it has been in between.
+  // Either way it's an aligned stack address the GC takes for a smi.
+  llvm::Value* frame_pointer = GetFramePointer();
+  llvm::Value* caller_fp = __ CreateLoad(__ CreateBitOrPointerCast(
+      ConstructAddress(frame_pointer, StandardFrameConstants::kCallerFPOffset),
+      types_->ptr_tagged));
+  llvm::Value* caller_marker = __ CreateLoad(__ CreateBitOrPointerCast(
+      ConstructAddress(caller_fp, StandardFrameConstants::kContextOffset),
+      types_->ptr_i64));
+  llvm::Value* is_adaptor = __ CreateICmpEQ(
+      caller_marker,
+      ValueFromSmi(Smi::FromInt(StackFrame::ARGUMENTS_ADAPTOR)));
+  llvm::Value* elements = __ CreateSelect(is_adaptor, caller_fp,
+                                          frame_pointer);
+  instr->set_llvm_value(__ CreateBitOrPointerCast(elements, types_->tagged));
 }
 
 void LLVMChunkBuilder::DoArgumentsLength(HArgumentsLength* instr) {
-  UNIMPLEMENTED();
+  // Without the arguments adaptor the number of arguments is fixed.
+  llvm::Value* elements = __ CreateBitOrPointerCast(Use(instr->value()),
+                                                    types_->ptr_i8);
+  llvm::Value* not_adapted = __ CreateICmpEQ(elements, GetFramePointer());
+  llvm::BasicBlock* insert_block = __ GetInsertBlock();
+  llvm::BasicBlock* adapted = NewBlock("ArgumentsLength adapted");
+  llvm::BasicBlock* done = NewBlock("ArgumentsLength done");
+  __ CreateCondBr(not_adapted, done, adapted);
+
+  // Otherwise the adaptor knows how many there are.
+  __ SetInsertPoint(adapted);
+  llvm::Value* length_address = __ CreateBitOrPointerCast(
+      ConstructAddress(elements, ArgumentsAdaptorFrameConstants::kLengthOffset),
+      types_->ptr_i64);
+  llvm::Value* smi_length = __ CreateLoad(length_address);
+  llvm::Value* adapted_length = __ CreateTrunc(
+      __ CreateLShr(smi_length, kSmiShift), types_->i32);
+  __ CreateBr(done);
+
+  __ SetInsertPoint(done);
+  llvm::PHINode* phi = __ CreatePHI(types_->i32, 2);
+  phi->addIncoming(__ getInt32(info()->num_parameters()), insert_block);
+  phi->addIncoming(adapted_length, adapted);
+  instr->set_llvm_value(phi);
 }
 
 void LLVMChunkBuilder::DoBitwise(HBitwise* instr) {
@@ -2653,6 +3938,9 @@ void LLVMChunkBuilder::DoBoundsCheck(HBoundsCheck* instr) {
   DCHECK(representation.IsSmiOrInteger32());
   USE(representation);
 
+  // Covered by a check hoisted out of the loop (see hydrogen-bch.cc).
+  if (instr->skip_check() && !FLAG_debug_code) return;
+
   if (instr->length()->IsConstant() && instr->index()->IsConstant()) {
     auto length = instr->length()->GetInteger32Constant();
     auto index = instr->index()->GetInteger32Constant();
@@ -2673,7 +3961,7 @@ void LLVMChunkBuilder::DoBoundsCheck(HBoundsCheck* instr) {
 
   llvm::Value* compare = __ CreateICmp(cc, index, length);
   if (FLAG_debug_code && instr->skip_check()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else {
     bool negate = true;
     DeoptimizeIf(compare, Deoptimizer::kOutOfBounds, negate);
@@ -2683,7 +3971,7 @@ void LLVMChunkBuilder::DoBoundsCheck(HBoundsCheck* instr) {
 
 void LLVMChunkBuilder::DoBoundsCheckBaseIndexInformation(
     HBoundsCheckBaseIndexInformation* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::BranchTagged(HBranch* instr,
@@ -2691,7 +3979,7 @@ void LLVMChunkBuilder::BranchTagged(HBranch* instr,
                                     llvm::BasicBlock* true_target,
                                     llvm::BasicBlock* false_target) {
   llvm::Value* value = Use(instr->value());
-  llvm::Value* value_as_i64 = __ CreateBitOrPointerCast(value, Types::i64);
+  llvm::Value* value_as_i64 = __ CreateBitOrPointerCast(value, types_->i64);
 
   if (expected.IsEmpty()) expected = ToBooleanStub::Types::Generic();
 
@@ -2782,7 +4070,7 @@ void LLVMChunkBuilder::BranchTagged(HBranch* instr,
       next = check_blocks[cur_block];
     } else {
       auto map_bit_offset = LoadFieldOperand(map, Map::kBitFieldOffset);
-      auto int_map_bit_offset = __ CreatePtrToInt(map_bit_offset, Types::i64);
+      auto int_map_bit_offset = __ CreatePtrToInt(map_bit_offset, types_->i64);
       auto map_detach = __ getInt64(1 << Map::kIsUndetectable);
       auto test = __ CreateAnd(int_map_bit_offset, map_detach);
       auto cmp_zero = __ CreateICmpEQ(test, __ getInt64(0));
@@ -2810,7 +4098,7 @@ void LLVMChunkBuilder::BranchTagged(HBranch* instr,
      __ SetInsertPoint(is_string_bb);
      next = check_blocks[cur_block];
      auto str_length = LoadFieldOperand(value, String::kLengthOffset);
-     auto casted_str_length = __ CreatePtrToInt(str_length, Types::i64);
+     auto casted_str_length = __ CreatePtrToInt(str_length, types_->i64);
      auto cmp_length = __ CreateICmpEQ(casted_str_length, __ getInt64(0));
      __ CreateCondBr(cmp_length, false_target, true_target);
   }
@@ -2842,10 +4130,10 @@ void LLVMChunkBuilder::BranchTagged(HBranch* instr,
     __ CreateCondBr(cmp_root, check_blocks[++cur_block], is_heap_bb);
     __ SetInsertPoint(is_heap_bb);
     next = check_blocks[cur_block];
-    llvm::Value* zero_val = llvm::ConstantFP::get(Types::float64, 0);    
+    llvm::Value* zero_val = llvm::ConstantFP::get(types_->float64, 0);    
     auto value_addr = FieldOperand(value, HeapNumber::kValueOffset);
     llvm::Value* value_as_double_addr = __ CreateBitCast(value_addr,
-                                                         Types::ptr_float64);
+                                                         types_->ptr_float64);
     auto load_val = __ CreateLoad(value_as_double_addr);
 
     llvm::Value* compare = __ CreateFCmpOEQ(load_val, zero_val);
@@ -2871,7 +4159,7 @@ llvm::Value* LLVMChunkBuilder::CmpInstanceType(llvm::Value* map,
                              InstanceType type,
                              llvm::CmpInst::Predicate predicate) {
    llvm::Value* field_operand = LoadFieldOperand(map, Map::kInstanceTypeOffset);
-   llvm::Value* int_field_operand = __ CreatePtrToInt(field_operand, Types::i64);
+   llvm::Value* int_field_operand = __ CreatePtrToInt(field_operand, types_->i64);
    llvm::Value* int_type = __ getInt64(static_cast<int>(type));
    llvm::Value* cmp_result = __ CreateICmp(predicate, int_field_operand,
                                            int_type, "CmpInstanceType");
@@ -2892,9 +4180,9 @@ void LLVMChunkBuilder::DoBranch(HBranch* instr) {
                                                true_target, false_target);
     instr->set_llvm_value(branch);
   } else if (r.IsSmi()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else if (r.IsDouble()) {
-    llvm::Value* zero = llvm::ConstantFP::get(Types::float64, 0);
+    llvm::Value* zero = llvm::ConstantFP::get(types_->float64, 0);
     llvm::Value* compare = __ CreateFCmpUNE(Use(value), zero);
     llvm::BranchInst* branch = __ CreateCondBr(compare,
                                                true_target, false_target);
@@ -2911,13 +4199,13 @@ void LLVMChunkBuilder::DoBranch(HBranch* instr) {
       DCHECK(!info()->IsStub());
       llvm::Value* zero = __ getInt64(0);
       llvm::Value* length = LoadFieldOperand(value, String::kLengthOffset);
-      llvm::Value* casted_length = __ CreatePtrToInt(length, Types::i64);
+      llvm::Value* casted_length = __ CreatePtrToInt(length, types_->i64);
       llvm::Value* compare = __ CreateICmpNE(casted_length, zero);
       llvm::BranchInst* branch = __ CreateCondBr(compare, true_target,
                                                  false_target);
       instr->set_llvm_value(branch);
     } else if (type.IsSmi() || type.IsJSArray() || type.IsHeapNumber()) {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     } else {
       ToBooleanStub::Types expected = instr->expected_input_types();
       BranchTagged(instr, expected, true_target, false_target);
@@ -2925,6 +4213,7 @@ void LLVMChunkBuilder::DoBranch(HBranch* instr) {
   }
 }
 
+// static
 llvm::CallingConv::ID LLVMChunkBuilder::GetCallingConv(CallInterfaceDescriptor descriptor) {
   if (descriptor.GetRegisterParameterCount() == 4) {
     if (descriptor.GetRegisterParameter(0).is(rdi) &&
@@ -2955,10 +4244,10 @@ void LLVMChunkBuilder::DoCallWithDescriptor(HCallWithDescriptor* instr) {
   CallInterfaceDescriptor descriptor = instr->descriptor();
   llvm::CallingConv::ID conv = GetCallingConv(descriptor);
   // FIXME(llvm): not very good because CallingConv::ID is unsigned.
-  if (conv == -1) UNIMPLEMENTED();
+  if (conv == -1) UNSUPPORTED();
 
   //TODO: Do wee need this check here?
-  if (descriptor.GetRegisterParameterCount() != instr->OperandCount() - 2) UNIMPLEMENTED();
+  if (descriptor.GetRegisterParameterCount() != instr->OperandCount() - 2) UNSUPPORTED();
   HValue* target = instr->target();
   // TODO(llvm): how  about a zone list?
   std::vector<llvm::Value*> params;
@@ -2972,7 +4261,7 @@ void LLVMChunkBuilder::DoCallWithDescriptor(HCallWithDescriptor* instr) {
   if (instr->IsTailCall()) {
     // Well, may be llvm can grok it's a tail call.
     // This branch just needs a test.
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else {
     // TODO(llvm)::
     // LPointerMap* pointers = instr->pointer_map();
@@ -2985,7 +4274,7 @@ void LLVMChunkBuilder::DoCallWithDescriptor(HCallWithDescriptor* instr) {
       llvm::Value* call = CallCode(code, conv, params);
       instr->set_llvm_value(call);
     } else {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     }
     // codegen_->RecordSafepoint(pointers_, deopt_mode_); (AfterCall)
   }
@@ -3003,7 +4292,7 @@ void LLVMChunkBuilder::DoPushArguments(HPushArguments* instr) {
 void LLVMChunkBuilder::DoCallJSFunction(HCallJSFunction* instr) {
   // Code that follows relies on this assumption
   // (well, maybe it's not, we haven't seen a test case yet)
-  if (!instr->function()->IsConstant()) UNIMPLEMENTED();
+  if (!instr->function()->IsConstant()) UNSUPPORTED();
   // TODO(llvm): self call
 
   // TODO(llvm): record safepoints...
@@ -3035,7 +4324,7 @@ void LLVMChunkBuilder::DoCallJSFunction(HCallJSFunction* instr) {
 
   bool record_safepoint = true;
   auto call = CallVal(target_entry, llvm::CallingConv::X86_64_V8_E, args,
-                      Types::tagged, record_safepoint);
+                      types_->tagged, record_safepoint);
   instr->set_llvm_value(call);
 }
 
@@ -3122,7 +4411,7 @@ void LLVMChunkBuilder::DoCallNewArray(HCallNewArray* instr) {
           ? DISABLE_ALLOCATION_SITES
           : DONT_OVERRIDE;
   if (arity == 0) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else if (arity == 1) {
     llvm::BasicBlock* done = nullptr;  
     llvm::BasicBlock* packed_case = NewBlock("CALL NEW ARRAY PACKED CASE");
@@ -3131,7 +4420,7 @@ void LLVMChunkBuilder::DoCallNewArray(HCallNewArray* instr) {
       packed_continue = NewBlock("CALL NEW ARRAY PACKED CASE CONTINUE");
       DCHECK_GE(pending_pushed_args_.length(), 1);
       llvm::Value* first_arg = pending_pushed_args_[0];
-      first_arg = __ CreateBitOrPointerCast(first_arg, Types::i64);
+      first_arg = __ CreateBitOrPointerCast(first_arg, types_->i64);
       llvm::Value* cmp_eq = __ CreateICmpEQ(first_arg, __ getInt64(0));
       __ CreateCondBr(cmp_eq, packed_case, packed_continue);
       __ SetInsertPoint(packed_continue);
@@ -3187,7 +4476,7 @@ void LLVMChunkBuilder::DoCallNewArray(HCallNewArray* instr) {
                                        params);
     __ CreateBr(done);
     __ SetInsertPoint(done);
-    llvm::PHINode* phi = __ CreatePHI(Types::tagged, result_packed_elem ? 2 : 1);
+    llvm::PHINode* phi = __ CreatePHI(types_->tagged, result_packed_elem ? 2 : 1);
     phi->addIncoming(return_val, packed_case);
     if (result_packed_elem) {
       DCHECK(packed_continue);
@@ -3220,7 +4509,7 @@ void LLVMChunkBuilder::DoCallNewArray(HCallNewArray* instr) {
 void LLVMChunkBuilder::DoCallRuntime(HCallRuntime* instr) {
   // FIXME(llvm): use instr->save_doubles()
   llvm::Value* val = CallRuntime(instr->function());
-  llvm::Value* tagged_val = __ CreateBitOrPointerCast(val, Types::tagged);
+  llvm::Value* tagged_val = __ CreateBitOrPointerCast(val, types_->tagged);
   instr->set_llvm_value(tagged_val);
   // MarkAsCall
   // RecordSafepointWithLazyDeopt
@@ -3240,7 +4529,7 @@ void LLVMChunkBuilder::DoCallStub(HCallStub* instr) {
       llvm::Value* call = CallCode(stub.GetCode(), 
                                    llvm::CallingConv::X86_64_V8_Stub,
                                    params);
-      llvm::Value* result =  __ CreatePtrToInt(call, Types::i64);
+      llvm::Value* result =  __ CreatePtrToInt(call, types_->i64);
       instr->set_llvm_value(result);
       break;
     }
@@ -3275,7 +4564,7 @@ void LLVMChunkBuilder::ChangeDoubleToTagged(HValue* val, HChange* instr) {
   llvm::Value* store_address = FieldOperand(new_heap_number,
                                             HeapNumber::kValueOffset);
   llvm::Value* casted_address = __ CreateBitCast(store_address,
-                                                 Types::ptr_float64);
+                                                 types_->ptr_float64);
 
   // [(i8*)new_heap_number + offset] = val;
   __ CreateStore(Use(val), casted_address);
@@ -3290,7 +4579,7 @@ llvm::Value* LLVMChunkBuilder::LoadRoot(Heap::RootListIndex index) {
   // TODO(llvm): Move(RelocInfo::EXTERNAL_REFERENCE)
   auto int64_address =
       __ getInt64(reinterpret_cast<uint64_t>(root_array_start_address));
-  auto address = __ CreateBitOrPointerCast(int64_address, Types::ptr_tagged);
+  auto address = __ CreateBitOrPointerCast(int64_address, types_->ptr_tagged);
   int offset = index << kPointerSizeLog2;
   auto load_address = ConstructAddress(address, offset);
   return __ CreateLoad(load_address);
@@ -3307,13 +4596,13 @@ llvm::Value* LLVMChunkBuilder::CompareRoot(llvm::Value* operand,
 
 void LLVMChunkBuilder::ChangeDoubleToI(HValue* val, HChange* instr) {
    if (instr->CanTruncateToInt32()) {
-     llvm::Value* casted_int =  __ CreateFPToSI(Use(val), Types::i64);
+     llvm::Value* casted_int =  __ CreateFPToSI(Use(val), types_->i64);
      // FIXME: Figure out why we need this step. Fix for bitops-nsieve-bits
-     auto result = __ CreateTruncOrBitCast(casted_int, Types::i32);
+     auto result = __ CreateTruncOrBitCast(casted_int, types_->i32);
      instr->set_llvm_value(result);
      //TODO: Overflow case
    } else {
-     UNIMPLEMENTED();
+     UNSUPPORTED();
    }
 }
 
@@ -3344,7 +4633,7 @@ void LLVMChunkBuilder::ChangeTaggedToDouble(HValue* val, HChange* instr) {
 
     llvm::Value* value_addr = FieldOperand(llvm_val, HeapNumber::kValueOffset);
     llvm::Value* value_as_double_addr = __ CreateBitCast(value_addr,
-                                                         Types::ptr_float64);
+                                                         types_->ptr_float64);
 
     // On x64 it is safe to load at heap number offset before evaluating the map
     // check, since all heap objects are at least two words long.
@@ -3370,17 +4659,17 @@ void LLVMChunkBuilder::ChangeTaggedToDouble(HValue* val, HChange* instr) {
     }
 
     if (deoptimize_on_minus_zero) {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     }
   }
   
   __ SetInsertPoint(is_smi);
   auto int32_val = SmiToInteger32(val);
-  auto double_val_from_smi = __ CreateSIToFP(int32_val, Types::float64);
+  auto double_val_from_smi = __ CreateSIToFP(int32_val, types_->float64);
   __ CreateBr(merge_block);
 
   __ SetInsertPoint(merge_block);
-  llvm::PHINode* phi = __ CreatePHI(Types::float64,
+  llvm::PHINode* phi = __ CreatePHI(types_->float64,
                                     2 + can_convert_undefined_to_nan);
   phi->addIncoming(loaded_double_value, is_any_tagged);
   phi->addIncoming(double_val_from_smi, is_smi);
@@ -3423,14 +4712,14 @@ void LLVMChunkBuilder::ChangeTaggedToISlow(HValue* val, HChange* instr) {
     __ SetInsertPoint(truncate_heap_number);
     llvm::Value* value_addr = FieldOperand(Use(val), HeapNumber::kValueOffset);
     // cast to ptr to double, fetch the double and convert to i32
-    llvm::Value* double_addr = __ CreateBitCast(value_addr, Types::ptr_float64);
+    llvm::Value* double_addr = __ CreateBitCast(value_addr, types_->ptr_float64);
     llvm::Value* double_val = __ CreateLoad(double_addr);
     llvm::Value* truncate_heap_number_result = __ CreateFPToSI(double_val,
-                                                               Types::i32);
+                                                               types_->i32);
 
     //TruncateHeapNumberToI
     llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(
-          module_.get(), llvm::Intrinsic::ssub_with_overflow, Types::i32);
+          module_.get(), llvm::Intrinsic::ssub_with_overflow, types_->i32);
     llvm::Value* params[] = { __ getInt32(1), truncate_heap_number_result };
     llvm::Value* call = __ CreateCall(intrinsic, params);
     llvm::Value* overflow = __ CreateExtractValue(call, 1);
@@ -3456,11 +4745,11 @@ void LLVMChunkBuilder::ChangeTaggedToISlow(HValue* val, HChange* instr) {
                                             llvm::CallingConv::X86_64_V8_S12,
                                             args);
     llvm::Value* casted_result_intrisic = __ CreatePtrToInt(result_intrisic,
-                                                            Types::i32);
+                                                            types_->i32);
     __ CreateBr(done);
 
     __ SetInsertPoint(done);
-    llvm::PHINode* phi_done = __ CreatePHI(Types::i32, 2);
+    llvm::PHINode* phi_done = __ CreatePHI(types_->i32, 2);
     phi_done->addIncoming(casted_result_intrisic, slow_case);
     phi_done->addIncoming(truncate_heap_number_result, truncate_heap_number);
     __ CreateBr(merge_inner);
@@ -3498,7 +4787,7 @@ void LLVMChunkBuilder::ChangeTaggedToISlow(HValue* val, HChange* instr) {
     __ CreateBr(merge_inner);
 
     __ SetInsertPoint(merge_inner);
-    llvm::PHINode* phi_inner = __ CreatePHI(Types::i32, 4);
+    llvm::PHINode* phi_inner = __ CreatePHI(types_->i32, 4);
     phi_inner->addIncoming(result_no_check_bools, no_check_bools);
     phi_inner->addIncoming(result_check_true, check_true);
     phi_inner->addIncoming(result_check_false, check_false);
@@ -3510,13 +4799,13 @@ void LLVMChunkBuilder::ChangeTaggedToISlow(HValue* val, HChange* instr) {
     DeoptimizeIf(cmp, Deoptimizer::kNotAHeapNumber);
 
     auto address = FieldOperand(Use(val), HeapNumber::kValueOffset);
-    auto double_addr = __ CreateBitCast(address, Types::ptr_float64);
+    auto double_addr = __ CreateBitCast(address, types_->ptr_float64);
     auto double_val = __ CreateLoad(double_addr);
     // Convert the double to int32; convert it back do double and
     // see it the 2 doubles are equal and neither is a NaN.
     // If not, deopt (kLostPrecision or kNaN)
-    relult_for_not_smi = __ CreateFPToSI(double_val, Types::i32);
-    auto converted_double = __ CreateSIToFP(relult_for_not_smi, Types::float64);
+    relult_for_not_smi = __ CreateFPToSI(double_val, types_->i32);
+    auto converted_double = __ CreateSIToFP(relult_for_not_smi, types_->float64);
     auto ordered_and_equal = __ CreateFCmpOEQ(double_val, converted_double);
     bool negate = true;
     // TODO(llvm): in case they are unordered or equal, reason should be
@@ -3546,13 +4835,13 @@ void LLVMChunkBuilder::ChangeTaggedToISlow(HValue* val, HChange* instr) {
   __ SetInsertPoint(merge_and_ret);
   llvm::PHINode* phi = nullptr;
   if (instr->GetMinusZeroMode() == FAIL_ON_MINUS_ZERO) {
-    phi = __ CreatePHI(Types::i32, 3);
+    phi = __ CreatePHI(types_->i32, 3);
     phi->addIncoming(minus_zero_result, zero_block);
     phi->addIncoming(relult_for_smi, is_smi);
     phi->addIncoming(relult_for_not_smi, not_smi_merge);
   }
   else { 
-    phi = __ CreatePHI(Types::i32, 2);
+    phi = __ CreatePHI(types_->i32, 2);
     phi->addIncoming(relult_for_smi, is_smi);
     phi->addIncoming(relult_for_not_smi, not_smi_merge);
   }
@@ -3565,7 +4854,7 @@ void LLVMChunkBuilder::DoChange(HChange* instr) {
   HValue* val = instr->value();
   if (from.IsSmi()) {
     if (to.IsTagged()) {
-      auto as_tagged = __ CreateBitOrPointerCast(Use(val), Types::tagged);
+      auto as_tagged = __ CreateBitOrPointerCast(Use(val), types_->tagged);
       instr->set_llvm_value(as_tagged);
       return;
     }
@@ -3580,7 +4869,7 @@ void LLVMChunkBuilder::DoChange(HChange* instr) {
         llvm::Value* cond = SmiCheck(Use(val), not_smi);
         DeoptimizeIf(cond, Deoptimizer::kNotASmi);
       }
-      auto val_as_smi = __ CreateBitOrPointerCast(Use(val), Types::smi);
+      auto val_as_smi = __ CreateBitOrPointerCast(Use(val), types_->smi);
       instr->set_llvm_value(val_as_smi);
     } else {
       DCHECK(to.IsInteger32());
@@ -3598,18 +4887,18 @@ void LLVMChunkBuilder::DoChange(HChange* instr) {
       } else if (to.IsTagged()) {
         ChangeDoubleToTagged(val, instr);
       } else {
-        UNIMPLEMENTED();
+        UNSUPPORTED();
       }
   } else if (from.IsInteger32()) {
     if (to.IsTagged()) {
       if (!instr->CheckFlag(HValue::kCanOverflow)) {
         auto smi_as_tagged = __ CreateBitOrPointerCast(Integer32ToSmi(val),
-                                                       Types::tagged);
+                                                       types_->tagged);
         instr->set_llvm_value(smi_as_tagged);
       } else if (instr->value()->CheckFlag(HInstruction::kUint32)) {
         DoNumberTagU(instr);
       } else {
-        UNIMPLEMENTED();
+        UNSUPPORTED();
       }
     } else if (to.IsSmi()) {
       //TODO: not tested
@@ -3621,7 +4910,7 @@ void LLVMChunkBuilder::DoChange(HChange* instr) {
           //If it set we can't convert int to smi
           cmp = __ CreateICmpSLT(Use(val), __ getInt32(0));
          } else {
-            UNIMPLEMENTED();
+            UNSUPPORTED();
             DCHECK(SmiValuesAre31Bits());
          }
          DeoptimizeIf(cmp, Deoptimizer::kOverflow);
@@ -3631,11 +4920,11 @@ void LLVMChunkBuilder::DoChange(HChange* instr) {
       instr->set_llvm_value(result);
       if (instr->CheckFlag(HValue::kCanOverflow) &&
           !instr->value()->CheckFlag(HValue::kUint32)) { 
-        UNIMPLEMENTED();
+        UNSUPPORTED();
       }
     } else {
       DCHECK(to.IsDouble());
-      llvm::Value* double_val = __ CreateSIToFP(Use(val), Types::float64);
+      llvm::Value* double_val = __ CreateSIToFP(Use(val), types_->float64);
       instr->set_llvm_value(double_val);
       //UNIMPLEMENTED();
     }
@@ -3651,25 +4940,25 @@ void LLVMChunkBuilder::DoNumberTagU(HChange* instr){
 
   __ SetInsertPoint(is_valid_smi);
   auto smi_result = Integer32ToSmi(val);
-  auto smi_result_tagged = __ CreateBitOrPointerCast(smi_result, Types::tagged);
+  auto smi_result_tagged = __ CreateBitOrPointerCast(smi_result, types_->tagged);
   __ CreateBr(done);
 
   __ SetInsertPoint(deferred);
-  auto number_as_double = __ CreateUIToFP(val, Types::float64);
+  auto number_as_double = __ CreateUIToFP(val, types_->float64);
   llvm::Value* new_heap_number = nullptr;
   // FIXME(llvm): we do not provide gc_required label...
   if (FLAG_inline_new) {
     new_heap_number = AllocateHeapNumber();
     auto double_addr = FieldOperand(new_heap_number, HeapNumber::kValueOffset);
-    double_addr = __ CreateBitOrPointerCast(double_addr, Types::ptr_float64);
+    double_addr = __ CreateBitOrPointerCast(double_addr, types_->ptr_float64);
     __ CreateStore(number_as_double, double_addr);
   } else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   __ CreateBr(done);
 
   __ SetInsertPoint(done);
-  llvm::PHINode* phi = __ CreatePHI(Types::tagged, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->tagged, 2);
   phi->addIncoming(smi_result_tagged, is_valid_smi);
   phi->addIncoming(new_heap_number, deferred);
   instr->set_llvm_value(phi);
@@ -3714,7 +5003,7 @@ void LLVMChunkBuilder::DoCheckInstanceType(HCheckInstanceType* instr) {
     
     if (base::bits::IsPowerOfTwo32(mask)) {
       llvm::Value* addr = FieldOperand(value , Map::kInstanceTypeOffset);
-      llvm::Value* cast_to_int = __ CreateBitCast(addr, Types::ptr_i64);
+      llvm::Value* cast_to_int = __ CreateBitCast(addr, types_->ptr_i64);
       llvm::Value* val = __ CreateLoad(cast_to_int);
       llvm::Value* test = __ CreateAnd(val, __ getInt64(mask));
       llvm::Value* cmp = nullptr;
@@ -3730,7 +5019,7 @@ void LLVMChunkBuilder::DoCheckInstanceType(HCheckInstanceType* instr) {
       llvm::Value* instance_offset = LoadFieldOperand(value,
                                                       Map::kInstanceTypeOffset);
 
-      llvm::Value* casted_offset = __ CreatePtrToInt(instance_offset, Types::i64);
+      llvm::Value* casted_offset = __ CreatePtrToInt(instance_offset, types_->i64);
       llvm::Value* and_value = __ CreateAnd(casted_offset, __ getInt64(0x000000ff));
       llvm::Value* and_mask = __ CreateAnd(and_value, __ getInt64(mask));
       llvm::Value* cmp = __ CreateICmpEQ(and_mask, __ getInt64(tag));
@@ -3790,7 +5079,7 @@ void LLVMChunkBuilder::DoCheckMaps(HCheckMaps* instr) {
     DCHECK(pending_pushed_args_.is_empty());
     pending_pushed_args_.Add(Use(instr->value()), info()->zone());
     llvm::Value* result = CallRuntimeViaId(Runtime::kTryMigrateInstance);
-    llvm::Value* casted = __ CreateBitOrPointerCast(result, Types::i64);
+    llvm::Value* casted = __ CreateBitOrPointerCast(result, types_->i64);
     llvm::Value* and_result = __ CreateAnd(casted, __ getInt64(kSmiTagMask));
     llvm::Value* compare_result = __ CreateICmpEQ(and_result, __ getInt64(0));
     DeoptimizeIf(compare_result, Deoptimizer::kInstanceMigrationFailed,
@@ -3812,7 +5101,7 @@ void LLVMChunkBuilder::DoCheckMapValue(HCheckMapValue* instr) {
 }
 
 void LLVMChunkBuilder::DoCheckSmi(HCheckSmi* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoCheckValue(HCheckValue* instr) {
@@ -3832,11 +5121,11 @@ void LLVMChunkBuilder::DoCheckValue(HCheckValue* instr) {
 }
 
 void LLVMChunkBuilder::DoClampToUint8(HClampToUint8* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoClassOfTestAndBranch(HClassOfTestAndBranch* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
   // search test what it use this case
   // because I think what loop is not correctly
   llvm::Value* input = Use(instr->value());
@@ -3858,7 +5147,7 @@ void LLVMChunkBuilder::DoClassOfTestAndBranch(HClassOfTestAndBranch* instr) {
     STATIC_ASSERT(LAST_NONCALLABLE_SPEC_OBJECT_TYPE ==
                   LAST_SPEC_OBJECT_TYPE - 1);
     STATIC_ASSERT(LAST_SPEC_OBJECT_TYPE == LAST_TYPE);
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else {
     temp = LoadFieldOperand(input, HeapObject::kMapOffset);
     llvm::Value* instance_type = LoadFieldOperand(temp,
@@ -3884,7 +5173,7 @@ void LLVMChunkBuilder::DoClassOfTestAndBranch(HClassOfTestAndBranch* instr) {
   __ CreateBr(loop);
 
   __ SetInsertPoint(loop);
-  llvm::PHINode* phi_map = __ CreatePHI(Types::i64, 2);
+  llvm::PHINode* phi_map = __ CreatePHI(types_->i64, 2);
   phi_map->addIncoming(map, insert); 
   llvm::Value* map_is_smi = SmiCheck(phi_map);
   __ CreateCondBr(map_is_smi, done, loop_not_smi);
@@ -3903,7 +5192,7 @@ void LLVMChunkBuilder::DoClassOfTestAndBranch(HClassOfTestAndBranch* instr) {
   //TODO: need solv dominate all uses for other_map
   llvm::Value* zero = __ getInt64(0);
   __ SetInsertPoint(done);
-  llvm::PHINode* phi_instance = __ CreatePHI(Types::i64, 2);
+  llvm::PHINode* phi_instance = __ CreatePHI(types_->i64, 2);
   phi_instance->addIncoming(zero, insert);
   phi_instance->addIncoming(other_map, loop_not_smi);
 
@@ -3928,7 +5217,7 @@ void LLVMChunkBuilder::DoClassOfTestAndBranch(HClassOfTestAndBranch* instr) {
   llvm::Value* result = nullptr;
   AllowDeferredHandleDereference smi_check;
   if (class_name->IsSmi()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else {
     llvm::Value* name = MoveHeapObject(class_name);
     result =  __ CreateICmpEQ(instance_class_name, name);
@@ -3976,7 +5265,7 @@ void LLVMChunkBuilder::DoCompareNumericAndBranch(
 }
 
 void LLVMChunkBuilder::DoCompareHoleAndBranch(HCompareHoleAndBranch* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoCompareGeneric(HCompareGeneric* instr) {
@@ -3993,7 +5282,7 @@ void LLVMChunkBuilder::DoCompareGeneric(HCompareGeneric* instr) {
   auto right = Use(instr->right());
   std::vector<llvm::Value*> params = { context, left, right };
   auto result = CallCode(ic, llvm::CallingConv::X86_64_V8_S10, params);
-  result = __ CreateBitOrPointerCast(result, Types::i64);
+  result = __ CreateBitOrPointerCast(result, types_->i64);
   // Lithium comparison is a little strange, I think mine is all right.
   auto compare_result = __ CreateICmp(pred, result, __ getInt64(0));
   auto compare_true = NewBlock("generic comparison true");
@@ -4012,7 +5301,7 @@ void LLVMChunkBuilder::DoCompareGeneric(HCompareGeneric* instr) {
   __ CreateBr(merge);
 
   __ SetInsertPoint(merge);
-  auto phi = __ CreatePHI(Types::tagged, 2);
+  auto phi = __ CreatePHI(types_->tagged, 2);
   phi->addIncoming(true_value, compare_true);
   phi->addIncoming(false_value, compare_false);
   instr->set_llvm_value(phi);
@@ -4023,7 +5312,7 @@ void LLVMChunkBuilder::DoCompareMinusZeroAndBranch(HCompareMinusZeroAndBranch* i
   Representation rep = instr->value()->representation();
 
   if (rep.IsDouble()) {
-    llvm::Value* zero = llvm::ConstantFP::get(Types::float64, 0);
+    llvm::Value* zero = llvm::ConstantFP::get(types_->float64, 0);
     llvm::Value* not_zero = __ CreateFCmpONE(Use(instr->value()), zero);
     llvm::BasicBlock* is_zero = NewBlock("Instruction value is zero");
     __ CreateCondBr(not_zero, Use(instr->SuccessorAt(1)), is_zero);
@@ -4032,7 +5321,7 @@ void LLVMChunkBuilder::DoCompareMinusZeroAndBranch(HCompareMinusZeroAndBranch* i
     llvm::BranchInst* branch = __ CreateCondBr(cmp, Use(instr->SuccessorAt(0)), Use(instr->SuccessorAt(1)));
     instr->set_llvm_value(branch);
   } else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
@@ -4061,10 +5350,10 @@ void LLVMChunkBuilder::DoConstructDouble(HConstructDouble* instr) {
   //TODO Not tested.
   llvm::Value* hi = Use(instr->hi());
   llvm::Value* lo = Use(instr->lo());
-  llvm::Value* hi_ext = __ CreateZExt(hi, Types::i64);
+  llvm::Value* hi_ext = __ CreateZExt(hi, types_->i64);
   llvm::Value* hi_shift = __ CreateShl(hi_ext, __ getInt64(32));
   llvm::Value* result = __ CreateOr(hi_shift, lo);
-  llvm::Value* result_double = __ CreateSIToFP(result, Types::float64);
+  llvm::Value* result_double = __ CreateSIToFP(result, types_->float64);
   instr->set_llvm_value(result_double);
 }
 
@@ -4097,7 +5386,7 @@ llvm::Value* LLVMChunkBuilder::ExternalOperand(ExternalReference target) {
   auto int64_address =
       __ getInt64(reinterpret_cast<uint64_t>(root_array_start_address));
   auto load_address = ConstructAddress(int64_address, delta);
-  auto casted_address = __ CreateBitCast(load_address, Types::ptr_i64);
+  auto casted_address = __ CreateBitCast(load_address, types_->ptr_i64);
   llvm::Value* object = __ CreateLoad(casted_address);
   return object;
 }
@@ -4109,9 +5398,9 @@ void LLVMChunkBuilder::PrepareCallCFunction(int num_arguments) {
   int argument_slots_on_stack =
       ArgumentStackSlotsForCFunctionCall(num_arguments);
   // Reading from rsp
-  LLVMContext& llvm_context = LLVMGranularity::getInstance().context();
+  LLVMContext& llvm_context = backend()->context();
   llvm::Function* read_from_rsp = llvm::Intrinsic::getDeclaration(module_.get(),
-      llvm::Intrinsic::read_register, { Types::i64 });
+      llvm::Intrinsic::read_register, { types_->i64 });
   auto metadata =
     llvm::MDNode::get(llvm_context, llvm::MDString::get(llvm_context, "rsp"));
   llvm::MetadataAsValue* val = llvm::MetadataAsValue::get(
@@ -4121,7 +5410,7 @@ void LLVMChunkBuilder::PrepareCallCFunction(int num_arguments) {
   auto sub_v = __ CreateNSWSub(rsp_value, __ getInt64((argument_slots_on_stack + 1) * kRegisterSize));
   auto and_v = __ CreateAnd(sub_v, __ getInt64(-frame_alignment));
   auto address = ConstructAddress(and_v, argument_slots_on_stack * kRegisterSize);
-  auto casted_address = __ CreateBitCast(address, Types::ptr_i64);
+  auto casted_address = __ CreateBitCast(address, types_->ptr_i64);
   __ CreateStore(rsp_value, casted_address);
 }
 
@@ -4159,25 +5448,25 @@ llvm::Value* LLVMChunkBuilder::CallCFunction(ExternalReference function,
   }
   llvm::Value* obj = LoadAddress(function);
   llvm::Value* call = CallVal(obj, llvm::CallingConv::X86_64_V8_S3,
-                              params, Types::tagged);
+                              params, types_->tagged);
   DCHECK(base::OS::ActivationFrameAlignment() != 0);
   DCHECK(num_arguments >= 0);
   int argument_slots_on_stack = ArgumentStackSlotsForCFunctionCall(num_arguments);
-  LLVMContext& llvm_context = LLVMGranularity::getInstance().context();
+  LLVMContext& llvm_context = backend()->context();
   llvm::Function* intrinsic_read = llvm::Intrinsic::getDeclaration(module_.get(),
-      llvm::Intrinsic::read_register, { Types::i64 });
+      llvm::Intrinsic::read_register, { types_->i64 });
   auto metadata =
     llvm::MDNode::get(llvm_context, llvm::MDString::get(llvm_context, "rsp"));
   llvm::MetadataAsValue* val = llvm::MetadataAsValue::get(
       llvm_context, metadata);
   llvm::Value* rsp_value = __ CreateCall(intrinsic_read, val);
   llvm::Value* address = ConstructAddress(rsp_value, argument_slots_on_stack * kRegisterSize);
-  llvm::Value* casted_address = __ CreateBitCast(address, Types::ptr_i64);
+  llvm::Value* casted_address = __ CreateBitCast(address, types_->ptr_i64);
   llvm::Value* object = __ CreateLoad(casted_address);
   //Write into rsp
   std::vector<llvm::Value*> parameter = {val, object};
   llvm::Function* intrinsic_write = llvm::Intrinsic::getDeclaration(module_.get(),
-      llvm::Intrinsic::write_register, { Types::i64 });
+      llvm::Intrinsic::write_register, { types_->i64 });
   __ CreateCall(intrinsic_write, parameter);
  return call;
 }
@@ -4193,7 +5482,7 @@ void LLVMChunkBuilder::DoDateField(HDateField* instr) {
     AssertNotSmi(Use(instr->value()));
     llvm::Value* map = FieldOperand(Use(instr->value()),
             HeapObject::kMapOffset);
-    llvm::Value* cast_int = __ CreateBitCast(map, Types::ptr_i64);
+    llvm::Value* cast_int = __ CreateBitCast(map, types_->ptr_i64);
     llvm::Value* address = __ CreateLoad(cast_int);
     llvm::Value* DateObject = LoadFieldOperand(address, Map::kMapOffset);
     llvm::Value* object_type_check = __ CreateICmpEQ(DateObject,
@@ -4224,11 +5513,11 @@ void LLVMChunkBuilder::DoDateField(HDateField* instr) {
     llvm::Value* param_two = __ getInt64(intptr_value);
     std::vector<llvm::Value*> params = { param_one, param_two };
     llvm::Value* result = CallCFunction(ExternalReference::get_date_field_function(isolate()), params, 2);
-    llvm::Value* date_field_result_runtime = __ CreatePtrToInt(result, Types::i64);
+    llvm::Value* date_field_result_runtime = __ CreatePtrToInt(result, types_->i64);
     __ CreateBr(DateFieldResult);
     __ SetInsertPoint(DateFieldResult);
     if (date_field_equal) {
-       llvm::PHINode* phi = __ CreatePHI(Types::i64, 2);
+       llvm::PHINode* phi = __ CreatePHI(types_->i64, 2);
        phi->addIncoming(date_field_result_equal, date_field_equal);
        phi->addIncoming(date_field_result_runtime, date_field_runtime);
        instr->set_llvm_value(phi);
@@ -4239,11 +5528,11 @@ void LLVMChunkBuilder::DoDateField(HDateField* instr) {
 }
 
 void LLVMChunkBuilder::DoDebugBreak(HDebugBreak* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoDeclareGlobals(HDeclareGlobals* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoDeoptimize(HDeoptimize* instr) {
@@ -4254,7 +5543,7 @@ void LLVMChunkBuilder::DoDeoptimize(HDeoptimize* instr) {
   // the special case below.
   if (info()->IsStub() && type == Deoptimizer::EAGER) {
     type = Deoptimizer::LAZY;
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   // we don't support lazy yet, since we have no test cases
   // DCHECK(type == Deoptimizer::EAGER);
@@ -4285,24 +5574,24 @@ void LLVMChunkBuilder::DoDiv(HDiv* instr) {
     instr->set_llvm_value(fDiv);
    }
   else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } 
 }
 
 void LLVMChunkBuilder::DoDoubleBits(HDoubleBits* instr) {
   llvm::Value* value = Use(instr->value());
   if (instr->bits() == HDoubleBits::HIGH) {
-    llvm::Value* tmp = __ CreateBitCast(value, Types::i64);
+    llvm::Value* tmp = __ CreateBitCast(value, types_->i64);
     value = __ CreateLShr(tmp, __ getInt64(32));
-    value = __ CreateTrunc(value, Types::i32);
+    value = __ CreateTrunc(value, types_->i32);
   } else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   instr->set_llvm_value(value);
 }
 
 void LLVMChunkBuilder::DoDummyUse(HDummyUse* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoEnterInlined(HEnterInlined* instr) {
@@ -4325,11 +5614,11 @@ void LLVMChunkBuilder::DoEnterInlined(HEnterInlined* instr) {
 }
 
 void LLVMChunkBuilder::DoEnvironmentMarker(HEnvironmentMarker* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoForceRepresentation(HForceRepresentation* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoForInCacheArray(HForInCacheArray* instr) {
@@ -4350,7 +5639,7 @@ void LLVMChunkBuilder::DoForInCacheArray(HForInCacheArray* instr) {
   result = LoadFieldOperand(result, FixedArray::SizeFor(HForInCacheArray::cast(instr)->idx()));
   __ CreateBr(done_block);
   __ SetInsertPoint(done_block);
-  llvm::PHINode* phi = __ CreatePHI(Types::tagged, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->tagged, 2);
   phi->addIncoming(result1, done_block1);
   phi->addIncoming(result, load_cache);
   llvm::Value* cond = SmiCheck(phi, true);
@@ -4361,8 +5650,8 @@ void LLVMChunkBuilder::DoForInCacheArray(HForInCacheArray* instr) {
 llvm::Value* LLVMChunkBuilder::EnumLength(llvm::Value* map) {
   STATIC_ASSERT(Map::EnumLengthBits::kShift == 0);
   llvm::Value* length = LoadFieldOperand(map, Map::kBitField3Offset);
-  llvm::Value* tagged = __ CreatePtrToInt(length, Types::i64);
-  llvm::Value* length32 = __ CreateIntCast(tagged, Types::i32, true);
+  llvm::Value* tagged = __ CreatePtrToInt(length, types_->i64);
+  llvm::Value* length32 = __ CreateIntCast(tagged, types_->i32, true);
   llvm::Value* imm = __ getInt32(Map::EnumLengthBits::kMask);
   llvm::Value* result = __ CreateAnd(length32, imm);
   return Integer32ToSmi(result);
@@ -4449,18 +5738,18 @@ void LLVMChunkBuilder::DoForInPrepareMap(HForInPrepareMap* instr) {
   __ CreateBr(merge);
 
   __ SetInsertPoint(merge);
-  llvm::PHINode* phi = __ CreatePHI(Types::tagged, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->tagged, 2);
   phi->addIncoming(map, insert);
   phi->addIncoming(set, call_runtime);
   instr->set_llvm_value(phi);
 }
 
 void LLVMChunkBuilder::DoGetCachedArrayIndex(HGetCachedArrayIndex* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoHasCachedArrayIndexAndBranch(HHasCachedArrayIndexAndBranch* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 static InstanceType TestType(HHasInstanceTypeAndBranch* instr) {
@@ -4495,12 +5784,12 @@ void LLVMChunkBuilder::DoInnerAllocatedObject(HInnerAllocatedObject* instr) {
     llvm::Value* gep = ConstructAddress(Use(instr->base_object()), offset);
     instr->set_llvm_value(gep);
   } else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
 void LLVMChunkBuilder::DoInstanceOf(HInstanceOf* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoHasInPrototypeChainAndBranch(
@@ -4524,7 +5813,7 @@ void LLVMChunkBuilder::DoHasInPrototypeChainAndBranch(
   llvm::Value* load_object_map;
   __ CreateBr(loop);
   __ SetInsertPoint(loop);
-  llvm::PHINode* phi = __ CreatePHI(Types::tagged, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->tagged, 2);
   phi->addIncoming(object_map, insert);
   llvm::Value* object_prototype = LoadFieldOperand(phi,
                                                    Map::kPrototypeOffset);
@@ -4549,7 +5838,7 @@ void LLVMChunkBuilder::DoInvokeFunction(HInvokeFunction* instr) {
   //TODO: Not tested
   Handle<JSFunction> known_function = instr->known_function();
   if (known_function.is_null()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else {
     bool dont_adapt_arguments =
         instr->formal_parameter_count() == SharedFunctionInfo::kDontAdaptArgumentsSentinel;
@@ -4559,12 +5848,12 @@ void LLVMChunkBuilder::DoInvokeFunction(HInvokeFunction* instr) {
       llvm::Value* context = LoadFieldOperand(Use(instr->function()), JSFunction::kContextOffset);
 
       if (dont_adapt_arguments) {
-        UNIMPLEMENTED();
+        UNSUPPORTED();
       }
 
       // InvokeF
       if (instr->known_function().is_identical_to(info()->closure())) {
-        UNIMPLEMENTED();
+        UNSUPPORTED();
       } else {
         std::vector<llvm::Value*> params;
         params.push_back(context);
@@ -4574,24 +5863,24 @@ void LLVMChunkBuilder::DoInvokeFunction(HInvokeFunction* instr) {
         pending_pushed_args_.Clear();
         // callingConv 
         llvm::Value* call = CallVal(LoadFieldOperand(Use(instr->function()), JSFunction::kCodeEntryOffset),
-                                    llvm::CallingConv::X86_64_V8_S4, params, Types::tagged);
-        llvm::Value* return_val = __ CreatePtrToInt(call, Types::i64);
+                                    llvm::CallingConv::X86_64_V8_S4, params, types_->tagged);
+        llvm::Value* return_val = __ CreatePtrToInt(call, types_->i64);
         instr->set_llvm_value(return_val);
       }
       //TODO: Implement SafePoint with lazy deopt
     } else {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     }
   }
 }
 
 void LLVMChunkBuilder::DoIsConstructCallAndBranch(
     HIsConstructCallAndBranch* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoIsStringAndBranch(HIsStringAndBranch* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoIsSmiAndBranch(HIsSmiAndBranch* instr) {
@@ -4620,7 +5909,7 @@ void LLVMChunkBuilder::DoLeaveInlined(HLeaveInlined* instr) {
   HEnvironment* env = current_block_->last_environment();
 
   if (env->entry()->arguments_pushed()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 
   HEnvironment* outer = current_block_->last_environment()->
@@ -4633,7 +5922,7 @@ void LLVMChunkBuilder::DoLoadContextSlot(HLoadContextSlot* instr) {
   llvm::BasicBlock* insert = __ GetInsertBlock(); 
   auto offset = Context::SlotOffset(instr->slot_index());
   llvm::Value* result_addr = ConstructAddress(context, offset);
-  llvm::Value* result_casted = __ CreateBitCast(result_addr, Types::ptr_tagged);
+  llvm::Value* result_casted = __ CreateBitCast(result_addr, types_->ptr_tagged);
   llvm::Value* result = __ CreateLoad(result_casted);
   llvm::Value* root = nullptr;
   llvm::BasicBlock* load_root = nullptr;
@@ -4642,7 +5931,7 @@ void LLVMChunkBuilder::DoLoadContextSlot(HLoadContextSlot* instr) {
   if (instr->RequiresHoleCheck()) {
     llvm::Value* cmp_root = CompareRoot(result, Heap::kTheHoleValueRootIndex);
     if (instr->DeoptimizesOnHole()) {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     } else {
       load_root = NewBlock("DoLoadContextSlot load root");
       llvm::BasicBlock* is_not_hole = NewBlock("DoLoadContextSlot" 
@@ -4660,7 +5949,7 @@ void LLVMChunkBuilder::DoLoadContextSlot(HLoadContextSlot* instr) {
   if (count == 1) {
     instr->set_llvm_value(result);
   } else {
-    llvm::PHINode* phi = __ CreatePHI(Types::tagged, 2);
+    llvm::PHINode* phi = __ CreatePHI(types_->tagged, 2);
     phi->addIncoming(result, insert);
     phi->addIncoming(root, load_root);
     instr->set_llvm_value(phi);
@@ -4672,7 +5961,7 @@ void LLVMChunkBuilder::DoLoadFieldByIndex(HLoadFieldByIndex* instr) {
   llvm::Value* index = nullptr;
   if (instr->index()->representation().IsTagged()) {
     llvm::Value* temp = Use(instr->index());
-    index = __ CreatePtrToInt(temp, Types::i64);
+    index = __ CreatePtrToInt(temp, types_->i64);
   } else {
     index = Use(instr->index());
   }
@@ -4683,7 +5972,7 @@ void LLVMChunkBuilder::DoLoadFieldByIndex(HLoadFieldByIndex* instr) {
   llvm::BasicBlock* done = NewBlock("DONE");
   llvm::Value* smi_tmp = __ CreateAShr(index, __ getInt64(1));
   index = __ CreateLShr(smi_tmp, kSmiShift);
-  index = __ CreateTrunc(index, Types::i32);
+  index = __ CreateTrunc(index, types_->i32);
   llvm::Value* cmp_less = __ CreateICmpSLT(index, __ getInt32(0));
   __ CreateCondBr(cmp_less, out_of_obj, done1);
   __ SetInsertPoint(done1);
@@ -4692,29 +5981,29 @@ void LLVMChunkBuilder::DoLoadFieldByIndex(HLoadFieldByIndex* instr) {
   llvm::Value* offset = __ getInt32(JSObject::kHeaderSize);
   llvm::Value* mul = __ CreateMul(index, scale);
   llvm::Value* add = __ CreateAdd(mul, offset);
-  llvm::Value* int_ptr = __ CreateIntToPtr(object, Types::ptr_i8);
+  llvm::Value* int_ptr = __ CreateIntToPtr(object, types_->ptr_i8);
   llvm::Value* gep_0 = __ CreateGEP(int_ptr, add);
-  llvm::Value* tmp1 = __ CreateBitCast(gep_0, Types::ptr_i64);
+  llvm::Value* tmp1 = __ CreateBitCast(gep_0, types_->ptr_i64);
   llvm::Value* int64_val1 = __ CreateLoad(tmp1);
   __ CreateBr(done);
   __ SetInsertPoint(out_of_obj);
   scale = __ getInt64(8);
   offset = __ getInt64(JSObject::kHeaderSize-kPointerSize);
   llvm::Value* v2 = LoadFieldOperand(object, JSObject::kPropertiesOffset);
-  llvm::Value* int64_val = __ CreatePtrToInt(v2, Types::i64);
+  llvm::Value* int64_val = __ CreatePtrToInt(v2, types_->i64);
   llvm::Value* neg_val1 = __ CreateNeg(int64_val);
   llvm::Value* mul1 = __ CreateMul(neg_val1, scale);
   llvm::Value* add1 = __ CreateAdd(mul1, offset);
-  llvm::Value* int_ptr1 = __ CreateIntToPtr(v2, Types::ptr_i8);
+  llvm::Value* int_ptr1 = __ CreateIntToPtr(v2, types_->ptr_i8);
   llvm::Value* v3 =  __ CreateGEP(int_ptr1, add1);
-  llvm::Value* tmp2 = __ CreateBitCast(v3, Types::ptr_i64);
+  llvm::Value* tmp2 = __ CreateBitCast(v3, types_->ptr_i64);
   llvm::Value* int64_val2 = __ CreateLoad(tmp2);
   __ CreateBr(done);
   __ SetInsertPoint(done);
-  llvm::PHINode* phi = __ CreatePHI(Types::i64, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->i64, 2);
   phi->addIncoming(int64_val1, done1);
   phi->addIncoming(int64_val2, out_of_obj);
-  llvm::Value* phi_tagged = __ CreateIntToPtr(phi, Types::tagged);
+  llvm::Value* phi_tagged = __ CreateIntToPtr(phi, types_->tagged);
   instr->set_llvm_value(phi_tagged);
 }
 
@@ -4746,7 +6035,7 @@ void LLVMChunkBuilder::DoLoadFunctionPrototype(HLoadFunctionPrototype* instr) {
 
   __ CreateBr(done);
   __ SetInsertPoint(done);
-  llvm::PHINode* phi = __ CreatePHI(Types::i64, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->i64, 2);
   phi->addIncoming(load_func, insert);
   phi->addIncoming(get_prototype, equal);
   instr->set_llvm_value(phi);
@@ -4798,67 +6087,75 @@ void LLVMChunkBuilder::DoLoadKeyedExternalArray(HLoadKeyed* instr) {
   int32_t base_offset = instr->base_offset();
 
   if (kPointerSize == kInt32Size && !key->IsConstant()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 
   llvm::Value* elements = Use(instr->elements());
   llvm::Value* address = BuildFastArrayOperand(key, elements, 
                                                kind, base_offset);
   if (kind == FLOAT32_ELEMENTS) {
-    auto casted_address = __ CreateBitCast(address, Types::ptr_float32);
+    auto casted_address = __ CreateBitCast(address, types_->ptr_float32);
     auto load = __ CreateLoad(casted_address);
-    auto result = __ CreateFPExt(load, Types::float64);
+    SetTbaa(load, kTbaaTypedArrayData);
+    auto result = __ CreateFPExt(load, types_->float64);
     instr->set_llvm_value(result);
     // UNIMPLEMENTED();
   } else if (kind == FLOAT64_ELEMENTS) {
-    auto casted_address = __ CreateBitCast(address, Types::ptr_float64);
+    auto casted_address = __ CreateBitCast(address, types_->ptr_float64);
     auto load = __ CreateLoad(casted_address);
+    SetTbaa(load, kTbaaTypedArrayData);
     instr->set_llvm_value(load);
   } else {
     // TODO(llvm): DRY: hoist the common part.
     switch (kind) {
       case INT8_ELEMENTS: {
-        auto casted_address = __ CreateBitCast(address, Types::ptr_i8);
+        auto casted_address = __ CreateBitCast(address, types_->ptr_i8);
         auto load = __ CreateLoad(casted_address);
-        llvm::Value* result = __ CreateSExt(load, Types::i32);
+        SetTbaa(load, kTbaaTypedArrayData);
+        llvm::Value* result = __ CreateSExt(load, types_->i32);
         instr->set_llvm_value(result);
         break;
       }
       case UINT8_ELEMENTS:
       case UINT8_CLAMPED_ELEMENTS:{
         //movzxbl(result, operand)
-        auto casted_address = __ CreateBitCast(address, Types::ptr_i8);
+        auto casted_address = __ CreateBitCast(address, types_->ptr_i8);
         auto load = __ CreateLoad(casted_address);
-        llvm::Value* result = __ CreateZExt(load, Types::i32);
+        SetTbaa(load, kTbaaTypedArrayData);
+        llvm::Value* result = __ CreateZExt(load, types_->i32);
         instr->set_llvm_value(result);
         break;
       }
       case INT16_ELEMENTS: {
-        auto casted_address = __ CreateBitOrPointerCast(address, Types::ptr_i16);
+        auto casted_address = __ CreateBitOrPointerCast(address, types_->ptr_i16);
         auto load = __ CreateLoad(casted_address);
-        auto extended = __ CreateSExt(load, Types::i32);
+        SetTbaa(load, kTbaaTypedArrayData);
+        auto extended = __ CreateSExt(load, types_->i32);
         instr->set_llvm_value(extended);
         break;
       }
       case UINT16_ELEMENTS: {
-        auto casted_address = __ CreateBitOrPointerCast(address, Types::ptr_i16);
+        auto casted_address = __ CreateBitOrPointerCast(address, types_->ptr_i16);
         auto load = __ CreateLoad(casted_address);
-        auto extended = __ CreateZExt(load, Types::i32);
+        SetTbaa(load, kTbaaTypedArrayData);
+        auto extended = __ CreateZExt(load, types_->i32);
         instr->set_llvm_value(extended);
         break;
       }
       case INT32_ELEMENTS: {
-        auto casted_address = __ CreateBitCast(address, Types::ptr_i32);
+        auto casted_address = __ CreateBitCast(address, types_->ptr_i32);
         auto load = __ CreateLoad(casted_address);
+        SetTbaa(load, kTbaaTypedArrayData);
         instr->set_llvm_value(load);
         break;
       }
       case UINT32_ELEMENTS: {
-        auto casted_address = __ CreateBitCast(address, Types::ptr_i32);
+        auto casted_address = __ CreateBitCast(address, types_->ptr_i32);
         auto load = __ CreateLoad(casted_address);
+        SetTbaa(load, kTbaaTypedArrayData);
         instr->set_llvm_value(load);
         if (!instr->CheckFlag(HInstruction::kUint32)) {
-          UNIMPLEMENTED();
+          UNSUPPORTED();
         }
         break;
       }
@@ -4910,17 +6207,20 @@ llvm::Value* LLVMChunkBuilder::BuildFastArrayOperand(HValue* key,
       default:
         UNIMPLEMENTED();
     }
+    // Do the arithmetic in 64 bits, where it can't overflow, so that
+    // the address is an affine function of the key for llvm (the loop
+    // vectorizer in particular needs this to compute the access strides).
+    bool nuw = false, nsw = false;
     if (key->representation().IsInteger32()) {
-       scale = __ getInt32(scale_factor);
-       offset = __ getInt32(inst_offset);
-     } else {
-       scale = __ getInt64(scale_factor);
-       offset = __ getInt64(inst_offset);
-     }
-     llvm::Value* mul = __ CreateMul(lkey, scale);
-     llvm::Value* add = __ CreateAdd(mul, offset);
-     llvm::Value* int_ptr = __ CreateIntToPtr(elements, Types::ptr_i8);
-     address = __ CreateGEP(int_ptr, add);
+      lkey = __ CreateSExt(lkey, types_->i64);
+      nsw = true;
+    }
+    scale = __ getInt64(scale_factor);
+    offset = __ getInt64(inst_offset);
+    llvm::Value* mul = __ CreateMul(lkey, scale, "", nuw, nsw);
+    llvm::Value* add = __ CreateAdd(mul, offset, "", nuw, nsw);
+    llvm::Value* int_ptr = __ CreateIntToPtr(elements, types_->ptr_i8);
+    address = __ CreateInBoundsGEP(int_ptr, add);
   }
   return address;
 }
@@ -4930,15 +6230,16 @@ void LLVMChunkBuilder::DoLoadKeyedFixedDoubleArray(HLoadKeyed* instr) {
   uint32_t inst_offset = instr->base_offset();
   if (kPointerSize == kInt32Size && !key->IsConstant() &&
       instr->IsDehoisted()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   if (instr->RequiresHoleCheck()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   llvm::Value* address = BuildFastArrayOperand(key, Use(instr->elements()),
                                        FAST_DOUBLE_ELEMENTS, inst_offset);
-  auto casted_address = __ CreateBitCast(address, Types::ptr_float64);
+  auto casted_address = __ CreateBitCast(address, types_->ptr_float64);
   llvm::Value* load = __ CreateLoad(casted_address);
+  SetTbaa(load, kTbaaFixedDoubleArraySlot);
   instr->set_llvm_value(load);
 }
 
@@ -4949,13 +6250,13 @@ void LLVMChunkBuilder::DoLoadKeyedFixedArray(HLoadKeyed* instr) {
   uint32_t inst_offset = instr->base_offset();
   if (kPointerSize == kInt32Size && !key->IsConstant() &&
       instr->IsDehoisted()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   if (representation.IsInteger32() && SmiValuesAre32Bits() &&
       instr->elements_kind() == FAST_SMI_ELEMENTS) {
     DCHECK(!requires_hole_check);
     if (FLAG_debug_code) {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     }
     DCHECK(kSmiTagSize + kSmiShiftSize == 32);
     inst_offset += kPointerSize / 2;
@@ -4966,6 +6267,7 @@ void LLVMChunkBuilder::DoLoadKeyedFixedArray(HLoadKeyed* instr) {
   auto pointer_type = GetLLVMType(instr->representation())->getPointerTo();
   casted_address = __ CreateBitCast(address, pointer_type);
   llvm::Value* load = __ CreateLoad(casted_address);
+  SetTbaa(load, kTbaaFixedArraySlot);
 
   if (requires_hole_check) {
     if (IsFastSmiElementsKind(instr->elements_kind())) {
@@ -4995,7 +6297,7 @@ void LLVMChunkBuilder::DoLoadKeyedFixedArray(HLoadKeyed* instr) {
 
       //You should be jump to check_info block
       //DeoptimizeIf(cond, check_info);
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     } else {
       __ CreateBr(check_info);
     }
@@ -5004,7 +6306,7 @@ void LLVMChunkBuilder::DoLoadKeyedFixedArray(HLoadKeyed* instr) {
     __ CreateBr(merge);
 
     __ SetInsertPoint(merge);
-    llvm::PHINode* phi = __ CreatePHI(Types::tagged, 2);
+    llvm::PHINode* phi = __ CreatePHI(types_->tagged, 2);
     phi->addIncoming(undefined, check_info);
     phi->addIncoming(load, insert);
     instr->set_llvm_value(phi);
@@ -5052,26 +6354,28 @@ void LLVMChunkBuilder::DoLoadNamedField(HLoadNamedField* instr) {
   HObjectAccess access = instr->access();
   int offset = access.offset();
   if (access.IsExternalMemory()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 
   if (instr->representation().IsDouble()) {
     llvm::Value* address = FieldOperand(Use(instr->object()), offset);
-    llvm::Value* cast_double = __ CreateBitCast(address, Types::ptr_float64);
+    llvm::Value* cast_double = __ CreateBitCast(address, types_->ptr_float64);
     llvm::Value* result = __ CreateLoad(cast_double);
+    SetTbaa(result, TbaaKindFor(access));
     instr->set_llvm_value(result);
     return;
   }
   llvm::Value* obj_arg = Use(instr->object());
   if (!access.IsInobject()) {
     obj_arg = LoadFieldOperand(obj_arg, JSObject::kPropertiesOffset);
+    SetTbaa(obj_arg, kTbaaPropertiesPointer);
   }
 
   Representation representation = access.representation();
   if (representation.IsSmi() && SmiValuesAre32Bits() &&
     instr->representation().IsInteger32()) {
     if(FLAG_debug_code) {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
       // TODO(llvm):
       // Load(scratch, FieldOperand(object, offset), representation);
       // AssertSmi(scratch);
@@ -5084,13 +6388,21 @@ void LLVMChunkBuilder::DoLoadNamedField(HLoadNamedField* instr) {
  
   llvm::Value* obj = FieldOperand(obj_arg, offset);
   if (instr->representation().IsInteger32()) {
-    llvm::Value* casted_address = __ CreateBitCast(obj, Types::ptr_i32);
-    llvm::Value* res = __ CreateLoad(casted_address);
+    llvm::Value* casted_address = __ CreateBitCast(obj, types_->ptr_i32);
+    llvm::LoadInst* res = __ CreateLoad(casted_address);
+    AnnotateLoad(res, instr);
+    SetTbaa(res, TbaaKindFor(access));
     instr->set_llvm_value(res);
   } else {
-    DCHECK_EQ(GetLLVMType(instr->representation()), Types::tagged);
-    llvm::Value* casted_address = __ CreateBitCast(obj, Types::ptr_tagged);
-    llvm::Value* res = __ CreateLoad(casted_address);
+    DCHECK_EQ(GetLLVMType(instr->representation()), types_->tagged);
+    llvm::Value* casted_address = __ CreateBitCast(obj, types_->ptr_tagged);
+    llvm::LoadInst* res = __ CreateLoad(casted_address);
+    if (access.IsMap()) {
+      AnnotateMapLoad(res);
+    } else {
+      AnnotateLoad(res, instr);
+    }
+    SetTbaa(res, TbaaKindFor(access));
     instr->set_llvm_value(res);
   }
 }
@@ -5140,25 +6452,25 @@ void LLVMChunkBuilder::DoLoadRoot(HLoadRoot* instr) {
 
 void LLVMChunkBuilder::DoMapEnumLength(HMapEnumLength* instr) {
   llvm::Value* val = EnumLength(Use(instr->value()));
-  llvm::Value* smi_tmp_val = __ CreateZExt(val, Types::i64);
+  llvm::Value* smi_tmp_val = __ CreateZExt(val, types_->i64);
   llvm::Value* smi_val = __ CreateShl(smi_tmp_val, kSmiShift);
   instr->set_llvm_value(smi_val);
   //UNIMPLEMENTED();
 }
 
 void LLVMChunkBuilder::DoMathFloorOfDiv(HMathFloorOfDiv* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoMathFloor(HUnaryMathOperation* instr) {
   llvm::Function* floor_intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
-         llvm::Intrinsic::floor, Types::float64);
+         llvm::Intrinsic::floor, types_->float64);
   std::vector<llvm::Value*> params;
   params.push_back(Use(instr->value()));
   llvm::Value* floor = __ CreateCall(floor_intrinsic, params);
-  llvm::Value* casted_int =  __ CreateFPToSI(floor, Types::i64);
+  llvm::Value* casted_int =  __ CreateFPToSI(floor, types_->i64);
      // FIXME: Figure out why we need this step. Fix for bitops-nsieve-bits
-  auto result = __ CreateTruncOrBitCast(casted_int, Types::i32);
+  auto result = __ CreateTruncOrBitCast(casted_int, types_->i32);
   instr->set_llvm_value(result);
 }
 
@@ -5202,14 +6514,14 @@ void LLVMChunkBuilder::DoMathMinMax(HMathMinMax* instr) {
     __ CreateBr(return_block);
     __ SetInsertPoint(return_block);
 
-    llvm::PHINode* phi = __ CreatePHI(Types::i32, 2);
+    llvm::PHINode* phi = __ CreatePHI(types_->i32, 2);
     phi->addIncoming(left_near, near);
     phi->addIncoming(left, insert_block);
     instr->set_llvm_value(phi);
   } else {
     if (cond_for_min) {
       llvm::Function* fmin_intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
-          llvm::Intrinsic::minnum, Types::float64);
+          llvm::Intrinsic::minnum, types_->float64);
     std::vector<llvm::Value*> params;
     params.push_back(left);
     params.push_back(right);
@@ -5217,7 +6529,7 @@ void LLVMChunkBuilder::DoMathMinMax(HMathMinMax* instr) {
     instr->set_llvm_value(fmin);
     } else {
       llvm::Function* fmax_intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
-          llvm::Intrinsic::maxnum, Types::float64);
+          llvm::Intrinsic::maxnum, types_->float64);
     std::vector<llvm::Value*> params;
     params.push_back(left);
     params.push_back(right);
@@ -5242,14 +6554,14 @@ void LLVMChunkBuilder::DoMod(HMod* instr) {
     llvm::Value* result = __ CreateFRem(left, right);
     instr->set_llvm_value(result);
   } else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
 void LLVMChunkBuilder::DoModByConstI(HMod* instr) {
   int32_t divisor_val = (HConstant::cast(instr->right()))->Integer32Value();
   if (divisor_val == 0) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   auto left = Use(instr->left());
   auto right = __ getInt32(divisor_val);
@@ -5312,7 +6624,7 @@ void LLVMChunkBuilder::DoModByPowerOf2I(HMod* instr) {
   __ CreateBr(done);
 
   __ SetInsertPoint(done);
-  llvm::PHINode* phi = __ CreatePHI(Types::i32, phi_count);
+  llvm::PHINode* phi = __ CreatePHI(types_->i32, phi_count);
   if (canNegative)
     phi->addIncoming(div1, negative);
   phi->addIncoming(div2, is_not_negative);
@@ -5382,7 +6694,7 @@ void LLVMChunkBuilder::DoModI(HMod* instr) {
   __ CreateBr(done);
 
   __ SetInsertPoint(done);
-  llvm::PHINode* phi = __ CreatePHI(Types::i32, phi_in);
+  llvm::PHINode* phi = __ CreatePHI(types_->i32, phi_in);
   if (instr->CheckFlag(HValue::kBailoutOnMinusZero)) {
     phi->addIncoming(div_res, negative);
     phi->addIncoming(div, positive);
@@ -5405,13 +6717,17 @@ void LLVMChunkBuilder::DoMul(HMul* instr) {
     llvm::Value* llvm_left = Use(left);
     llvm::Value* llvm_right = Use(right);
     bool can_overflow = instr->CheckFlag(HValue::kCanOverflow);
-    // TODO(llvm): use raw mul, not the intrinsic, if (!can_overflow).
     llvm::Value* overflow = nullptr;
-    if (instr->representation().IsSmi()) {
+    if (!can_overflow && instr->representation().IsInteger32()) {
+      // See DoAdd().
+      bool nsw = instr->CheckFlag(HValue::kCannotWrap);
+      llvm::Value* mul = __ CreateMul(llvm_left, llvm_right, "", false, nsw);
+      instr->set_llvm_value(mul);
+    } else if (instr->representation().IsSmi()) {
       // FIXME (llvm):
       // 1) Minus Zero?? Important
       // 2) see if we can refactor using SmiToInteger32() or the like
-      auto type = Types::i64;
+      auto type = types_->i64;
       llvm::Value* shift = __ CreateAShr(llvm_left, 32);
       llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
                                      llvm::Intrinsic::smul_with_overflow, type);
@@ -5423,7 +6739,7 @@ void LLVMChunkBuilder::DoMul(HMul* instr) {
       overflow = __ CreateExtractValue(call, 1);
       instr->set_llvm_value(mul);
     } else {
-      auto type = Types::i32;
+      auto type = types_->i32;
       llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
                                      llvm::Intrinsic::smul_with_overflow, type);
 
@@ -5445,27 +6761,20 @@ void LLVMChunkBuilder::DoMul(HMul* instr) {
     instr->set_llvm_value(fMul);
    }
   else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
 void LLVMChunkBuilder::DoOsrEntry(HOsrEntry* instr) {
-  int arg_count = graph()->osr()->UnoptimizedFrameSlots();
-  std::string arg_offset = std::to_string(arg_count * kPointerSize);
-  std::string asm_string1 = "add $$";
-  std::string asm_string2 = ", %rsp";
-  std::string final_strig = asm_string1 + arg_offset + asm_string2;
-  auto inl_asm_f_type = llvm::FunctionType::get(__ getVoidTy(), false);
-  llvm::InlineAsm* inline_asm = llvm::InlineAsm::get(
-      inl_asm_f_type, final_strig, "~{dirflag},~{fpsr},~{flags}", true);
-  __ CreateCall(inline_asm);
+  // Nothing to do: by the time control gets here the unoptimized frame has
+  // already been replaced with ours (see LLVMChunk::EmitOsrEntry()).
 }
 
 void LLVMChunkBuilder::DoPower(HPower* instr) {
   Representation exponent_type = instr->right()->representation();
   
   if (exponent_type.IsSmi()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else if (exponent_type.IsTagged()) {
     llvm::Value* tagged_exponent = Use(instr->right());
     llvm::Value* is_smi = SmiCheck(tagged_exponent, false);
@@ -5491,7 +6800,7 @@ void LLVMChunkBuilder::DoPower(HPower* instr) {
       params.push_back(Use(instr->OperandAt(i)));
     llvm::Value* call = CallAddress(code->entry(),
                                     llvm::CallingConv::X86_64_V8_S2,
-                                    params, Types::float64);
+                                    params, types_->float64);
     instr->set_llvm_value(call);
   
   } else if (exponent_type.IsInteger32()) {
@@ -5508,7 +6817,7 @@ void LLVMChunkBuilder::DoPower(HPower* instr) {
       params.push_back(Use(instr->OperandAt(i))); 
     llvm::Value* call = CallAddress(code->entry(),
                                     llvm::CallingConv::X86_64_V8_S2,
-                                    params, Types::float64);
+                                    params, types_->float64);
     instr->set_llvm_value(call);
   } else {
     //UNIMPLEMENTED();
@@ -5525,7 +6834,7 @@ void LLVMChunkBuilder::DoPower(HPower* instr) {
       params.push_back(Use(instr->OperandAt(i)));
     llvm::Value* call = CallAddress(code->entry(),
                                     llvm::CallingConv::X86_64_V8_S2,
-                                    params, Types::float64);
+                                    params, types_->float64);
     instr->set_llvm_value(call);
   }
 }
@@ -5571,7 +6880,7 @@ void LLVMChunkBuilder::DoRegExpLiteral(HRegExpLiteral* instr) {
   llvm::Value* l_size = __ getInt32(size);
   //TODO(llvm) impement Allocate(size, rax, rcx, rdx, &runtime_allocate, TAG_OBJECT);
   //                    jmp(&allocated, Label::kNear);
-  llvm::PHINode* phi = __ CreatePHI(Types::tagged, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->tagged, 2);
   phi->addIncoming(call_result, near);
   phi->addIncoming(fild_literal, input);
   llvm::Value* (LLVMChunkBuilder::*fptr)(HValue*, llvm::Value*);
@@ -5583,26 +6892,26 @@ void LLVMChunkBuilder::DoRegExpLiteral(HRegExpLiteral* instr) {
   for (int i = 0; i < size - kPointerSize; i += 2 * kPointerSize) {
     temp = LoadFieldOperand(value, i);
     temp2 = LoadFieldOperand(value, i + kPointerSize);
-    llvm::Value* ptr = __ CreateIntToPtr(phi, Types::ptr_i8);
+    llvm::Value* ptr = __ CreateIntToPtr(phi, types_->ptr_i8);
     llvm::Value* address =  __ CreateGEP(ptr, __ getInt32(i));
-    address = __ CreateBitCast(address, Types::ptr_tagged);
+    address = __ CreateBitCast(address, types_->ptr_tagged);
     __ CreateStore(temp, address);
     llvm::Value* address2 =  __ CreateGEP(ptr, __ getInt32(i + kPointerSize));
-    address2 = __ CreateBitCast(address2, Types::ptr_tagged);
+    address2 = __ CreateBitCast(address2, types_->ptr_tagged);
     __ CreateStore(temp2, address2);
   }
   if ((size % (2 * kPointerSize)) != 0) {
    temp = LoadFieldOperand(value, size - kPointerSize);  // rdx
-   llvm::Value* ptr = __ CreateIntToPtr(phi, Types::ptr_i8);
+   llvm::Value* ptr = __ CreateIntToPtr(phi, types_->ptr_i8);
    llvm::Value* address =  __ CreateGEP(ptr, __ getInt32(size - kPointerSize));
-   llvm::Value* casted_address = __ CreateBitCast(address, Types::ptr_tagged);
+   llvm::Value* casted_address = __ CreateBitCast(address, types_->ptr_tagged);
    __ CreateStore(temp, casted_address);
   }
   instr->set_llvm_value(value);
 }
 
 void LLVMChunkBuilder::DoRor(HRor* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoSar(HSar* instr) {
@@ -5615,16 +6924,16 @@ void LLVMChunkBuilder::DoSar(HSar* instr) {
     instr->set_llvm_value(AShr);
   }
   else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
 void LLVMChunkBuilder::DoSeqStringGetChar(HSeqStringGetChar* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoSeqStringSetChar(HSeqStringSetChar* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoShl(HShl* instr) {
@@ -5637,7 +6946,7 @@ void LLVMChunkBuilder::DoShl(HShl* instr) {
     instr->set_llvm_value(Shl);
   }
   else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
@@ -5651,12 +6960,12 @@ void LLVMChunkBuilder::DoShr(HShr* instr) {
     instr->set_llvm_value(LShr);
   }
   else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
 void LLVMChunkBuilder::DoStoreCodeEntry(HStoreCodeEntry* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoStoreContextSlot(HStoreContextSlot* instr) {
@@ -5666,16 +6975,16 @@ void LLVMChunkBuilder::DoStoreContextSlot(HStoreContextSlot* instr) {
   int offset = Context::SlotOffset(instr->slot_index()); 
 
   if (instr->RequiresHoleCheck()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 
   llvm::Value* target = ConstructAddress(context, offset);
   llvm::Value* casted_address = nullptr;
 
   if (instr->value()->representation().IsTagged())
-    casted_address = __ CreateBitCast(target, Types::ptr_tagged);
+    casted_address = __ CreateBitCast(target, types_->ptr_tagged);
   else
-    casted_address = __ CreateBitCast(target, Types::ptr_i64);
+    casted_address = __ CreateBitCast(target, types_->ptr_i64);
 
   __ CreateStore(value, casted_address);
   if (instr->NeedsWriteBarrier()) {
@@ -5692,7 +7001,7 @@ void LLVMChunkBuilder::DoStoreContextSlot(HStoreContextSlot* instr) {
 }
 
 void LLVMChunkBuilder::DoStoreFrameContext(HStoreFrameContext* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoStoreKeyed(HStoreKeyed* instr) {
@@ -5717,45 +7026,50 @@ void LLVMChunkBuilder::DoStoreKeyedExternalArray(HStoreKeyed* instr) {
     Representation key_representation =
         instr->key()->representation();
     if (ExternalArrayOpRequiresTemp(key_representation, elements_kind)) {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     } else if (instr->IsDehoisted()) {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     }
   }
   llvm::Value* address = BuildFastArrayOperand(key, Use(instr->elements()),
                                                elements_kind, offset);
   if (elements_kind == FLOAT32_ELEMENTS) {
-    casted_address = __ CreateBitCast(address, Types::ptr_float32);
-    auto result = __ CreateFPTrunc(Use(instr->value()), Types::float32);
+    casted_address = __ CreateBitCast(address, types_->ptr_float32);
+    auto result = __ CreateFPTrunc(Use(instr->value()), types_->float32);
     store = __ CreateStore(result, casted_address);
+    SetTbaa(store, kTbaaTypedArrayData);
     instr->set_llvm_value(store);
   } else if (elements_kind == FLOAT64_ELEMENTS) {
-    casted_address = __ CreateBitCast(address, Types::ptr_float64);
+    casted_address = __ CreateBitCast(address, types_->ptr_float64);
     auto store = __ CreateStore(Use(instr->value()), casted_address);
+    SetTbaa(store, kTbaaTypedArrayData);
     instr->set_llvm_value(store);
   } else {
     switch (elements_kind) {
       case INT8_ELEMENTS:
       case UINT8_ELEMENTS:
       case UINT8_CLAMPED_ELEMENTS: {
-        casted_address = __ CreateBitCast(address, Types::ptr_i8);
-        auto result = __ CreateTruncOrBitCast(Use(instr->value()), Types::i8);
+        casted_address = __ CreateBitCast(address, types_->ptr_i8);
+        auto result = __ CreateTruncOrBitCast(Use(instr->value()), types_->i8);
         store = __ CreateStore(result, casted_address);
+        SetTbaa(store, kTbaaTypedArrayData);
         instr->set_llvm_value(store);
         break;
       }
       case INT16_ELEMENTS:
       case UINT16_ELEMENTS: {
-        auto casted_address = __ CreateBitCast(address, Types::ptr_i16);
-        auto result = __ CreateTruncOrBitCast(Use(instr->value()), Types::i16);
+        auto casted_address = __ CreateBitCast(address, types_->ptr_i16);
+        auto result = __ CreateTruncOrBitCast(Use(instr->value()), types_->i16);
         auto store = __ CreateStore(result, casted_address);
+        SetTbaa(store, kTbaaTypedArrayData);
         instr->set_llvm_value(store);
         break;
       }
       case INT32_ELEMENTS:
       case UINT32_ELEMENTS:
-        casted_address = __ CreateBitCast(address, Types::ptr_i32);
+        casted_address = __ CreateBitCast(address, types_->ptr_i32);
         store = __ CreateStore(Use(instr->value()), casted_address);
+        SetTbaa(store, kTbaaTypedArrayData);
         instr->set_llvm_value(store);
         break;
       case FLOAT32_ELEMENTS:
@@ -5782,21 +7096,22 @@ void LLVMChunkBuilder::DoStoreKeyedFixedDoubleArray(HStoreKeyed* instr) {
   ElementsKind elements_kind = instr->elements_kind();
   if (kPointerSize == kInt32Size && !key->IsConstant()
       && instr->IsDehoisted()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   llvm::Value* canonical_value = value;
   if (instr->NeedsCanonicalization()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
     llvm::Function* canonicalize = llvm::Intrinsic::getDeclaration(module_.get(),
-          llvm::Intrinsic::canonicalize, Types::float64);
+          llvm::Intrinsic::canonicalize, types_->float64);
     llvm::Value* params[] = { value };
     canonical_value = __ CreateCall(canonicalize, params);
 
   }
   llvm::Value* address = BuildFastArrayOperand(key, Use(instr->elements()),
                                                elements_kind, inst_offset);
-  llvm::Value* casted_address = __ CreateBitCast(address, Types::ptr_float64);
+  llvm::Value* casted_address = __ CreateBitCast(address, types_->ptr_float64);
   llvm::Value* Store = __ CreateStore(canonical_value, casted_address);
+  SetTbaa(Store, kTbaaFixedDoubleArraySlot);
   instr->set_llvm_value(Store);
 }
 
@@ -5807,13 +7122,13 @@ void LLVMChunkBuilder::DoStoreKeyedFixedArray(HStoreKeyed* instr) {
   uint32_t inst_offset = instr->base_offset();
   if (kPointerSize == kInt32Size && !key->IsConstant() &&
       instr->IsDehoisted()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   if (representation.IsInteger32() && SmiValuesAre32Bits()) {
     DCHECK(instr->store_mode() == STORE_TO_INITIALIZED_ENTRY);
     DCHECK(instr->elements_kind() == FAST_SMI_ELEMENTS);
     if (FLAG_debug_code) {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     }
     inst_offset += kPointerSize / 2;
 
@@ -5829,13 +7144,15 @@ void LLVMChunkBuilder::DoStoreKeyedFixedArray(HStoreKeyed* instr) {
     auto pointer_type = GetLLVMType(hValue->representation())->getPointerTo();
     casted_address = __ CreateBitOrPointerCast(address, pointer_type);
     store = __ CreateStore(Use(hValue), casted_address);
+    SetTbaa(store, kTbaaFixedArraySlot);
   } else {
     DCHECK(hValue->IsConstant());
     HConstant* constant = HConstant::cast(instr->value());
     Handle<Object> handle_value = constant->handle(isolate());
-    casted_address = __ CreateBitOrPointerCast(address, Types::ptr_tagged);
+    casted_address = __ CreateBitOrPointerCast(address, types_->ptr_tagged);
     auto llvm_val = MoveHeapObject(handle_value);
     store = __ CreateStore(llvm_val, casted_address);
+    SetTbaa(store, kTbaaFixedArraySlot);
   } 
   instr->set_llvm_value(store);
   if (instr->NeedsWriteBarrier()) {
@@ -5872,7 +7189,7 @@ void LLVMChunkBuilder::RecordWriteField(llvm::Value* object,
 
   DCHECK(IsAligned(offset, kPointerSize));
   auto map_address = FieldOperand(object, offset);
-  map_address = __ CreateBitOrPointerCast(map_address, Types::tagged);
+  map_address = __ CreateBitOrPointerCast(map_address, types_->tagged);
 
   if (emit_debug_code()) {
     UNIMPLEMENTED();
@@ -5959,7 +7276,7 @@ void LLVMChunkBuilder::DoStoreKeyedGeneric(HStoreKeyedGeneric* instr) {
   DCHECK(instr->key()->representation().IsTagged());
   DCHECK(instr->value()->representation().IsTagged());
   if (instr->HasVectorAndSlot()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 
   Handle<Code> ic = CodeFactory::KeyedStoreICInOptimizedCode(
@@ -5983,13 +7300,13 @@ void LLVMChunkBuilder::DoStoreNamedField(HStoreNamedField* instr) {
   int offset = access.offset() - 1;
 
   if (access.IsExternalMemory()) { 
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 
   AssertNotSmi(Use(instr->object()));
 
   if (!FLAG_unbox_double_fields && representation.IsDouble()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 
   if (instr->has_transition()) {
@@ -5997,16 +7314,18 @@ void LLVMChunkBuilder::DoStoreNamedField(HStoreNamedField* instr) {
     AddDeprecationDependency(transition);
     if (!instr->NeedsWriteBarrierForMap()) {
       llvm::Value* heap_transition = MoveHeapObject(transition);
-      llvm::Value* ptr = __ CreateIntToPtr(Use(instr->object()), Types::ptr_i8);
+      llvm::Value* ptr = __ CreateIntToPtr(Use(instr->object()), types_->ptr_i8);
       llvm::Value* address = FieldOperand(ptr, HeapObject::kMapOffset);
-      llvm::Value* casted_address = __ CreateBitCast(address, Types::ptr_tagged);
-      __ CreateStore(heap_transition, casted_address);
+      llvm::Value* casted_address = __ CreateBitCast(address, types_->ptr_tagged);
+      llvm::Value* store = __ CreateStore(heap_transition, casted_address);
+      SetTbaa(store, kTbaaMap);
     } else {
       llvm::Value* scratch = MoveHeapObject(transition);
       llvm::Value* obj_addr = FieldOperand(Use(instr->object()),
                                            HeapObject::kMapOffset);
-      auto casted_address = __ CreateBitCast(obj_addr, Types::ptr_tagged);
-      __ CreateStore(scratch, casted_address);
+      auto casted_address = __ CreateBitCast(obj_addr, types_->ptr_tagged);
+      llvm::Value* store = __ CreateStore(scratch, casted_address);
+      SetTbaa(store, kTbaaMap);
       RecordWriteForMap(Use(instr->object()), scratch);
     }
   }
@@ -6015,13 +7334,14 @@ void LLVMChunkBuilder::DoStoreNamedField(HStoreNamedField* instr) {
   llvm::Value* obj_arg = Use(instr->object());
   if (!access.IsInobject()) {
     obj_arg = LoadFieldOperand(obj_arg, JSObject::kPropertiesOffset);
+    SetTbaa(obj_arg, kTbaaPropertiesPointer);
   }
 
   if (representation.IsSmi() && SmiValuesAre32Bits() &&
       instr->value()->representation().IsInteger32()) {
     DCHECK(instr->store_mode() == STORE_TO_INITIALIZED_ENTRY);
     if (FLAG_debug_code) {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     }
     // Store int value directly to upper half of the smi.
     STATIC_ASSERT(kSmiTag == 0);
@@ -6033,28 +7353,31 @@ void LLVMChunkBuilder::DoStoreNamedField(HStoreNamedField* instr) {
   //Operand operand = FieldOperand(write_register, offset);
 
   if (FLAG_unbox_double_fields && representation.IsDouble()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
     DCHECK(access.IsInobject());
     llvm::Value* obj_address = ConstructAddress(Use(instr->object()), offset);
     llvm::Value* casted_obj_add =  __ CreateBitCast(obj_address,
-                                                    Types::ptr_float64);
+                                                    types_->ptr_float64);
     llvm::Value* value = Use(instr->value());
-    __ CreateStore(value, casted_obj_add);
+    llvm::Value* store = __ CreateStore(value, casted_obj_add);
+    SetTbaa(store, TbaaKindFor(access));
     return;
   } else {
     HValue* hValue = instr->value();
     if (hValue->representation().IsInteger32()) {
       llvm::Value* store_address = ConstructAddress(obj_arg, offset);
       llvm::Value* casted_adderss = __ CreateBitCast(store_address,
-                                                     Types::ptr_i32);
-      llvm::Value* casted_value = __ CreateBitCast(Use(hValue), Types::i32);
-      __ CreateStore(casted_value, casted_adderss);
+                                                     types_->ptr_i32);
+      llvm::Value* casted_value = __ CreateBitCast(Use(hValue), types_->i32);
+      llvm::Value* store = __ CreateStore(casted_value, casted_adderss);
+      SetTbaa(store, TbaaKindFor(access));
     } else if (hValue->representation().IsSmi() || !hValue->IsConstant()){
       llvm::Value* store_address = ConstructAddress(obj_arg, offset);
       auto pointer_type = GetLLVMType(hValue->representation())->getPointerTo();
       llvm::Value* casted_adderss = __ CreateBitCast(store_address,
                                                      pointer_type);
-      __ CreateStore(Use(hValue), casted_adderss);
+      llvm::Value* store = __ CreateStore(Use(hValue), casted_adderss);
+      SetTbaa(store, TbaaKindFor(access));
     } else {
       DCHECK(hValue->IsConstant());
       {
@@ -6064,9 +7387,10 @@ void LLVMChunkBuilder::DoStoreNamedField(HStoreNamedField* instr) {
         llvm::Value* store_address = ConstructAddress(obj_arg,
                                                       offset);
         llvm::Value* casted_adderss = __ CreateBitCast(store_address,
-                                                       Types::ptr_tagged);
+                                                       types_->ptr_tagged);
         auto llvm_val = MoveHeapObject(handle_value);
-        __ CreateStore(llvm_val, casted_adderss);
+        llvm::Value* store = __ CreateStore(llvm_val, casted_adderss);
+        SetTbaa(store, TbaaKindFor(access));
       }
 
     }
@@ -6102,7 +7426,7 @@ void LLVMChunkBuilder::DoStoreNamedGeneric(HStoreNamedGeneric* instr) {
     params.push_back(pending_pushed_args_[i]);
   pending_pushed_args_.Clear();
   llvm::Value* call = CallCode(ic, llvm::CallingConv::X86_64_V8_S7, params);
-  llvm::Value* return_val = __ CreatePtrToInt(call,Types::i64);
+  llvm::Value* return_val = __ CreatePtrToInt(call,types_->i64);
   instr->set_llvm_value(return_val);
 }
 
@@ -6140,7 +7464,7 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   llvm::Value* instance_type = LoadFieldOperand(map_offset,
                                                 Map::kInstanceTypeOffset);
   llvm::Value* casted_instance_type = __ CreatePtrToInt(instance_type,
-                                                         Types::i64);
+                                                         types_->i64);
   //movzxbl
   llvm::Value* result_type = __ CreateAnd(casted_instance_type,
                                           __ getInt64(0x000000ff));
@@ -6165,7 +7489,7 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   __ SetInsertPoint(cons_str_cont);
   llvm::BasicBlock* indirect_string_loaded = NewBlock("StringCharCodeAt Indirect String");
   llvm::Value* address = LoadFieldOperand(str, SlicedString::kOffsetOffset + kSmiShift / kBitsPerByte);
-  llvm::Value* casted_address = __ CreatePtrToInt(address, Types::i32);
+  llvm::Value* casted_address = __ CreatePtrToInt(address, types_->i32);
 
   // TODO Do wee need ptr_i32 here?
   llvm::Value* cons_index = __ CreateAdd(index, casted_address);
@@ -6187,11 +7511,11 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   __ CreateBr(indirect_string_loaded);
 
   __ SetInsertPoint(indirect_string_loaded);
-  llvm::PHINode* phi_string = __ CreatePHI(Types::tagged, 2);
+  llvm::PHINode* phi_string = __ CreatePHI(types_->tagged, 2);
   phi_string->addIncoming(after_cmp_root_str, cmp_root_cont);
   phi_string->addIncoming(cons_string, cons_str_cont);
 
-  llvm::PHINode* index_indirect = __ CreatePHI(Types::i32, 2);
+  llvm::PHINode* index_indirect = __ CreatePHI(types_->i32, 2);
   index_indirect->addIncoming(cons_index, cons_str_cont);
   index_indirect->addIncoming(index, cmp_root_cont);
 
@@ -6199,7 +7523,7 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
                                                HeapObject::kMapOffset);
   llvm::Value* indirect_instance = LoadFieldOperand(indirect_map,
                                                     Map::kInstanceTypeOffset);
-  indirect_instance = __ CreateBitOrPointerCast(indirect_instance, Types::i64);
+  indirect_instance = __ CreateBitOrPointerCast(indirect_instance, types_->i64);
   llvm::Value* indirect_result_type = __ CreateAnd(indirect_instance,
                                                   __ getInt64(0x000000ff));
   __ CreateBr(check_sequental);
@@ -6208,15 +7532,15 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   STATIC_ASSERT(kSeqStringTag == 0);
   llvm::BasicBlock* seq_string = NewBlock("StringCharCodeAt SeqString");
   llvm::BasicBlock* cont_inside_seq = NewBlock("StringCharCodeAt SeqString cont");
-  llvm::PHINode* phi_result_type = __ CreatePHI(Types::i64, 2);
+  llvm::PHINode* phi_result_type = __ CreatePHI(types_->i64, 2);
   phi_result_type->addIncoming(indirect_result_type, indirect_string_loaded);
   phi_result_type->addIncoming(result_type, insert);
 
-  llvm::PHINode* phi_index = __ CreatePHI(Types::i32, 2);
+  llvm::PHINode* phi_index = __ CreatePHI(types_->i32, 2);
   phi_index->addIncoming(index_indirect, indirect_string_loaded);
   phi_index->addIncoming(index, insert);
 
-  llvm::PHINode* phi_str = __ CreatePHI(Types::tagged, 2);
+  llvm::PHINode* phi_str = __ CreatePHI(types_->tagged, 2);
   phi_str->addIncoming(str, insert);
   phi_str->addIncoming(phi_string, indirect_string_loaded);
 
@@ -6230,7 +7554,7 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   llvm::BasicBlock* extern_string = NewBlock("StringCharCodeAt"
                                              " CheckShortExternelString");
   if (FLAG_debug_code) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
   STATIC_ASSERT(kShortExternalStringTag != 0);
   llvm::Value* and_short_tag = __ CreateAnd(phi_result_type,
@@ -6257,13 +7581,13 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   llvm::BasicBlock* done = NewBlock("StringCharCodeAt Done");
   llvm::Value* two_byte_offset = __ CreateMul(phi_index, __ getInt32(2));
   llvm::Value* base_casted_two_ext = __ CreateBitOrPointerCast(external_string,
-                                                               Types::ptr_i8);
+                                                               types_->ptr_i8);
   llvm::Value* two_byte_address = __ CreateGEP(base_casted_two_ext,
                                                two_byte_offset);
   llvm::Value* casted_addr_two_ext = __ CreatePointerCast(two_byte_address,
-                                                          Types::ptr_tagged);
+                                                          types_->ptr_tagged);
   llvm::Value* two_byte_ex_load = __ CreateLoad(casted_addr_two_ext);
-  two_byte_ex_load = __ CreateBitOrPointerCast(two_byte_ex_load, Types::i64);
+  two_byte_ex_load = __ CreateBitOrPointerCast(two_byte_ex_load, types_->i64);
   llvm::Value* two_byte_external_result = __ CreateAnd(two_byte_ex_load,
                                                       __ getInt64(0x0000ffff));
   __ CreateBr(done);
@@ -6272,13 +7596,13 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   llvm::Value* one_byte_offset = __ CreateAdd(phi_index,
                                               __ getInt32(kHeapObjectTag));
   llvm::Value* base_casted_one_ext = __ CreateIntToPtr(external_string,
-                                                       Types::ptr_i8);
+                                                       types_->ptr_i8);
   llvm::Value* one_byte_addr_ext = __ CreateGEP(base_casted_one_ext,
                                            one_byte_offset);
   llvm::Value* casted_addr_one_ext = __ CreatePointerCast(one_byte_addr_ext,
-                                                  Types::ptr_tagged);
+                                                  types_->ptr_tagged);
   llvm::Value* add_result_one =  __ CreateLoad(casted_addr_one_ext);
-  add_result_one = __ CreateBitOrPointerCast(add_result_one, Types::i64);
+  add_result_one = __ CreateBitOrPointerCast(add_result_one, types_->i64);
   llvm::Value* one_byte_external_result = __ CreateAnd(add_result_one,
                                                       __ getInt64(0x000000ff));
   __ CreateBr(done);
@@ -6288,8 +7612,8 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   llvm::BasicBlock* two_byte = NewBlock("StringCharCodeAt TwoByte");
   STATIC_ASSERT((kStringEncodingMask & kOneByteStringTag) != 0);
   STATIC_ASSERT((kStringEncodingMask & kTwoByteStringTag) == 0);
-  llvm::Value* base_string = __ CreatePtrToInt(phi_str, Types::i64);
-  llvm::Value* phi_index64 = __ CreateIntCast(phi_index, Types::i64, true);
+  llvm::Value* base_string = __ CreatePtrToInt(phi_str, types_->i64);
+  llvm::Value* phi_index64 = __ CreateIntCast(phi_index, types_->i64, true);
   llvm::Value* and_seq_str = __ CreateAnd(phi_result_type,
                                         __ getInt64(kStringEncodingMask));
   llvm::Value* seq_not_zero = __ CreateICmpNE(and_seq_str, __ getInt64(0));
@@ -6301,7 +7625,7 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   llvm::Value* two_byte_add_index = __ CreateAdd(two_byte_index,
                                     __ getInt64(SeqTwoByteString::kHeaderSize-1));
   llvm::Value* address_two = __ CreateAdd(base_string, two_byte_add_index);
-  llvm::Value* casted_adds_two = __ CreateIntToPtr(address_two, Types::ptr_i64);
+  llvm::Value* casted_adds_two = __ CreateIntToPtr(address_two, types_->ptr_i64);
   llvm::Value* two_byte_load = __ CreateLoad(casted_adds_two);
   llvm::Value* two_byte_result = __ CreateAnd(two_byte_load,
                                              __ getInt64(0x0000ffff));
@@ -6311,15 +7635,15 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   llvm::Value* one_byte_add_index = __ CreateAdd(phi_index64,
                                __ getInt64(SeqTwoByteString::kHeaderSize - 1));
   llvm::Value* address_one = __ CreateAdd(base_string,  one_byte_add_index);
-  llvm::Value* casted_adds_one = __ CreateIntToPtr(address_one, Types::ptr_i64);
+  llvm::Value* casted_adds_one = __ CreateIntToPtr(address_one, types_->ptr_i64);
 
   llvm::Value* one_byte_load = __ CreateLoad(casted_adds_one);
-  llvm::Value* one_result = __ CreateIntCast(one_byte_load, Types::i64, true);
+  llvm::Value* one_result = __ CreateIntCast(one_byte_load, types_->i64, true);
   llvm::Value* one_byte_result = __ CreateAnd(one_result, __ getInt64(0x000000ff));
   __ CreateBr(done);
 
   __ SetInsertPoint(done);
-  llvm::PHINode* result_gen = __ CreatePHI(Types::i64, 4);
+  llvm::PHINode* result_gen = __ CreatePHI(types_->i64, 4);
   result_gen->addIncoming(one_byte_external_result, one_byte_external);
   result_gen->addIncoming(two_byte_external_result, two_byte_external);
   result_gen->addIncoming(one_byte_result, one_byte);
@@ -6333,7 +7657,7 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   //TODO : implement non constant case
   STATIC_ASSERT(String::kMaxLength <= Smi::kMaxValue);
   if (instr->index()->IsConstant()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else {
     llvm::Value* const_index = Integer32ToSmi(instr->index());
     params.push_back(const_index);
@@ -6342,14 +7666,14 @@ void LLVMChunkBuilder::DoStringCharCodeAt(HStringCharCodeAt* instr) {
   llvm::Value* call = CallRuntimeFromDeferred(Runtime::kStringCharCodeAtRT,
                                                Use(instr->context()),
                                                params);
-   llvm::Value* call_casted = __ CreatePtrToInt(call, Types::i64);
+   llvm::Value* call_casted = __ CreatePtrToInt(call, types_->i64);
   __ CreateBr(set_value);
 
   __ SetInsertPoint(set_value);
-  llvm::PHINode* phi = __ CreatePHI(Types::i64, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->i64, 2);
   phi->addIncoming(result_gen, done);
   phi->addIncoming(call_casted, deferred);
-  auto result = __ CreateTruncOrBitCast(phi, Types::i32);
+  auto result = __ CreateTruncOrBitCast(phi, types_->i32);
   instr->set_llvm_value(result);
 }
 
@@ -6376,7 +7700,7 @@ void LLVMChunkBuilder::DoStringCompareAndBranch(HStringCompareAndBranch* instr)
   params.push_back(left);
   params.push_back(right);
   llvm::Value* result =  CallCode(ic, llvm::CallingConv::X86_64_V8_S10, params);
-  llvm::Value* return_val = __ CreatePtrToInt(result, Types::i64);
+  llvm::Value* return_val = __ CreatePtrToInt(result, types_->i64);
   //TODO (Jivan) It seems redudant
   llvm::Value* test = __ CreateAnd(return_val, return_val);
   llvm::CmpInst::Predicate pred = TokenToPredicate(op, false, false);
@@ -6393,10 +7717,12 @@ void LLVMChunkBuilder::DoSub(HSub* instr) {
     HValue* left = instr->left();
     HValue* right = instr->right();
     if (!instr->CheckFlag(HValue::kCanOverflow)) {
-      llvm::Value* sub = __ CreateSub(Use(left), Use(right), "");
+      // See DoAdd().
+      bool nsw = instr->CheckFlag(HValue::kCannotWrap);
+      llvm::Value* sub = __ CreateSub(Use(left), Use(right), "", false, nsw);
       instr->set_llvm_value(sub);
     } else {
-      auto type = instr->representation().IsSmi() ? Types::i64 : Types::i32;
+      auto type = instr->representation().IsSmi() ? types_->i64 : types_->i32;
       llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(
           module_.get(), llvm::Intrinsic::ssub_with_overflow, type);
       llvm::Value* params[] = { Use(left), Use(right) };
@@ -6429,16 +7755,16 @@ void LLVMChunkBuilder::DoSub(HSub* instr) {
     llvm::Value* sub = CallCode(code, llvm::CallingConv::X86_64_V8_S10, params);
     instr->set_llvm_value(sub);
   } else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
 void LLVMChunkBuilder::DoThisFunction(HThisFunction* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoToFastProperties(HToFastProperties* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoTransitionElementsKind(
@@ -6462,7 +7788,7 @@ void LLVMChunkBuilder::DoTransitionElementsKind(
     // map is a tagged value.
     auto new_map = Move(to_map, RelocInfo::EMBEDDED_OBJECT);
     auto store_addr = FieldOperand(object, HeapObject::kMapOffset);
-    auto casted_store_addr = __ CreateBitCast(store_addr, Types::ptr_tagged);
+    auto casted_store_addr = __ CreateBitCast(store_addr, types_->ptr_tagged);
     __ CreateStore(new_map, casted_store_addr);
     // Write barrier. TODO(llvm): give llvm.gcwrite and company a thought.
     RecordWriteForMap(object, new_map);
@@ -6505,7 +7831,7 @@ void LLVMChunkBuilder::RecordWriteForMap(llvm::Value* object,
   }
 
   auto map_address = FieldOperand(object, HeapObject::kMapOffset); // dst
-  map_address = __ CreateBitOrPointerCast(map_address, Types::tagged);
+  map_address = __ CreateBitOrPointerCast(map_address, types_->tagged);
 
   auto equal = CheckPageFlag(map,
                              MemoryChunk::kPointersToHereAreInterestingMask);
@@ -6541,7 +7867,7 @@ void LLVMChunkBuilder::RecordWriteForMap(llvm::Value* object,
 }
 
 void LLVMChunkBuilder::DoTrapAllocationMemento(HTrapAllocationMemento* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoTypeof(HTypeof* instr) {
@@ -6570,7 +7896,7 @@ void LLVMChunkBuilder::DoTypeof(HTypeof* instr) {
   llvm::Value* call = CallCode(code, llvm::CallingConv::X86_64_V8_S8, params);
   __ CreateBr(end);
   __ SetInsertPoint(end);
-  llvm::PHINode* phi = __ CreatePHI(Types::tagged, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->tagged, 2);
   phi->addIncoming(val, no_call);
   phi->addIncoming(call, do_call);
   instr->set_llvm_value(phi);
@@ -6591,7 +7917,7 @@ void LLVMChunkBuilder::DoTypeofIsAndBranch(HTypeofIsAndBranch* instr) {
      __ CreateCondBr(cmp_root, Use(instr->SuccessorAt(0)),
                      Use(instr->SuccessorAt(1)));
   } else if (String::Equals(type_name, factory->string_string())) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
     //TODO: find test
     llvm::Value* smi_cond = SmiCheck(input);
     __ CreateCondBr(smi_cond, Use(instr->SuccessorAt(1)), not_smi);
@@ -6604,9 +7930,9 @@ void LLVMChunkBuilder::DoTypeofIsAndBranch(HTypeofIsAndBranch* instr) {
     __ CreateCondBr(cond, Use(instr->SuccessorAt(0)),
                     Use(instr->SuccessorAt(1)));
   } else if (String::Equals(type_name, factory->symbol_string())) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else if (String::Equals(type_name, factory->boolean_string())) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else if (String::Equals(type_name, factory->undefined_string())) {
     //TODO: not tested
     llvm::BasicBlock* after_cmp_root = NewBlock("DoTypeofIsAndBranch "
@@ -6688,7 +8014,7 @@ void LLVMChunkBuilder::DoTypeofIsAndBranch(HTypeofIsAndBranch* instr) {
     // clang-format on   
 
   } else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
@@ -6705,7 +8031,7 @@ void LLVMChunkBuilder::DoIntegerMathAbs(HUnaryMathOperation* instr) {
   DeoptimizeIf(is_neg, Deoptimizer::kOverflow, false, is_positive);
   __ SetInsertPoint(is_positive);
   llvm::Value* val = Use(instr->value());
-  llvm::PHINode* phi = __ CreatePHI(Types::i32, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->i32, 2);
   phi->addIncoming(neg_val, is_negative);
   phi->addIncoming(val, is_positive);
   instr->set_llvm_value(phi);
@@ -6724,7 +8050,7 @@ void LLVMChunkBuilder::DoSmiMathAbs(HUnaryMathOperation* instr) {
   llvm::Value* is_neg = __ CreateICmpSLT(neg_val, __ getInt64(0));
   DeoptimizeIf(is_neg, Deoptimizer::kOverflow, false, is_positive);
   __ SetInsertPoint(is_positive);
-  llvm::PHINode* phi = __ CreatePHI(Types::smi, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->smi, 2);
   phi->addIncoming(neg_val, is_negative);
   phi->addIncoming(value, insert_block);
   instr->set_llvm_value(phi);
@@ -6734,7 +8060,7 @@ void LLVMChunkBuilder::DoMathAbs(HUnaryMathOperation* instr) {
   Representation r = instr->representation();
   if (r.IsDouble()) {
     llvm::Function* fabs_intrinsic = llvm::Intrinsic::
-          getDeclaration(module_.get(), llvm::Intrinsic::fabs, Types::float64);
+          getDeclaration(module_.get(), llvm::Intrinsic::fabs, types_->float64);
     std::vector<llvm::Value*> params;
     params.push_back(Use(instr->value()));
     llvm::Value* f_abs = __ CreateCall(fabs_intrinsic, params);
@@ -6744,7 +8070,7 @@ void LLVMChunkBuilder::DoMathAbs(HUnaryMathOperation* instr) {
   } else if (r.IsSmi()) {
     DoSmiMathAbs(instr);
   } else {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
@@ -6752,7 +8078,7 @@ void LLVMChunkBuilder::DoMathPowHalf(HUnaryMathOperation* instr) {
   //TODO : add -infinity and  infinity checks
   llvm::Value* input_ =  Use(instr->value());
   llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
-          llvm::Intrinsic::sqrt, Types::float64);
+          llvm::Intrinsic::sqrt, types_->float64);
   std::vector<llvm::Value*> params;
   params.push_back(input_);
   llvm::Value* call = __ CreateCall(intrinsic, params);
@@ -6762,7 +8088,7 @@ void LLVMChunkBuilder::DoMathPowHalf(HUnaryMathOperation* instr) {
 
 void LLVMChunkBuilder::DoMathSqrt(HUnaryMathOperation* instr) {
    llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
-          llvm::Intrinsic::sqrt, Types::float64);
+          llvm::Intrinsic::sqrt, types_->float64);
    std::vector<llvm::Value*> params;
    params.push_back(Use(instr->value()));
    llvm::Value* sqrt = __ CreateCall(intrinsic, params);
@@ -6770,8 +8096,8 @@ void LLVMChunkBuilder::DoMathSqrt(HUnaryMathOperation* instr) {
 }
 
 void LLVMChunkBuilder::DoMathRound(HUnaryMathOperation* instr) {
-  llvm::Value* llvm_double_one_half = llvm::ConstantFP::get(Types::float64, 0.5);
-  llvm::Value* llvm_double_minus_one_half = llvm::ConstantFP::get(Types::float64, -0.5);
+  llvm::Value* llvm_double_one_half = llvm::ConstantFP::get(types_->float64, 0.5);
+  llvm::Value* llvm_double_minus_one_half = llvm::ConstantFP::get(types_->float64, -0.5);
   llvm::Value* input_reg = Use(instr->value());
   llvm::Value* input_temp = nullptr;
   llvm::Value* xmm_scratch = nullptr;
@@ -6782,16 +8108,16 @@ void LLVMChunkBuilder::DoMathRound(HUnaryMathOperation* instr) {
   llvm::BasicBlock* not_equal = NewBlock("Not equal");
   llvm::BasicBlock* round_result = NewBlock("Jump to final Round result block");
   /*if (DeoptEveryNTimes()){
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }*/
   llvm::Value* cmp = __ CreateFCmpOGT(llvm_double_one_half, input_reg);
   __ CreateCondBr(cmp, below_one_half, above_one_half);
 
   __ SetInsertPoint(above_one_half);
   xmm_scratch = __ CreateFAdd(llvm_double_one_half, input_reg);
-  llvm::Value* output_reg1 = __ CreateFPToSI(xmm_scratch, Types::i32);
+  llvm::Value* output_reg1 = __ CreateFPToSI(xmm_scratch, types_->i32);
   //DeoptimizeIF
-  auto type = instr->representation().IsSmi() ? Types::i64 : Types::i32;
+  auto type = instr->representation().IsSmi() ? types_->i64 : types_->i32;
   llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
         llvm::Intrinsic::ssub_with_overflow, type);
   llvm::Value* params[] = { output_reg1, __ getInt32(0x1) };
@@ -6806,15 +8132,15 @@ void LLVMChunkBuilder::DoMathRound(HUnaryMathOperation* instr) {
 
   __ SetInsertPoint(round_to_one);
   input_temp = __ CreateFSub(input_reg, llvm_double_minus_one_half);
-  llvm::Value* output_reg2 = __ CreateFPToSI(input_temp, Types::i32);
-  auto instr_type = instr->representation().IsSmi() ? Types::i64 : Types::i32;
+  llvm::Value* output_reg2 = __ CreateFPToSI(input_temp, types_->i32);
+  auto instr_type = instr->representation().IsSmi() ? types_->i64 : types_->i32;
   llvm::Function* ssub_intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
         llvm::Intrinsic::ssub_with_overflow, instr_type);
   llvm::Value* parameters[] = { output_reg2, __ getInt32(0x1) };
   llvm::Value* call_intrinsic = __ CreateCall(ssub_intrinsic, parameters);
   llvm::Value* cmp_overflow = __ CreateExtractValue(call_intrinsic, 1);
   DeoptimizeIf(cmp_overflow, Deoptimizer::kOverflow);
-  xmm_scratch = __ CreateSIToFP(output_reg2, Types::float64);
+  xmm_scratch = __ CreateSIToFP(output_reg2, types_->float64);
   cmp = __ CreateFCmpOEQ(xmm_scratch, input_reg);
   __ CreateCondBr(cmp, round_result, not_equal);
 
@@ -6825,14 +8151,14 @@ void LLVMChunkBuilder::DoMathRound(HUnaryMathOperation* instr) {
   __ SetInsertPoint(round_to_zero);
   if (instr->CheckFlag(HValue::kBailoutOnMinusZero)) {
     //UNIMPLEMENTED();
-    llvm::Value* cmp_zero = __ CreateFCmpOLT(input_reg, __ CreateSIToFP(__ getInt64(0), Types::float64));
+    llvm::Value* cmp_zero = __ CreateFCmpOLT(input_reg, __ CreateSIToFP(__ getInt64(0), types_->float64));
     DeoptimizeIf(cmp_zero, Deoptimizer::kMinusZero);
   }
   llvm::Value* output_reg4 = __ getInt32(6);
   __ CreateBr(round_result);
 
   __ SetInsertPoint(round_result);
-  llvm::PHINode* phi = __ CreatePHI(Types::i32, 4);
+  llvm::PHINode* phi = __ CreatePHI(types_->i32, 4);
   phi->addIncoming(output_reg1, above_one_half);
   phi->addIncoming(output_reg2, round_to_one);
   phi->addIncoming(output_reg3, not_equal);
@@ -6842,7 +8168,7 @@ void LLVMChunkBuilder::DoMathRound(HUnaryMathOperation* instr) {
 
 void LLVMChunkBuilder::DoMathLog(HUnaryMathOperation* instr) {
   llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
-          llvm::Intrinsic::log, Types::float64);
+          llvm::Intrinsic::log, types_->float64);
   std::vector<llvm::Value*> params;
   params.push_back(Use(instr->value()));
   llvm::Value* log = __ CreateCall(intrinsic, params);
@@ -6851,7 +8177,7 @@ void LLVMChunkBuilder::DoMathLog(HUnaryMathOperation* instr) {
 
 void LLVMChunkBuilder::DoMathExp(HUnaryMathOperation* instr) {
   llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(module_.get(),
-          llvm::Intrinsic::exp, Types::float64);
+          llvm::Intrinsic::exp, types_->float64);
   std::vector<llvm::Value*> params;
   params.push_back(Use(instr->value()));
   llvm::Value* exp = __ CreateCall(intrinsic, params);
@@ -6877,8 +8203,8 @@ void LLVMChunkBuilder::DoUnaryMathOperation(HUnaryMathOperation* instr) {
     case kMathFround: {
         //FIXME(llvm): Is this right?
         llvm::Value* value = Use(instr->value());
-        llvm::Value* trunc_fp = __ CreateFPTrunc(value, Types::float32);
-        llvm::Value* result = __ CreateFPExt(trunc_fp, Types::float64);
+        llvm::Value* trunc_fp = __ CreateFPTrunc(value, types_->float32);
+        llvm::Value* result = __ CreateFPExt(trunc_fp, types_->float64);
         instr->set_llvm_value(result);
        break;
       }
@@ -6895,45 +8221,46 @@ void LLVMChunkBuilder::DoUnaryMathOperation(HUnaryMathOperation* instr) {
       break;
     }
     case kMathClz32:
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     default:
       UNREACHABLE();
   }
 }
 
 void LLVMChunkBuilder::DoUnknownOSRValue(HUnknownOSRValue* instr) {
-  int env_index = instr->index();
-  int spill_index = 0;
-  if (instr->environment()->is_parameter_index(env_index)) {
-    spill_index = chunk()->GetParameterStackSlot(env_index);
-    spill_index = -spill_index;
-    llvm::Function::arg_iterator it = function_->arg_begin();
-    int i = 0;
-    while (++i < 3 + spill_index) ++it;
-    llvm::Value* result = it;
-    instr->set_llvm_value(result);
+  HEnvironment* environment = instr->environment();
+  int index = instr->index();
+  llvm::Value* result;
+  if (environment->is_parameter_index(index)) {
+    // The OSR entry leaves the arguments where the call has put them.
+    result = GetParameter(index);
+  } else if (environment->is_special_index(index)) {
+    // The context, reloaded from the unoptimized frame by the OSR entry.
+    result = GetContext();
   } else {
-    spill_index = env_index - instr->environment()->first_local_index();
-    if (spill_index > LUnallocated::kMaxFixedSlotIndex) {
-      UNIMPLEMENTED();
-    }
-    if (spill_index >=0) {
-      bool is_volatile = true;
-      llvm::Value* result = __ CreateLoad(osr_preserved_values_[spill_index], is_volatile);
-      result = __ CreateBitOrPointerCast(result, GetLLVMType(instr->representation()));
-      instr->set_llvm_value(result);
-    } else {
-      //TODO: Check this case
-      DCHECK(spill_index == -1);
-      spill_index = 1;
-      llvm::Function::arg_iterator it = function_->arg_begin();
-      int i = 0;
-      while (++i < 3 + spill_index) ++it;
-      llvm::Value* result = it;
-      instr->set_llvm_value(result);
+    // The locals and then the expression stack, in the order they occupy
+    // the unoptimized frame.
+    int slot = index - environment->first_local_index();
+    DCHECK(slot >= 0 && slot < graph()->osr()->UnoptimizedFrameSlots());
+    // The buffer is shared by all the activations (see
+    // LLVMChunk::EmitOsrEntry), so the slot has to be read before anything
+    // gets the chance to call out, and to reenter the OSR entry.
+    DCHECK(instr->block() == graph()->osr()->osr_entry());
+#ifdef DEBUG
+    for (llvm::Instruction& inst : *__ GetInsertBlock()) {
+      DCHECK(!llvm::isa<llvm::CallInst>(inst) &&
+             !llvm::isa<llvm::InvokeInst>(inst));
     }
-    
-  }
+#endif
+    llvm::Value* address = ConstructAddress(GetOsrBuffer(),
+                                           slot * kPointerSize);
+    llvm::Value* casted_address =
+        __ CreateBitOrPointerCast(address, types_->ptr_tagged);
+    // Volatile, so that LLVM can't sink the load past a statepoint.
+    result = __ CreateLoad(casted_address, true);
+  }
+  DCHECK(instr->representation().IsTagged());
+  instr->set_llvm_value(result);
 }
 
 void LLVMChunkBuilder::DoUseConst(HUseConst* instr) {
@@ -6960,7 +8287,7 @@ void LLVMChunkBuilder::DoWrapReceiver(HWrapReceiver* instr) {
                 __ getInt64(1 << SharedFunctionInfo::kStrictModeBitWithinByte);
     llvm::Value* byte_offset = LoadFieldOperand(op,
                                  SharedFunctionInfo::kStrictModeByteOffset);
-    llvm::Value* casted_offset = __ CreatePtrToInt(byte_offset, Types::i64);
+    llvm::Value* casted_offset = __ CreatePtrToInt(byte_offset, types_->i64);
     llvm::Value* cmp = __ CreateICmpNE(casted_offset, bit_with_byte);
     __ CreateCondBr(cmp, receiver_ok, receiver_fail);
     __ SetInsertPoint(receiver_fail);
@@ -6969,7 +8296,7 @@ void LLVMChunkBuilder::DoWrapReceiver(HWrapReceiver* instr) {
     llvm::Value* native_bit_with_byte =
                  __ getInt64(1 << SharedFunctionInfo::kNativeBitWithinByte);
     llvm::Value* casted_native_offset = __ CreatePtrToInt(native_byte_offset,
-                                                          Types::i64);
+                                                          types_->i64);
     llvm::Value* compare = __ CreateICmpNE(casted_native_offset,
                                           native_bit_with_byte);
     __ CreateCondBr(compare, receiver_ok, dist);
@@ -7005,7 +8332,7 @@ void LLVMChunkBuilder::DoWrapReceiver(HWrapReceiver* instr) {
   __ CreateBr(receiver_ok);
 
   __ SetInsertPoint(receiver_ok);
-  llvm::PHINode* phi = __ CreatePHI(Types::tagged, 2);
+  llvm::PHINode* phi = __ CreatePHI(types_->tagged, 2);
   phi->addIncoming(global_receiver, global_object);
   phi->addIncoming(receiver, insert_block);
   instr->set_llvm_value(phi);
@@ -7016,7 +8343,7 @@ llvm::Value* LLVMChunkBuilder::CmpObjectType(llvm::Value* heap_object,
                                              InstanceType type,
                                              llvm::CmpInst::Predicate predicate) {
   llvm::Value* map = LoadFieldOperand(heap_object, HeapObject::kMapOffset);
-  llvm::Value* map_as_ptr_to_i8 = __ CreateBitOrPointerCast(map, Types::ptr_i8);
+  llvm::Value* map_as_ptr_to_i8 = __ CreateBitOrPointerCast(map, types_->ptr_i8);
   llvm::Value* object_type_addr = ConstructAddress(
       map_as_ptr_to_i8, Map::kInstanceTypeOffset - kHeapObjectTag);
   llvm::Value* object_type = __ CreateLoad(object_type_addr);
@@ -7031,7 +8358,7 @@ void LLVMChunkBuilder::DoCheckArrayBufferNotNeutered(
                                                JSArrayBufferView::kBufferOffset);
   llvm::Value* bit_field_offset = LoadFieldOperand(array_offset,
                                                    JSArrayBuffer::kBitFieldOffset);
-  bit_field_offset = __ CreateBitOrPointerCast(bit_field_offset, Types::i64);
+  bit_field_offset = __ CreateBitOrPointerCast(bit_field_offset, types_->i64);
   llvm::Value* shift = __ getInt64(1 << JSArrayBuffer::WasNeutered::kShift);
   llvm::Value* test = __ CreateAnd(bit_field_offset, shift);
   llvm::Value* cmp = __ CreateICmpNE(test, __ getInt64(0));
@@ -7039,7 +8366,7 @@ void LLVMChunkBuilder::DoCheckArrayBufferNotNeutered(
 }
 
 void LLVMChunkBuilder::DoLoadGlobalViaContext(HLoadGlobalViaContext* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
 }
 
 void LLVMChunkBuilder::DoMaybeGrowElements(HMaybeGrowElements* instr) {
@@ -7054,14 +8381,14 @@ void LLVMChunkBuilder::DoMaybeGrowElements(HMaybeGrowElements* instr) {
   DCHECK(instr->key()->representation().IsInteger32());
   DCHECK(instr->current_capacity()->representation().IsInteger32());
   if (key->IsConstant() && current_capacity->IsConstant()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else if (key->IsConstant()) {
     int32_t constant_key = (HConstant::cast(key))->Integer32Value();
     llvm::Value* capacity = Use(instr->current_capacity());
     llvm::Value* cmp = __ CreateICmpSLE(capacity, __ getInt32(constant_key));
     __ CreateCondBr(cmp, deferred, done);
   } else if (current_capacity->IsConstant()) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   } else {
     llvm::Value* cmp = __ CreateICmpSGE(Use(key), Use(current_capacity));
     __ CreateCondBr(cmp, deferred, done);
@@ -7073,7 +8400,7 @@ void LLVMChunkBuilder::DoMaybeGrowElements(HMaybeGrowElements* instr) {
   if (instr->object()->IsConstant()) {
     HConstant* constant_object = HConstant::cast(instr->object());
     if (instr->object()->representation().IsSmi()) {
-      UNIMPLEMENTED();
+      UNSUPPORTED();
     } else {
       Handle<Object> handle_value = constant_object->handle(isolate());
       llvm::Value* object = MoveHeapObject(handle_value);
@@ -7118,18 +8445,46 @@ void LLVMChunkBuilder::DoMaybeGrowElements(HMaybeGrowElements* instr) {
 
 void LLVMChunkBuilder::DoPrologue(HPrologue* instr) {
   if (info_->num_heap_slots() > 0) {
-    UNIMPLEMENTED();
+    UNSUPPORTED();
   }
 }
 
 void LLVMChunkBuilder::DoStoreGlobalViaContext(HStoreGlobalViaContext* instr) {
-  UNIMPLEMENTED();
+  UNSUPPORTED();
+}
+
+bool LLVMEnvironment::IsEquivalentTo(const LLVMEnvironment* other) const {
+  if (other == this) return true;
+  if (other == nullptr) return false;
+  if (frame_type_ != other->frame_type_ ||
+      entry_ != other->entry_ ||
+      ast_id_ != other->ast_id_ ||
+      arguments_stack_height_ != other->arguments_stack_height_ ||
+      parameter_count_ != other->parameter_count_ ||
+      translation_size_ != other->translation_size_ ||
+      values_.length() != other->values_.length()) {
+    return false;
+  }
+  for (int i = 0; i < values_.length(); i++) {
+    if (values_[i] != other->values_[i] ||
+        HasTaggedValueAt(i) != other->HasTaggedValueAt(i) ||
+        HasUint32ValueAt(i) != other->HasUint32ValueAt(i) ||
+        HasDoubleValueAt(i) != other->HasDoubleValueAt(i) ||
+        IsCallResultAt(i) != other->IsCallResultAt(i)) {
+      return false;
+    }
+  }
+  if (outer_ == nullptr || other->outer_ == nullptr) {
+    return outer_ == other->outer_;
+  }
+  return outer_->IsEquivalentTo(other->outer_);
 }
 
 void LLVMEnvironment::AddValue(llvm::Value* value,
                                Representation representation,
                                bool is_uint32) {
-  DCHECK(value->getType() == LLVMChunkBuilder::GetLLVMType(representation));
+  DCHECK(value->getType() ==
+         Types(value->getContext()).ForRepresentation(representation));
   values_.Add(value, zone());
   if (representation.IsSmiOrTagged()) {
     DCHECK(!is_uint32);
@@ -7157,6 +8512,7 @@ void LLVMRelocationData::DumpSafepointIds() {
 #endif
 }
 
+#undef UNSUPPORTED
 #undef __
 
 } }  // namespace v8::internal
@@ -15,13 +15,71 @@
 #include "llvm-stackmaps.h"
 #include "pass-rewrite-safepoints.h"
 #include "mcjit-memory-manager.h"
+#include "llvm-code-cache.h"
 #include "src/base/division-by-constant.h"
+#include "src/base/platform/mutex.h"
 
 #include <memory>
 
 namespace v8 {
 namespace internal {
 
+// Hydrogen instructions LLVMChunkBuilder can't lower yet. Functions
+// containing any of them are compiled with Lithium instead
+// (see LLVMChunk::FindUnsupportedInstruction).
+#define LLVM_UNSUPPORTED_INSTRUCTION_LIST(V) \
+  V(AllocateBlockContext)                    \
+  V(CheckSmi)                                \
+  V(ClampToUint8)                            \
+  V(ClassOfTestAndBranch)                    \
+  V(CompareHoleAndBranch)                    \
+  V(DebugBreak)                              \
+  V(DeclareGlobals)                          \
+  V(DummyUse)                                \
+  V(EnvironmentMarker)                       \
+  V(ForceRepresentation)                     \
+  V(GetCachedArrayIndex)                     \
+  V(HasCachedArrayIndexAndBranch)            \
+  V(InstanceOf)                              \
+  V(IsConstructCallAndBranch)                \
+  V(IsStringAndBranch)                       \
+  V(LoadGlobalViaContext)                    \
+  V(MathFloorOfDiv)                          \
+  V(Power)                                   \
+  V(Ror)                                     \
+  V(SeqStringGetChar)                        \
+  V(SeqStringSetChar)                        \
+  V(StoreCodeEntry)                          \
+  V(StoreFrameContext)                       \
+  V(StoreGlobalViaContext)                   \
+  V(ThisFunction)                            \
+  V(ToFastProperties)                        \
+  V(TrapAllocationMemento)
+
+// Hydrogen instructions whose (last, on any given path) call bails out
+// lazily to right after the whole instruction, when it has observable side
+// effects. That is wrong for anything that does more work (or more calls)
+// once the call returns, so every other call bails out lazily to the state
+// before its instruction (see AssignLazyEnvironment).
+#define LLVM_LAZY_BAILOUT_INSTRUCTION_LIST(V) \
+  V(ApplyArguments)                           \
+  V(CallFunction)                             \
+  V(CallJSFunction)                           \
+  V(CallNew)                                  \
+  V(CallNewArray)                             \
+  V(CallRuntime)                              \
+  V(CallStub)                                 \
+  V(CallWithDescriptor)                       \
+  V(InvokeFunction)                           \
+  V(LoadGlobalGeneric)                        \
+  V(LoadKeyedGeneric)                         \
+  V(LoadNamedGeneric)                         \
+  V(StoreKeyedGeneric)                        \
+  V(StoreNamedGeneric)                        \
+  V(StringAdd)                                \
+  V(TransitionElementsKind)                   \
+  V(Typeof)
+
 // TODO(llvm): Move to a separate file.
 // Actually it should be elsewhere. And probably there is.
 // So find it and remove this class.
@@ -57,14 +115,18 @@ struct DeoptIdMap {
 };
 class LLVMRelocationData : public ZoneObject {
  public:
-  union ExtendedInfo {
-    bool cell_extended;
-  };
+  // Maps symbolic indices to embedded object and cell reloc infos.
+  using RelocMap = std::map<uint64_t, RelocInfo>;
 
-  using RelocMap = std::map<uint64_t, std::pair<RelocInfo, ExtendedInfo>>;
+  // Name of the section the code emitted by RecordRelocInfo() puts its
+  // records into. Each record is the (absolute, fixed up by RuntimeDyld)
+  // address of the end of a movabs instruction whose 64-bit immediate is
+  // the index of some entry of reloc_map().
+  static const char* kRelocRecordsSectionName;
 
   LLVMRelocationData(Zone* zone)
      : reloc_map_(),
+       index_for_data_(),
        last_patchpoint_id_(-1),
        is_reloc_(8, zone),
        is_reloc_with_nop_(8, zone),
@@ -72,12 +134,25 @@ class LLVMRelocationData : public ZoneObject {
        is_safepoint_(8, zone),
        deopt_reasons_(),
        num_safepoint_function_args_(),
+       lazy_bailout_ids_(),
        is_transferred_(false),
        zone_(zone) {}
 
-  void Add(RelocInfo rinfo, ExtendedInfo ex_info) {
+  // Returns the index the code refers to the reloc info's data by.
+  // The data (a handle location) differs from one compilation to another
+  // while the index only depends on the order of the Add() calls, which
+  // keeps the IR (and thus the LLVMCodeCache key) free of heap addresses.
+  uint64_t Add(RelocInfo rinfo) {
     DCHECK(!is_transferred_);
-    reloc_map_[rinfo.data()] = std::make_pair(rinfo, ex_info);
+    auto it = index_for_data_.find(rinfo.data());
+    if (it != index_for_data_.end()) {
+      DCHECK(reloc_map_[it->second].rmode() == rinfo.rmode());
+      return it->second;
+    }
+    uint64_t index = reloc_map_.size();
+    reloc_map_[index] = rinfo;
+    index_for_data_[rinfo.data()] = index;
+    return index;
   }
 
   RelocMap& reloc_map() {
@@ -97,7 +172,12 @@ class LLVMRelocationData : public ZoneObject {
   void SetDeoptReason(int32_t patchpoint_id, Deoptimizer::DeoptReason reason);
   int GetBailoutId(int32_t patchpoint_id);
   void SetBailoutId(int32_t patchpoint_id, int bailout_id);
+  // Lazy bailouts hang off safepoints (calls) rather than deopt patchpoints,
+  // so they are kept apart from is_deopt_.
+  int GetLazyBailoutId(int32_t patchpoint_id);
+  void SetLazyBailoutId(int32_t patchpoint_id, int bailout_id);
   bool IsPatchpointIdDeopt(int32_t patchpoint_id);
+  bool IsPatchpointIdLazyDeopt(int32_t patchpoint_id);
   bool IsPatchpointIdSafepoint(int32_t patchpoint_id);
   bool IsPatchpointIdReloc(int32_t patchpoint_id);
   bool IsPatchpointIdRelocNop(int32_t patchpoint_id);
@@ -109,6 +189,7 @@ class LLVMRelocationData : public ZoneObject {
  private:
   // TODO(llvm): re-think the design and probably use ZoneHashMap
   RelocMap reloc_map_;
+  std::map<intptr_t, uint64_t> index_for_data_;
   int32_t last_patchpoint_id_;
   // FIXME(llvm): not totally sure those belong here:
   // Patchpoint ids belong to one (or more) of the following:
@@ -119,90 +200,95 @@ class LLVMRelocationData : public ZoneObject {
   // FIXME(llvm): make it a ZoneHashMap
   std::map<int32_t, Deoptimizer::DeoptReason> deopt_reasons_;
   std::map<int32_t, size_t> num_safepoint_function_args_;
+  std::map<int32_t, int> lazy_bailout_ids_;
   bool is_transferred_;
   Zone* zone_;
 };
 
-// TODO(llvm): move this class to a separate file. Or, better, 2 files
-class LLVMGranularity final {
+// The MC layer objects needed to decode (and print) x64 machine code.
+// Setting them up costs far more than decoding a single instruction,
+// so they are created once per backend and reused afterwards.
+// TODO(llvm): move to a separate file
+class LLVMDisassembler final {
  public:
-  static LLVMGranularity& getInstance() {
-    static LLVMGranularity instance;
-    return instance;
-  }
+  LLVMDisassembler();
 
-  // TODO(llvm):
-//  ~LLVMGranularity() {
-//    llvm::llvm_shutdown();
-//  }
+  // Returns size of the call instruction starting at pc
+  // or -1 if there is no call instruction there.
+  int CallInstructionSizeAt(Address pc);
+  // Prints the instructions in [start, end) to stderr.
+  void Disass(Address start, Address end);
 
-  LLVMContext& context() { return context_; }
+ private:
+  std::unique_ptr<llvm::MCRegisterInfo> mri_;
+  std::unique_ptr<llvm::MCAsmInfo> mai_;
+  std::unique_ptr<llvm::MCInstrInfo> mii_;
+  std::unique_ptr<llvm::MCSubtargetInfo> sti_;
+  std::unique_ptr<llvm::MCContext> mc_context_;
+  std::unique_ptr<llvm::MCDisassembler> disasm_;
+  std::unique_ptr<const llvm::MCInstrAnalysis> mia_;
+  std::unique_ptr<llvm::MCInstPrinter> inst_printer_;
+
+  DISALLOW_COPY_AND_ASSIGN(LLVMDisassembler);
+};
+
+// Everything a single LLVM compilation needs: the context the IR lives in,
+// the MCJIT engine (and so the TargetMachine) and the memory manager the
+// object code is emitted into. Nothing in here is shared between
+// compilations, so several of them can be in flight at the same time.
+// Setting up an engine is not free, so backends are recycled through
+// LLVMGranularity::AcquireBackend() and LLVMGranularity::ReleaseBackend().
+class LLVMBackend final {
+ public:
+  LLVMBackend()
+      : context_(new LLVMContext()),
+        pass_manager_(nullptr),
+        engine_(nullptr),
+        count_(0),
+        memory_manager_ref_(nullptr),
+        sections_zone_(),
+        disassembler_(nullptr),
+        target_machine_(nullptr),
+        err_str_(),
+        pass_timer_(),
+        pass_times_() {}
+
+  LLVMContext& context() { return *context_; }
   MCJITMemoryManager* memory_manager_ref() { return memory_manager_ref_; }
 
+  // Created on first use.
+  LLVMDisassembler& disassembler() {
+    if (!disassembler_) disassembler_.reset(new LLVMDisassembler());
+    return *disassembler_;
+  }
+
   std::unique_ptr<llvm::Module> CreateModule(std::string name = "") {
     if ("" == name) {
       name = GenerateName();
     }
-    return llvm::make_unique<llvm::Module>(name, context_);
-  }
-
-  void AddModule(std::unique_ptr<llvm::Module> module) {
-    if (!engine_) {
-      std::vector<std::string> machine_attributes;
-      SetMachineAttributes(machine_attributes);
-
-      std::unique_ptr<MCJITMemoryManager> manager =
-          MCJITMemoryManager::Create();
-      memory_manager_ref_ = manager.get(); // non-owning!
-
-      llvm::ExecutionEngine* raw = llvm::EngineBuilder(std::move(module))
-        .setMCJITMemoryManager(std::move(manager))
-        .setErrorStr(&err_str_)
-        .setEngineKind(llvm::EngineKind::JIT)
-        .setMAttrs(machine_attributes)
-        .setMCPU("x86-64")
-        .setRelocationModel(llvm::Reloc::PIC_) // position independent code
-        // A good read on code models can be found here:
-        // eli.thegreenplace.net/2012/01/03/understanding-the-x64-code-models
-        // We use a modified Large code model, which uses rip-relative
-        // addressing for jump tables.
-        .setCodeModel(llvm::CodeModel::Large)
-        .setOptLevel(llvm::CodeGenOpt::Aggressive) // backend opt level
-        .create();
-      engine_ = std::unique_ptr<llvm::ExecutionEngine>(raw);
-      CHECK(engine_);
-    } else {
-      engine_->addModule(std::move(module));
-    }
-    // Finalize each time after adding a new module
-    // (assuming the added module is constructed and won't change)
-    engine_->finalizeObject();
-  }
-
-  void OptimizeFunciton(llvm::Module* module, llvm::Function* function) {
-    // TODO(llvm): 1). Instead of using -O3 optimizations, add the
-    // appropriate passes manually
-    // TODO(llvm): 2). I didn't manage to make use of new PassManagers.
-    // llvm::legacy:: things should probably be removed with time.
-    // But for now even the llvm optimizer (llvm/tools/opt/opt.cpp) uses them.
-    // TODO(llvm): 3). (Probably could be resolved easily when 2. is done)
-    // for now we set up the passes for each module (and each function).
-    // It would be much nicer if we could just set the passes once
-    // and then in OptimizeFunciton() and OptimizeModule() simply run them.
-    llvm::legacy::FunctionPassManager pass_manager(module);
-    pass_manager_builder_.populateFunctionPassManager(pass_manager);
-    pass_manager.doInitialization();
-    pass_manager.run(*function);
-    pass_manager.doFinalization();
-  }
-
-  void OptimizeModule(llvm::Module* module) {
-    // TODO(llvm): see OptimizeFunciton TODOs (ditto)
-    llvm::legacy::PassManager pass_manager;
-    pass_manager_builder_.populateModulePassManager(pass_manager);
-    pass_manager.run(*module);
+    return llvm::make_unique<llvm::Module>(name, *context_);
   }
 
+  void AddModule(std::unique_ptr<llvm::Module> module);
+
+  // To be called once the machine code has been copied into the heap.
+  // Frees the engine together with everything it owns (modules, object
+  // files, the memory manager), resets the zone holding the sections and
+  // starts over with a fresh context, so that the types and constants of
+  // the compiled function don't pile up either.
+  void ReleaseCompiledCode();
+
+  // Runs the passes of the --llvm-opt level on the (single function)
+  // module.
+  void Optimize(llvm::Module* module);
+
+  // With --llvm-time-passes, charges the time since the previous call (or
+  // since Optimize() started) to the pass that has just run.
+  void RecordPassTime(const char* pass_name);
+
+  // Bytes taken by the sections of the code being compiled.
+  size_t sections_size() const { return sections_zone_.allocation_size(); }
+
   uint64_t GetFunctionAddress(int id) {
     DCHECK(engine_);
     return engine_->getFunctionAddress(std::to_string(id));
@@ -212,145 +298,138 @@ class LLVMGranularity final {
     std::cerr << err_str_ << std::endl;
   }
 
-  // TODO(llvm): move to a separate file
-  void Disass(Address start, Address end) {
-    auto triple = x64_target_triple;
-    std::string err;
-    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple,
-                                                                    err);
-    DCHECK(target);
-    std::unique_ptr<llvm::MCRegisterInfo> mri(target->createMCRegInfo(triple));
-    DCHECK(mri);
-    std::unique_ptr<llvm::MCAsmInfo> mai(target->createMCAsmInfo(*mri, triple));
-    DCHECK(mai);
-    std::unique_ptr<llvm::MCInstrInfo> mii(target->createMCInstrInfo());
-    DCHECK(mii);
-    std::string feature_str;
-    const llvm::StringRef cpu = "";
-    std::unique_ptr<llvm::MCSubtargetInfo> sti(
-        target->createMCSubtargetInfo(triple, cpu, feature_str));
-    DCHECK(sti);
-    auto intel_syntax = 1;
-    inst_printer_ = std::unique_ptr<llvm::MCInstPrinter>(
-        target->createMCInstPrinter(llvm::Triple(llvm::Triple::normalize(triple)),
-                                    intel_syntax, *mai, *mii, *mri));
-    inst_printer_->setPrintImmHex(true);
-    DCHECK(inst_printer_);
-    llvm::MCContext mc_context(mai.get(), mri.get(), nullptr);
-    std::unique_ptr<llvm::MCDisassembler> disasm(
-        target->createMCDisassembler(*sti, mc_context));
-    DCHECK(disasm);
-
-
-    auto pos = start;
-    while (pos < end) {
-      llvm::MCInst inst;
-      uint64_t size;
-      auto address = 0;
-
-      llvm::MCDisassembler::DecodeStatus s = disasm->getInstruction(
-          inst /* out */, size /* out */, llvm::ArrayRef<uint8_t>(pos, end),
-          address, llvm::nulls(), llvm::nulls());
-      if (s == llvm::MCDisassembler::Fail) {
-        std::cerr << "disassembler failed at "
-            << reinterpret_cast<void*>(pos) << std::endl;
-        break;
-      }
-      llvm::errs() << pos << "\t";
-      inst_printer_->printInst(&inst, llvm::errs(), "", *sti);
-      llvm::errs() << "\n";
-      pos += size;
-    }
-  }
-
-  int CallInstructionSizeAt(Address pc);
-  std::vector<RelocInfo> Patch(Address, Address, LLVMRelocationData::RelocMap&);
-
-  static const char* x64_target_triple;
  private:
-  LLVMContext context_;
-  llvm::PassManagerBuilder pass_manager_builder_;
+  std::unique_ptr<LLVMContext> context_;
+  // Built on first use and then reused for all the modules, see
+  // BuildPassManager().
+  std::unique_ptr<llvm::legacy::PassManager> pass_manager_;
   std::unique_ptr<llvm::ExecutionEngine> engine_;
-  std::unique_ptr<llvm::MCInstPrinter> inst_printer_;
   int count_;
   MCJITMemoryManager* memory_manager_ref_; // non-owning ptr
+  // Backs all the sections MCJIT allocates for the current compilation.
+  Zone sections_zone_;
+  std::unique_ptr<LLVMDisassembler> disassembler_;
+  // Describes the same target as the engine's one. Only used by the
+  // optimization passes, created on first use.
+  std::unique_ptr<llvm::TargetMachine> target_machine_;
   std::string err_str_;
+  // The --llvm-time-passes timings of the module being optimized. Kept per
+  // backend rather than in LLVM's process-wide pass timers, which mix up
+  // the compilations running at the same time.
+  struct PassTime {
+    const char* name;
+    base::TimeDelta time;
+  };
+  base::ElapsedTimer pass_timer_;
+  std::vector<PassTime> pass_times_;
+
+  llvm::TargetMachine* target_machine();
+  void BuildPassManager();
+  void AddPass(llvm::Pass* pass);
+
+  std::string GenerateName() {
+    return std::to_string(count_++);
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(LLVMBackend);
+};
+
+// Process-wide LLVM state: target initialization, the pool of backends
+// and the MC-level helpers which work on already emitted code.
+// TODO(llvm): move this class to a separate file. Or, better, 2 files
+class LLVMGranularity final {
+ public:
+  static LLVMGranularity& getInstance() {
+    static LLVMGranularity instance;
+    return instance;
+  }
+
+  // TODO(llvm):
+//  ~LLVMGranularity() {
+//    llvm::llvm_shutdown();
+//  }
+
+  // Returns a backend which no other compilation is using.
+  // Safe to call from any thread.
+  LLVMBackend* AcquireBackend();
+  // The backend must not be touched by the caller afterwards.
+  void ReleaseBackend(LLVMBackend* backend);
+
+  // The cpu (see llc -mcpu=help) and the attributes (see llc -mattr=help)
+  // of the target machine, according to --llvm-mcpu.
+  static std::string CPUName();
+  static void SetMachineAttributes(
+      std::vector<std::string>& machine_attributes);
+
+  static const char* x64_target_triple;
+
+  LLVMCodeCache& code_cache() { return code_cache_; }
+ private:
+  // Shared by all the isolates.
+  LLVMCodeCache code_cache_;
+  // Backends not currently owned by any compilation.
+  std::vector<std::unique_ptr<LLVMBackend>> free_backends_;
+  base::Mutex backends_mutex_;
 
   LLVMGranularity()
-      : context_(),
-        pass_manager_builder_(),
-        engine_(nullptr),
-        inst_printer_(nullptr),
-        count_(0),
-        memory_manager_ref_(nullptr),
-        err_str_() {
+      : code_cache_(),
+        free_backends_(),
+        backends_mutex_() {
     llvm::InitializeNativeTarget();
     llvm::InitializeNativeTargetAsmPrinter();
     llvm::InitializeNativeTargetAsmParser();
     llvm::InitializeNativeTargetDisassembler();
 //    llvm::initializeCodeGen(*llvm::PassRegistry::getPassRegistry());
-    pass_manager_builder_.OptLevel = 3; // -O3
-  }
-
-  std::string GenerateName() {
-    return std::to_string(count_++);
-  }
-
-  void SetMachineAttributes(std::vector<std::string>& machine_attributes) {
-    // TODO(llvm): add desired machine attributes. See llc -mattr=help
-    // FIXME(llvm): for each attribute see, if the corresponding cpu
-    // feature is supported.
-    for (auto attr : {
-      "sse","sse2","sse4.1","sse4.2",
-      "sse4a", "ssse3", "aes", "avx", "avx2" }) {
-      machine_attributes.push_back(attr);
-    }
   }
 
   DISALLOW_COPY_AND_ASSIGN(LLVMGranularity);
 };
 
-struct Types final : public AllStatic {
-   static llvm::Type* smi;
-   static llvm::Type* ptr_smi;
-   static llvm::Type* tagged;
-   static llvm::PointerType* ptr_tagged;
-
-   static llvm::Type* i8;
-   static llvm::Type* i16;
-   static llvm::Type* i32;
-   static llvm::Type* i64;
-   static llvm::Type* float32;
-   static llvm::Type* float64;
-
-   static llvm::PointerType* ptr_i8;
-   static llvm::PointerType* ptr_i16;
-   static llvm::PointerType* ptr_i32;
-   static llvm::PointerType* ptr_i64;
-   static llvm::PointerType* ptr_float32;
-   static llvm::PointerType* ptr_float64;
-
-  static void Init(llvm::IRBuilder<>* ir_builder) {
-    i8 = ir_builder->getInt8Ty();
-    i16 = ir_builder->getInt16Ty();
-    i32 = ir_builder->getInt32Ty();
-    i64 = ir_builder->getInt64Ty();
-    float32 = ir_builder->getFloatTy();
-    float64 = ir_builder->getDoubleTy();
+// The types LLVMChunkBuilder builds the function with. They belong to the
+// context of the compilation's backend, so every builder has its own
+// (compilations run on several threads, each in its own context).
+struct Types final {
+  explicit Types(llvm::LLVMContext& context) {
+    i8 = llvm::Type::getInt8Ty(context);
+    i16 = llvm::Type::getInt16Ty(context);
+    i32 = llvm::Type::getInt32Ty(context);
+    i64 = llvm::Type::getInt64Ty(context);
+    float32 = llvm::Type::getFloatTy(context);
+    float64 = llvm::Type::getDoubleTy(context);
 
     auto address_space = 0;
-    ptr_i8 = ir_builder->getInt8PtrTy();
-    ptr_i16 = i16->getPointerTo();
-    ptr_i32 = llvm::PointerType::get(ir_builder->getInt32Ty(), address_space);
-    ptr_i64 = llvm::PointerType::get(ir_builder->getInt64Ty(), address_space);
-    ptr_float32 = llvm::PointerType::get(ir_builder->getFloatTy(), address_space);
-    ptr_float64 = llvm::PointerType::get(ir_builder->getDoubleTy(),
-                                         address_space);
+    ptr_i8 = llvm::PointerType::get(i8, address_space);
+    ptr_i16 = llvm::PointerType::get(i16, address_space);
+    ptr_i32 = llvm::PointerType::get(i32, address_space);
+    ptr_i64 = llvm::PointerType::get(i64, address_space);
+    ptr_float32 = llvm::PointerType::get(float32, address_space);
+    ptr_float64 = llvm::PointerType::get(float64, address_space);
     tagged = ptr_i8;
     ptr_tagged = ptr_i8->getPointerTo();
     smi = i64;
     ptr_smi = smi->getPointerTo();
   }
+
+  llvm::Type* ForRepresentation(Representation r) const;
+
+  llvm::Type* smi;
+  llvm::Type* ptr_smi;
+  llvm::Type* tagged;
+  llvm::PointerType* ptr_tagged;
+
+  llvm::Type* i8;
+  llvm::Type* i16;
+  llvm::Type* i32;
+  llvm::Type* i64;
+  llvm::Type* float32;
+  llvm::Type* float64;
+
+  llvm::PointerType* ptr_i8;
+  llvm::PointerType* ptr_i16;
+  llvm::PointerType* ptr_i32;
+  llvm::PointerType* ptr_i64;
+  llvm::PointerType* ptr_float32;
+  llvm::PointerType* ptr_float64;
 };
 
 class LLVMEnvironment final : public ZoneObject {
@@ -377,6 +456,8 @@ class LLVMEnvironment final : public ZoneObject {
         is_tagged_(value_count, zone),
         is_uint32_(value_count, zone),
         is_double_(value_count, zone),
+        is_call_result_(value_count, zone),
+        is_gc_pointer_(value_count, zone),
         object_mapping_(0, zone),
         outer_(outer),
         entry_(entry),
@@ -416,6 +497,32 @@ class LLVMEnvironment final : public ZoneObject {
     return is_double_.Contains(index);
   }
 
+  // The value at index is the result of the call this environment is
+  // a lazy bailout for. It is not in the stack map record (it doesn't
+  // exist before the call returns), the deoptimizer finds it in rax.
+  void MarkCallResultAt(int index) {
+    is_call_result_.Add(index, zone());
+  }
+
+  bool IsCallResultAt(int index) const {
+    return is_call_result_.Contains(index);
+  }
+
+  // The value at index is a gc pointer. In a lazy bailout the GC may have
+  // moved it during the call, so the deoptimizer must read it from where
+  // the GC has updated it (see LLVMChunk::RelocatedLocation).
+  void MarkGcPointerAt(int index) {
+    is_gc_pointer_.Add(index, zone());
+  }
+
+  bool IsGcPointerAt(int index) const {
+    return is_gc_pointer_.Contains(index);
+  }
+
+  // Same frames with the same llvm values, i.e. deoptimizing to either
+  // of the environments has the same effect.
+  bool IsEquivalentTo(const LLVMEnvironment* other) const;
+
   void Register(int deoptimization_index,
                 int translation_index,
                 int pc_offset) {
@@ -449,6 +556,8 @@ class LLVMEnvironment final : public ZoneObject {
   GrowableBitVector is_tagged_;
   GrowableBitVector is_uint32_;
   GrowableBitVector is_double_;
+  GrowableBitVector is_call_result_;
+  GrowableBitVector is_gc_pointer_;
 
   // Map with encoded information about materialization_marker operands.
   ZoneList<uint32_t> object_mapping_;
@@ -513,13 +622,41 @@ class LLVMChunk final : public LowChunk {
       masm_(info->isolate(), nullptr, 0),
       target_index_for_ppid_(),
       deopt_target_offset_for_ppid_(),
-      inlined_functions_(1, info->zone()) {}
+      inlined_functions_(1, info->zone()),
+      backend_(nullptr),
+      module_(nullptr),
+      function_(nullptr),
+      number_of_pointers_(-1),
+      code_desc_(),
+      stackmaps_section_(),
+      reloc_records_section_(),
+      osr_pc_offset_(-1),
+      phase_stats_(8, info->zone()) {}
 
   using PpIdToIndexMap = std::map<int32_t, uint32_t>;
   using PpIdToOffsetMap = std::map<int32_t, std::ptrdiff_t>;
 
+  // Lowers the (already optimized) graph to LLVM IR. IR construction
+  // allocates code stubs, cells and deoptimization entries, so this
+  // has to run on the main thread.
   static LLVMChunk* NewChunk(HGraph *graph);
 
+  // Whether NewChunk() emits everything the flags ask for.
+  static bool SupportsFlags();
+
+  // Returns the first instruction of the (already optimized) graph which
+  // is on LLVM_UNSUPPORTED_INSTRUCTION_LIST, or which NewChunk() can't
+  // lower in the case at hand, or nullptr if it can lower the whole graph.
+  // A quick check only, NewChunk() returns NULL for whatever it misses.
+  static HInstruction* FindUnsupportedInstruction(HGraph* graph);
+
+  // Runs the statepoint and optimization passes over the module built by
+  // NewChunk() and emits machine code with MCJIT, unless the LLVMCodeCache
+  // already has the code for the same IR. Does not touch the V8 heap
+  // so it is safe to call from the concurrent recompilation thread.
+  void EmitMachineCode();
+
+  // Installs the machine code emitted by EmitMachineCode() into the heap.
   Handle<Code> Codegen() override;
 
   void set_llvm_function_id(int id) { llvm_function_id_ = id; }
@@ -550,12 +687,61 @@ class LLVMChunk final : public LowChunk {
   }
   int GetParameterStackSlot(int index) const;
 
+  LLVMBackend* backend() const { return backend_; }
+  void set_backend(LLVMBackend* backend) { backend_ = backend; }
+  // Frees what's left of the compilation in the backend and returns it to
+  // the pool. Done by Codegen(), but can be called any time before (the
+  // chunk, being a zone object, is never destructed).
+  void ReleaseBackend();
+
+  // See LLVMPhase.
+  void AddPhaseStats(const char* name, base::TimeDelta time, size_t size,
+                     size_t process_heap_growth);
+  // Prints the phases of this compilation for --trace-opt.
+  void PrintPhaseStats();
+
+  void set_module(std::unique_ptr<llvm::Module> module,
+                  llvm::Function* function,
+                  int number_of_pointers) {
+    module_ = std::move(module);
+    function_ = function;
+    number_of_pointers_ = number_of_pointers;
+  }
+
  private:
   static const int kStackSlotSize = kPointerSize;
   static const int kPhonySpillCount = 3; // rbp, rsi, rdi
 
+  struct PhaseStats {
+    const char* name;
+    base::TimeDelta time;
+    size_t size;
+    size_t process_heap_growth;
+  };
+
   static int SpilledCount(const StackMaps& stackmaps);
 
+  // Returns the offset of the return address of the call a safepoint
+  // record has been made for. That's where the safepoint is looked up
+  // (and where Deoptimizer::PatchCodeForDeoptimization() patches in
+  // the call to the lazy deoptimization entry).
+  unsigned CallReturnOffset(const StackMaps::Record& record,
+                            Address instruction_start);
+
+  // The MD5 digest of the IR of the module (with the names which differ
+  // between compilations replaced) and the options the code is generated
+  // with.
+  std::string CodeCacheKey();
+  void DumpPointerValues();
+  // Merges and hoists the embedded objects (see
+  // LLVMChunkBuilder::RecordRelocInfo()) while that's still safe.
+  void MergeEmbeddedObjects();
+  void PlaceStatePoints();
+  void RewriteStatePoints();
+  // Keeps Optimize() from moving the embedded objects across statepoints.
+  void PinEmbeddedObjects();
+  void Optimize(); // invoke llvm transformation passes for the function
+
   std::vector<RelocInfo> SetUpRelativeCalls(Address start,
                                             const StackMaps& stackmaps);
   StackMaps GetStackMaps();
@@ -563,11 +749,29 @@ class LLVMChunk final : public LowChunk {
   void EmitSafepointTable(Assembler* code_desc,
                           StackMaps& stackmaps,
                           Address instruction_start);
+  // Emits the code Generate_OnStackReplacement() jumps to (right after the
+  // safepoint table, so it ends up outside of the code MCJIT has emitted).
+  // It saves the slots of the unoptimized frame into a buffer, tears the
+  // frame down and enters the function as if it has just been called,
+  // passing the buffer in rbx. Adds the reloc info for the buffer.
+  void EmitOsrEntry(Assembler* assembler, const CodeDesc& code_desc,
+                    std::vector<RelocInfo>* reloc_info);
+  // Embedded object and cell reloc infos, one per record found in
+  // the LLVMRelocationData::kRelocRecordsSectionName section.
+  std::vector<RelocInfo> GetRelocInfoFromRecords(CodeDesc& code_desc);
   Vector<byte> GetFullRelocationInfo(
       CodeDesc& code_desc,
       const std::vector<RelocInfo>& reloc_data_from_patchpoints);
+  // Gives the lazy bailouts bailout ids in the order of their pcs, which is
+  // what Deoptimizer::PatchCodeForDeoptimization() expects.
+  void OrderLazyBailoutsByPc(const StackMaps& stackmaps,
+                             Address instruction_start);
   // Returns translation index of the newly generated translation
   int WriteTranslationFor(LLVMEnvironment* env, const StackMaps& stackmaps);
+  // The location of a gc pointer among the gc pointers of a statepoint
+  // record, i.e. the slot the GC visits (and updates) during the call.
+  static StackMaps::Location RelocatedLocation(
+      const StackMaps::Record& record, const StackMaps::Location& location);
   void WriteTranslation(LLVMEnvironment* environment,
                         Translation* translation,
                         const StackMaps& stackmaps,
@@ -598,6 +802,50 @@ class LLVMChunk final : public LowChunk {
   PpIdToOffsetMap deopt_target_offset_for_ppid_;
   // TODO(llvm): hoist to base class.
   ZoneList<Handle<SharedFunctionInfo>> inlined_functions_;
+  // Borrowed from the pool by NewChunk() and given back by ReleaseBackend().
+  LLVMBackend* backend_;
+  // Owned between NewChunk() and EmitMachineCode(),
+  // then ownership goes to the execution engine (MCJIT).
+  std::unique_ptr<llvm::Module> module_;
+  llvm::Function* function_;
+  int number_of_pointers_;
+  // Captured right after MCJIT has finalized our module
+  // (or copied out of the LLVMCodeCache).
+  CodeDesc code_desc_;
+  Vector<byte> stackmaps_section_;
+  Vector<byte> reloc_records_section_;
+  // See EmitOsrEntry(), -1 if the code is not for OSR.
+  int osr_pc_offset_;
+  // Only collected with --trace-opt.
+  ZoneList<PhaseStats> phase_stats_;
+};
+
+// Times a phase of building, compiling or installing the LLVM code and
+// measures the memory it takes: what the phase allocates in the compilation
+// zone and what gets reported with AddAllocatedBytes() (e.g. the sections
+// MCJIT emits). The results go to --hydrogen-stats (next to the Hydrogen
+// phases) and to the per-function summary of --trace-opt. On glibc the
+// latter also shows the growth of the process-wide C++ heap (where LLVM
+// keeps the IR, the analyses and the machine code structures), which can't
+// be told apart from what the other threads allocate.
+class LLVMPhase final BASE_EMBEDDED {
+ public:
+  LLVMPhase(const char* name, LLVMChunk* chunk);
+  ~LLVMPhase();
+
+  void AddAllocatedBytes(size_t bytes) { extra_allocated_bytes_ += bytes; }
+
+ private:
+  const char* name_;
+  LLVMChunk* chunk_;
+  size_t zone_start_allocation_size_;
+#if V8_LIBC_GLIBC
+  size_t process_heap_start_size_;
+#endif
+  size_t extra_allocated_bytes_;
+  base::ElapsedTimer timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(LLVMPhase);
 };
 
 class LLVMChunkBuilder final : public LowChunkBuilderBase {
@@ -610,22 +858,29 @@ class LLVMChunkBuilder final : public LowChunkBuilderBase {
         module_(nullptr),
         function_(nullptr),
         llvm_ir_builder_(nullptr),
+        types_(nullptr),
         deopt_data_(llvm::make_unique<LLVMDeoptData>(info->zone())),
         reloc_data_(nullptr),
         pending_pushed_args_(4, info->zone()),
-        osr_preserved_values_(4, info->zone()),
+        deopt_blocks_(8, info->zone()),
+        deopt_exits_(4, info->zone()),
         emit_debug_code_(FLAG_debug_code),
         volatile_zero_address_(nullptr),
         global_receiver_(nullptr),
+        call_result_(nullptr),
+        lazy_bailout_redoes_instruction_(false),
         pointers_(),
         number_of_pointers_(-1) {
     reloc_data_ = new(zone()) LLVMRelocationData(zone());
   }
   ~LLVMChunkBuilder() {}
 
-  static llvm::Type* GetLLVMType(Representation r);
+  llvm::Type* GetLLVMType(Representation r) const {
+    return types_->ForRepresentation(r);
+  }
 
   LLVMChunk* chunk() const { return static_cast<LLVMChunk*>(chunk_); };
+  LLVMBackend* backend() const { return chunk()->backend(); }
   void set_emit_degug_code(bool v) { emit_debug_code_ = v; }
   bool emit_debug_code() { return emit_debug_code_; }
   LLVMChunkBuilder& Build();
@@ -635,12 +890,20 @@ class LLVMChunkBuilder final : public LowChunkBuilderBase {
   // For that reason our phis are not LLVM-compliant right after phi resolution.
   LLVMChunkBuilder& NormalizePhis();
   LLVMChunkBuilder& GiveNamesToPointerValues();
-  LLVMChunkBuilder& PlaceStatePoints();
-  LLVMChunkBuilder& RewriteStatePoints();
-  LLVMChunkBuilder& Optimize(); // invoke llvm transformation passes for the function
+  // Hands the module over to the chunk. LLVM passes and MCJIT
+  // are run later by LLVMChunk::EmitMachineCode().
   LLVMChunk* Create();
 
+  // The calling convention of calls through the descriptor,
+  // or -1 if there is none (yet).
+  static llvm::CallingConv::ID GetCallingConv(
+      CallInterfaceDescriptor descriptor);
+
   LLVMEnvironment* AssignEnvironment();
+  // Returns the environment the current instruction lazily bails out to
+  // if the code gets deoptimized during the call it's about to make,
+  // or nullptr if there is no lazy bailout for the call.
+  LLVMEnvironment* AssignLazyEnvironment();
   LLVMEnvironment* CreateEnvironment(
       HEnvironment* hydrogen_env, int* argument_index_accumulator,
       ZoneList<HValue*>* objects_to_materialize);
@@ -655,22 +918,55 @@ class LLVMChunkBuilder final : public LowChunkBuilderBase {
 #define DECLARE_DO(type) void Do##type(H##type* node);
   HYDROGEN_CONCRETE_INSTRUCTION_LIST(DECLARE_DO)
 #undef DECLARE_DO
-  static const uintptr_t kExtFillingValue = 0xabcdbeef;
   static const char* kGcStrategyName;
   static const std::string kPointersPrefix;
 
  private:
+  // A deopt block (and so a patchpoint, a stack map record and
+  // a translation) which is shared by the checks with equivalent
+  // environments in the same Hydrogen block.
+  struct DeoptExit {
+    LLVMEnvironment* environment;
+    Deoptimizer::DeoptReason reason;
+    llvm::BasicBlock* block;
+  };
+
+  // Disjoint kinds of heap memory for TBAA, mirroring the portions
+  // HObjectAccess uses for Hydrogen's own side effect tracking.
+  enum TbaaKind {
+    kTbaaMap,
+    kTbaaLength,
+    kTbaaElementsPointer,
+    kTbaaInobjectField,
+    kTbaaPropertiesPointer,  // A kind of in-object field.
+    kTbaaBackingStoreField,
+    kTbaaHeapNumberValue,
+    kTbaaFixedArraySlot,
+    kTbaaFixedDoubleArraySlot,
+    kTbaaTypedArrayData
+  };
+
   static const int kSmiShift = kSmiTagSize + kSmiShiftSize;
   static const int kMaxCallSequenceLen = 16; // FIXME(llvm): find out max size.
+  // HApplyArguments gets a call site per argument count up to this one
+  // and goes through the runtime for longer argument lists.
+  static const int kMaxApplyArguments = 8;
+  // Branch weights for the paths we expect (almost) never to be taken.
+  static const uint32_t kLikelyBranchWeight = 2000;
+  static const uint32_t kUnlikelyBranchWeight = 1;
 
   static llvm::CmpInst::Predicate TokenToPredicate(Token::Value op,
                                                    bool is_unsigned,
                                                    bool is_double = false);
   static bool HasTaggedValue(HValue* value);
+  static TbaaKind TbaaKindFor(HObjectAccess access);
 
   void GetAllEnvironmentValues(LLVMEnvironment* environment,
                                std::vector<llvm::Value*>& mapped_values);
-  void CreateSafepointPollFunction();
+  llvm::BasicBlock* FindDeoptExit(LLVMEnvironment* environment,
+                                  Deoptimizer::DeoptReason deopt_reason);
+  llvm::BasicBlock* EmitDeoptExit(LLVMEnvironment* environment,
+                                  Deoptimizer::DeoptReason deopt_reason);
   void DoBasicBlock(HBasicBlock* block, HBasicBlock* next_block);
   void VisitInstruction(HInstruction* current);
   void PatchReceiverToGlobalProxy();
@@ -678,6 +974,7 @@ class LLVMChunkBuilder final : public LowChunkBuilderBase {
   void DoPhi(HPhi* phi);
   void ResolvePhis();
   void ResolvePhis(HBasicBlock* block);
+  void SinkDeoptBlocks();
   void CreateVolatileZero();
   llvm::Value* GetVolatileZero();
   llvm::Value* BuildFastArrayOperand(HValue*, llvm::Value*,
@@ -724,6 +1021,12 @@ class LLVMChunkBuilder final : public LowChunkBuilderBase {
   llvm::Value* LoadFieldOperand(llvm::Value* base,
                                 int offset,
                                 const char* name = "");
+  // Attach the facts Hydrogen has proven about the loaded value
+  // (the range of a string length, non-null-ness) to the load as metadata.
+  void AnnotateLoad(llvm::LoadInst* load, HValue* instr);
+  void AnnotateMapLoad(llvm::LoadInst* load);
+  llvm::MDNode* TbaaTag(TbaaKind kind);
+  void SetTbaa(llvm::Value* load_or_store, TbaaKind kind);
   llvm::Value* ValueFromSmi(Smi* smi);
   llvm::Value* CreateConstant(HConstant* instr, HBasicBlock* block = NULL);
   llvm::Value* ConstructAddress(llvm::Value* base, int64_t offset);
@@ -750,11 +1053,15 @@ class LLVMChunkBuilder final : public LowChunkBuilderBase {
   llvm::Value* LoadAllocationTopHelper(AllocationFlags flags);
   void UpdateAllocationTopHelper(llvm::Value* result_end, AllocationFlags flags);
   void DirtyHack(int arg_count);
-  llvm::CallingConv::ID GetCallingConv(CallInterfaceDescriptor descriptor);
   llvm::Value* CallRuntime(const Runtime::Function*);
   llvm::Value* CallRuntimeViaId(Runtime::FunctionId id);
   llvm::Value* CallRuntimeFromDeferred(Runtime::FunctionId id, llvm::Value* context, std::vector<llvm::Value*>);
   llvm::Value* GetContext();
+  // Points to the slots of the unoptimized frame on OSR entry.
+  llvm::Value* GetOsrBuffer();
+  // Our rbp. The arguments we've been called with are right above it,
+  // unless the arguments adaptor has been in between.
+  llvm::Value* GetFramePointer();
   llvm::Value* GetNan();
   llvm::Value* LoadRoot(Heap::RootListIndex index);
   llvm::Value* CompareRoot(llvm::Value* val, Heap::RootListIndex index,
@@ -803,11 +1110,18 @@ class LLVMChunkBuilder final : public LowChunkBuilderBase {
                                  std::vector<llvm::Value*>& function_args,
                                  std::vector<llvm::Value*>& live_values,
                                  int covering_nop_size = kMaxCallSequenceLen);
+  // The values of lazy_env (if any) become the deopt arguments
+  // of the statepoint. Returns gc.result (or the statepoint token
+  // for calls returning void).
   llvm::Value* CallStatePoint(int32_t stackmap_id,
                               llvm::Value* target_function,
                               llvm::CallingConv::ID calling_conv,
                               std::vector<llvm::Value*>& function_args,
-                              int covering_nop_size);
+                              int covering_nop_size,
+                              llvm::Type* return_type,
+                              LLVMEnvironment* lazy_env = nullptr);
+  void RegisterLazyBailout(LLVMEnvironment* lazy_env, int32_t stackmap_id);
+  void EmitLazyDeoptPadding();
   void DoMathAbs(HUnaryMathOperation* instr);
   void DoIntegerMathAbs(HUnaryMathOperation* instr);
   void DoSmiMathAbs(HUnaryMathOperation* instr);
@@ -826,7 +1140,6 @@ class LLVMChunkBuilder final : public LowChunkBuilderBase {
   int ArgumentStackSlotsForCFunctionCall(int num_arguments);
   llvm::Value* CallCFunction(ExternalReference function, std::vector<llvm::Value*>, int num_arguments);
   llvm::Value* LoadAddress(ExternalReference);
-  void DumpPointerValues();
   llvm::Value* CmpInstanceType(llvm::Value* value, InstanceType type,
                                llvm::CmpInst::Predicate pred = llvm::CmpInst::ICMP_EQ);
   // TODO(llvm): probably pull these up to LowChunkBuilderBase
@@ -839,15 +1152,25 @@ class LLVMChunkBuilder final : public LowChunkBuilderBase {
   // Not to be used for fetching the actual native code,
   // since the corresponding methods are deprecated.
   llvm::Function* function_;
-  llvm::Function* safepoint_poll_;
   std::unique_ptr<llvm::IRBuilder<>> llvm_ir_builder_;
+  std::unique_ptr<Types> types_;
   std::unique_ptr<LLVMDeoptData> deopt_data_;
   LLVMRelocationData* reloc_data_;
   ZoneList<llvm::Value*> pending_pushed_args_;
-  ZoneList<llvm::Value*> osr_preserved_values_;
+  // Blocks ending in an eager deopt, see SinkDeoptBlocks().
+  ZoneList<llvm::BasicBlock*> deopt_blocks_;
+  // The eager deopts emitted in current_block_ so far, see FindDeoptExit().
+  ZoneList<DeoptExit> deopt_exits_;
   bool emit_debug_code_;
   llvm::Value* volatile_zero_address_;
   llvm::Value* global_receiver_;
+  // The instruction AssignLazyEnvironment() is building the environment for
+  // (its value is only produced by the call the environment is attached to).
+  HValue* call_result_;
+  // Set around the calls an instruction on LLVM_LAZY_BAILOUT_INSTRUCTION_LIST
+  // makes before its own (e.g. to allocate), which have to bail out lazily
+  // to the state before the instruction.
+  bool lazy_bailout_redoes_instruction_;
   // TODO(llvm): choose more appropriate data structure (maybe in the zone).
   // Or even some fancy lambda to pass to createAppendLivePointersToSafepoints.
   std::set<llvm::Value*> pointers_;
@@ -0,0 +1,81 @@
+// Copyright 2015 ISP RAS. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "llvm-code-cache.h"
+
+#include <cstring>
+
+#include "src/flags.h"
+#include "src/v8memory.h"
+
+namespace v8 {
+namespace internal {
+
+static byte* CopyToZone(const std::vector<byte>& bytes, Zone* zone) {
+  byte* copy = zone->NewArray<byte>(bytes.size());
+  if (!bytes.empty()) memcpy(copy, bytes.data(), bytes.size());
+  return copy;
+}
+
+bool LLVMCodeCache::Lookup(const std::string& key, Zone* zone,
+                           CodeDesc* code_desc, Vector<byte>* stackmaps,
+                           Vector<byte>* reloc_records) {
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return false;
+  const Entry& entry = it->second;
+
+  int code_size = static_cast<int>(entry.code.size());
+  code_desc->buffer = CopyToZone(entry.code, zone);
+  code_desc->buffer_size = code_size;
+  code_desc->instr_size = code_size;
+  code_desc->reloc_size = 0;
+  code_desc->origin = nullptr;
+
+  *stackmaps = Vector<byte>(CopyToZone(entry.stackmaps, zone),
+                            static_cast<int>(entry.stackmaps.size()));
+
+  int records_size =
+      static_cast<int>(entry.reloc_record_offsets.size()) * kInt64Size;
+  byte* records = zone->NewArray<byte>(static_cast<size_t>(records_size));
+  for (size_t i = 0; i < entry.reloc_record_offsets.size(); i++) {
+    Memory::uint64_at(records + i * kInt64Size) = reinterpret_cast<uint64_t>(
+        code_desc->buffer + entry.reloc_record_offsets[i]);
+  }
+  *reloc_records = Vector<byte>(records, records_size);
+  return true;
+}
+
+void LLVMCodeCache::Insert(const std::string& key, const CodeDesc& code_desc,
+                           Vector<byte> stackmaps,
+                           Vector<byte> reloc_records) {
+  if (FLAG_llvm_code_cache_size <= 0) return;
+  Entry entry;
+  entry.code.assign(code_desc.buffer,
+                    code_desc.buffer + code_desc.instr_size);
+  entry.stackmaps.assign(stackmaps.start(),
+                         stackmaps.start() + stackmaps.length());
+  DCHECK_EQ(reloc_records.length() % kInt64Size, 0);
+  for (int offset = 0; offset < reloc_records.length();
+       offset += kInt64Size) {
+    Address record = reinterpret_cast<Address>(
+        Memory::uint64_at(reloc_records.start() + offset));
+    DCHECK(code_desc.buffer <= record &&
+           record <= code_desc.buffer + code_desc.instr_size);
+    entry.reloc_record_offsets.push_back(
+        static_cast<int>(record - code_desc.buffer));
+  }
+
+  base::LockGuard<base::Mutex> lock_guard(&mutex_);
+  // Another thread may have compiled the same function meanwhile.
+  if (entries_.count(key)) return;
+  while (order_.size() >= static_cast<size_t>(FLAG_llvm_code_cache_size)) {
+    entries_.erase(order_.front());
+    order_.pop_front();
+  }
+  entries_.emplace(key, std::move(entry));
+  order_.push_back(key);
+}
+
+} }  // namespace v8::internal
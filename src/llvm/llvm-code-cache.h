@@ -0,0 +1,62 @@
+// Copyright 2015 ISP RAS. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef V8_LLVM_CODE_CACHE_H_
+#define V8_LLVM_CODE_CACHE_H_
+
+#include "src/base/platform/mutex.h"
+#include "src/globals.h"
+#include "src/vector.h"
+#include "src/zone.h"
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace v8 {
+namespace internal {
+
+// Machine code MCJIT has emitted, keyed by a digest of the IR it has been
+// emitted from (see LLVMChunk::CodeCacheKey()). The IR refers to embedded
+// objects by their index in the chunk's LLVMRelocationData (see
+// LLVMChunkBuilder::RecordRelocInfo()), so equal keys mean equal code up to
+// those objects, which every chunk binds anew when installing the code.
+// Entries are kept in the state MCJIT left them in, i.e. before
+// LLVMChunk::Codegen() has patched calls or the embedded objects in.
+// Process-wide and safe to use from any thread.
+class LLVMCodeCache final {
+ public:
+  LLVMCodeCache() : entries_(), order_(), mutex_() {}
+
+  // On a hit copies the code, the stackmaps section and the reloc records
+  // section into the zone and returns true. The reloc records (absolute
+  // addresses, see LLVMRelocationData::kRelocRecordsSectionName) point into
+  // the copy of the code.
+  bool Lookup(const std::string& key, Zone* zone, CodeDesc* code_desc,
+              Vector<byte>* stackmaps, Vector<byte>* reloc_records);
+
+  // Must be called before anything has patched the code.
+  // Evicts the oldest entry if there are --llvm-code-cache-size of them.
+  void Insert(const std::string& key, const CodeDesc& code_desc,
+              Vector<byte> stackmaps, Vector<byte> reloc_records);
+
+ private:
+  struct Entry {
+    std::vector<byte> code;
+    std::vector<byte> stackmaps;
+    // Relative to the start of the code.
+    std::vector<int> reloc_record_offsets;
+  };
+
+  std::unordered_map<std::string, Entry> entries_;
+  // Keys in the order of insertion.
+  std::deque<std::string> order_;
+  base::Mutex mutex_;
+
+  DISALLOW_COPY_AND_ASSIGN(LLVMCodeCache);
+};
+
+} }  // namespace v8::internal
+#endif  // V8_LLVM_CODE_CACHE_H_
@@ -4,6 +4,7 @@
 
 #include "mcjit-memory-manager.h"
 #include "src/allocation.h"
+#include "src/base/bits.h"
 #include "src/base/logging.h"
 #include "src/base/platform/platform.h"
 // FIXME(llvm): we only need IntHelper from there. Move it to a separate file.
@@ -16,29 +17,34 @@
 namespace v8 {
 namespace internal {
 
-std::unique_ptr<MCJITMemoryManager> MCJITMemoryManager::Create() {
-  return llvm::make_unique<MCJITMemoryManager>();
+std::unique_ptr<MCJITMemoryManager> MCJITMemoryManager::Create(Zone* zone) {
+  return llvm::make_unique<MCJITMemoryManager>(zone);
 }
 
-MCJITMemoryManager::MCJITMemoryManager()
-  : allocated_code_(1),
-    allocated_data_(1),
-    stackmaps_(1) {}
+MCJITMemoryManager::MCJITMemoryManager(Zone* zone)
+  : zone_(zone),
+    allocated_code_(1),
+    stackmaps_(1),
+    reloc_records_() {}
 
-MCJITMemoryManager::~MCJITMemoryManager() {
-  for (auto it = allocated_code_.begin(); it != allocated_code_.end(); ++it) {
-    DeleteArray(it->buffer);
-  }
-  for (auto it = allocated_data_.begin(); it != allocated_data_.end(); ++it) {
-    DeleteArray(*it);
-  }
-}
+// The sections themselves belong to the zone.
+MCJITMemoryManager::~MCJITMemoryManager() {}
 
 void MCJITMemoryManager::notifyObjectLoaded(llvm::ExecutionEngine* engine,
                                             const llvm::object::ObjectFile &) {
 //  UNIMPLEMENTED();
 }
 
+byte* MCJITMemoryManager::Allocate(uintptr_t size, unsigned alignment) {
+  // The alignment is a power of 2 (or 0 if the section doesn't care)
+  // and may well exceed the zone's one, so leave room to align the start.
+  if (alignment == 0) alignment = 1;
+  CHECK(base::bits::IsPowerOfTwo32(alignment));
+  uintptr_t raw = reinterpret_cast<uintptr_t>(
+      zone_->New(static_cast<size_t>(size) + alignment - 1));
+  return reinterpret_cast<byte*>(RoundUp(raw, alignment));
+}
+
 byte* MCJITMemoryManager::allocateCodeSection(uintptr_t size,
                                               unsigned alignment,
                                               unsigned section_id,
@@ -50,10 +56,7 @@ byte* MCJITMemoryManager::allocateCodeSection(uintptr_t size,
 #endif
   // Note: we don't care for the executable attribute here.
   // Because before being executed the code gets copied to another place.
-  byte* buffer = NewArray<byte>(size);
-  CHECK(alignment == 0 ||
-        (reinterpret_cast<uintptr_t>(buffer) &
-        static_cast<uintptr_t>(alignment - 1)) == 0);
+  byte* buffer = Allocate(size, alignment);
   CodeDesc desc;
   desc.buffer = buffer;
   desc.buffer_size = IntHelper::AsInt(size);
@@ -75,21 +78,19 @@ byte* MCJITMemoryManager::allocateDataSection(uintptr_t size,
       << section_id << " size == "
       << size << std::endl;
 #endif
-  CHECK(alignment <= base::OS::AllocateAlignment());
   // TODO(llvm): handle is_readonly
-  if (section_name.equals(".got")) {
-      UNIMPLEMENTED(); // TODO(llvm): call allocateCodeSection
-                       // as far as you understand what's happening
-  }
-  // FIXME(llvm): who frees that memory?
-  // The destructor here does. Not sure if it is supposed to.
-
-  // FIXME(llvm): this is wrong understanding of the alignment parameter.
-  // see allocateCodeSection.
-  byte* buffer = NewArray<byte>(RoundUp(size, alignment));
-  allocated_data_.Add(buffer);
+  // Nothing is executed from here, so the .got (which RuntimeDyld creates
+  // for GOT-relative relocations of the large code model) is just data too.
+  // FIXME(llvm): the code which goes through it wouldn't survive being
+  // copied into the heap anyway (neither would the table, see
+  // LLVMBackend::ReleaseCompiledCode).
+  byte* buffer = Allocate(size, alignment);
   if (section_name.equals(".llvm_stackmaps"))
-    stackmaps_.Add(buffer);
+    stackmaps_.Add(Vector<byte>(buffer, IntHelper::AsInt(size)));
+  if (section_name.equals(LLVMRelocationData::kRelocRecordsSectionName)) {
+    DCHECK(reloc_records_.is_empty());
+    reloc_records_ = Vector<byte>(buffer, IntHelper::AsInt(size));
+  }
 #ifdef DEBUG
   std::cerr << reinterpret_cast<void*>(buffer) << std::endl;
 #endif
@@ -97,6 +98,21 @@ byte* MCJITMemoryManager::allocateDataSection(uintptr_t size,
   return buffer;
 }
 
+CodeDesc MCJITMemoryManager::CodeStartingAt(byte* address) {
+  for (auto it = allocated_code_.begin(); it != allocated_code_.end(); ++it) {
+    if (address >= it->buffer && address < it->buffer + it->instr_size) {
+      int offset = static_cast<int>(address - it->buffer);
+      CodeDesc desc = *it;
+      desc.buffer = address;
+      desc.buffer_size -= offset;
+      desc.instr_size -= offset;
+      return desc;
+    }
+  }
+  UNREACHABLE();
+  return CodeDesc();
+}
+
 bool MCJITMemoryManager::finalizeMemory(std::string *ErrMsg) {
   return false;
 }
@@ -9,15 +9,20 @@
 
 #include "src/globals.h"
 #include "src/list-inl.h"
+#include "src/zone.h"
 
 namespace v8 {
 namespace internal {
 
+// All the sections are bump-allocated in a zone which outlives the memory
+// manager (and the engine owning it). The code gets copied into the heap
+// before it is executed, so the zone can be reset after installation and
+// its memory reused for the next compilation.
 class MCJITMemoryManager : public llvm::RTDyldMemoryManager {
  public:
-  static std::unique_ptr<MCJITMemoryManager> Create();
+  static std::unique_ptr<MCJITMemoryManager> Create(Zone* zone);
 
-  MCJITMemoryManager();
+  explicit MCJITMemoryManager(Zone* zone);
   virtual ~MCJITMemoryManager();
 
   // Allocate a memory block of (at least) the given size suitable for
@@ -59,17 +64,25 @@ class MCJITMemoryManager : public llvm::RTDyldMemoryManager {
   // Returns true if an error occurred, false otherwise.
   bool finalizeMemory(std::string *ErrMsg) override;
 
-  CodeDesc& LastAllocatedCode() { return allocated_code_.last(); }
+  // Describes the code from |address| up to the end of the code section
+  // containing it.
+  CodeDesc CodeStartingAt(byte* address);
 
-  List<byte*>& stackmaps() { return stackmaps_; }
+  // The .llvm_stackmaps sections.
+  List<Vector<byte>>& stackmaps() { return stackmaps_; }
 
   void DropStackmaps() { stackmaps_.Free(); }
+
+  // Contents of the LLVMRelocationData::kRelocRecordsSectionName section
+  // (empty if the code embeds no objects).
+  Vector<byte> reloc_records() { return reloc_records_; }
  private:
-  // TODO(llvm): is it OK to allocate those in the zone?
+  byte* Allocate(uintptr_t size, unsigned alignment);
+
+  Zone* zone_;
   List<CodeDesc> allocated_code_;
-  List<byte*> allocated_data_;
-  List<byte*> stackmaps_;
-//  Zone* zone_;
+  List<Vector<byte>> stackmaps_;
+  Vector<byte> reloc_records_;
 };
 
 } }  // namespace v8::internal
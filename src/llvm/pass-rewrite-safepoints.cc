@@ -25,6 +25,10 @@ using namespace llvm;
 
 static bool ClobberNonLive = false;
 
+// Longest chain of casts and constant-offset GEPs we are willing to recompute
+// after a statepoint instead of relocating its result.
+static const unsigned ChainLengthThreshold = 10;
+
 #ifdef DEBUG
 // Print the liveset found at the insert location
 static bool PrintLiveSet = true;
@@ -1151,6 +1155,95 @@ static void splitVectorValues(Instruction *StatepointInst,
   PromoteMemToReg(Allocas, DT);
 }
 
+// Collect the chain of no-op casts and constant-offset GEPs leading from
+// CurrentValue to its root (the first value which is neither). Instructions
+// are pushed from the derived value towards the root.
+static Value* findRematerializableChainToRoot(
+    SmallVectorImpl<Instruction*> &ChainToRoot, Value *CurrentValue) {
+  if (auto GEP = dyn_cast<GetElementPtrInst>(CurrentValue)) {
+    if (!GEP->hasAllConstantIndices())
+      return nullptr;
+    ChainToRoot.push_back(GEP);
+    return findRematerializableChainToRoot(ChainToRoot,
+                                           GEP->getPointerOperand());
+  }
+  if (auto CI = dyn_cast<CastInst>(CurrentValue)) {
+    if (!CI->isNoopCast(CI->getModule()->getDataLayout()))
+      return nullptr;
+    ChainToRoot.push_back(CI);
+    return findRematerializableChainToRoot(ChainToRoot, CI->getOperand(0));
+  }
+  return CurrentValue;
+}
+
+// Every live value costs a spill slot and a reload around the statepoint.
+// Values which are cheap to recompute from another value which is relocated
+// anyway (its root) are dropped from the liveset and recomputed right after
+// the statepoint instead. relocationViaAlloca then takes care of feeding the
+// relocated root into the recomputed chain.
+static void rematerializeLiveValues(CallSite CS,
+                                    PartiallyConstructedSafepointRecord &Info) {
+  SmallVector<Value *, 32> LiveValuesToBeDeleted;
+
+  for (Value *LiveValue: Info.liveset) {
+    SmallVector<Instruction *, 3> ChainToRoot;
+    Value* Root = findRematerializableChainToRoot(ChainToRoot, LiveValue);
+    // The root must survive the statepoint on its own, otherwise there is
+    // nothing to gain.
+    if (!Root || ChainToRoot.empty() ||
+        ChainToRoot.size() > ChainLengthThreshold ||
+        !Info.liveset.count(Root))
+      continue;
+
+    // Clone the chain root-first so that each clone uses the previous one.
+    auto rematerializeChain = [&ChainToRoot](Instruction *InsertBefore) {
+      Instruction *LastClonedValue = nullptr;
+      Instruction *LastValue = nullptr;
+      for (auto It = ChainToRoot.rbegin(); It != ChainToRoot.rend(); ++It) {
+        Instruction *Instr = *It;
+        Instruction *ClonedValue = Instr->clone();
+        ClonedValue->insertBefore(InsertBefore);
+        ClonedValue->setName(Instr->getName() + ".remat");
+        if (LastClonedValue) {
+          DCHECK(LastValue);
+          ClonedValue->replaceUsesOfWith(LastValue, LastClonedValue);
+        }
+        LastClonedValue = ClonedValue;
+        LastValue = Instr;
+      }
+      DCHECK(LastClonedValue);
+      return LastClonedValue;
+    };
+
+    if (CS.isCall()) {
+      Instruction *InsertBefore = CS.getInstruction()->getNextNode();
+      DCHECK(InsertBefore);
+      Instruction *RematerializedValue = rematerializeChain(InsertBefore);
+      Info.RematerializedValues[RematerializedValue] = LiveValue;
+    } else {
+      InvokeInst *Invoke = cast<InvokeInst>(CS.getInstruction());
+
+      Instruction *NormalInsertBefore =
+          &*(Invoke->getNormalDest()->getFirstInsertionPt());
+      Instruction *UnwindInsertBefore =
+          &*(Invoke->getUnwindDest()->getFirstInsertionPt());
+
+      Instruction *NormalRematerializedValue =
+          rematerializeChain(NormalInsertBefore);
+      Instruction *UnwindRematerializedValue =
+          rematerializeChain(UnwindInsertBefore);
+
+      Info.RematerializedValues[NormalRematerializedValue] = LiveValue;
+      Info.RematerializedValues[UnwindRematerializedValue] = LiveValue;
+    }
+
+    LiveValuesToBeDeleted.push_back(LiveValue);
+  }
+
+  for (auto LiveValue: LiveValuesToBeDeleted)
+    Info.liveset.erase(LiveValue);
+}
+
 static bool insertParsePoints(Function &F, DominatorTree &DT, Pass *P,
                               SmallVectorImpl<CallSite> &toUpdate,
                               ValueSet& gc_collected_pointers) {
@@ -1190,6 +1283,8 @@ static bool insertParsePoints(Function &F, DominatorTree &DT, Pass *P,
   // for the actual safepoint insertion.  This ensures reference arguments in
   // the deopt argument list are considered live through the safepoint (and
   // thus makes sure they get relocated.)
+  // Our gc pointers live in address space 0, so they are told by the set
+  // rather than by their type (see LLVMChunk::RewriteStatePoints).
   for (size_t i = 0; i < toUpdate.size(); i++) {
     CallSite &CS = toUpdate[i];
     Statepoint StatepointCS(CS);
@@ -1197,7 +1292,7 @@ static bool insertParsePoints(Function &F, DominatorTree &DT, Pass *P,
     SmallVector<Value *, 64> DeoptValues;
     for (Use &U : StatepointCS.vm_state_args()) {
       Value *Arg = cast<Value>(&U);
-      if (isHandledGCPointerType(Arg->getType()))
+      if (gc_collected_pointers.count(Arg))
         DeoptValues.push_back(Arg);
     }
     insertUseHolderAfter(CS, DeoptValues, holders);
@@ -1262,6 +1357,11 @@ static bool insertParsePoints(Function &F, DominatorTree &DT, Pass *P,
     splitVectorValues(cast<Instruction>(statepoint), info.liveset, DT);
   }
 
+  // Shrink the livesets: whatever can be cheaply recomputed from a relocated
+  // value doesn't need a stack slot of its own.
+  for (size_t i = 0; i < records.size(); i++)
+    rematerializeLiveValues(toUpdate[i], records[i]);
+
   // Now run through and replace the existing statepoints with new ones with
   // the live variables listed.  We do not yet update uses of the values being
   // relocated. We have references to live variables that need to
@@ -5138,6 +5138,21 @@ void Code::set_has_reloc_info_for_serialization(bool value) {
 }
 
 
+bool Code::tier_up_to_llvm() {
+  DCHECK_EQ(FUNCTION, kind());
+  unsigned flags = READ_UINT32_FIELD(this, kFullCodeFlags);
+  return FullCodeFlagsTierUpToLLVMField::decode(flags);
+}
+
+
+void Code::set_tier_up_to_llvm(bool value) {
+  DCHECK_EQ(FUNCTION, kind());
+  unsigned flags = READ_UINT32_FIELD(this, kFullCodeFlags);
+  flags = FullCodeFlagsTierUpToLLVMField::update(flags, value);
+  WRITE_UINT32_FIELD(this, kFullCodeFlags, flags);
+}
+
+
 int Code::allow_osr_at_loop_nesting_level() {
   DCHECK_EQ(FUNCTION, kind());
   int fields = READ_UINT32_FIELD(this, kKindSpecificFlags2Offset);
@@ -4909,6 +4909,11 @@ class Code: public HeapObject {
   inline bool has_reloc_info_for_serialization();
   inline void set_has_reloc_info_for_serialization(bool value);
 
+  // [tier_up_to_llvm]: For FUNCTION kind, tells if the function has been
+  // hot enough in its Crankshaft code to be recompiled with LLVM.
+  inline bool tier_up_to_llvm();
+  inline void set_tier_up_to_llvm(bool value);
+
   // [allow_osr_at_loop_nesting_level]: For FUNCTION kind, tells for
   // how long the function has been marked for OSR and therefore which
   // level of loop nesting we are willing to do on-stack replacement
@@ -5191,7 +5196,7 @@ class Code: public HeapObject {
   class FullCodeFlagsHasDebugBreakSlotsField: public BitField<bool, 1, 1> {};
   class FullCodeFlagsHasRelocInfoForSerialization
       : public BitField<bool, 2, 1> {};
-  // Bit 3 in this bitfield is unused.
+  class FullCodeFlagsTierUpToLLVMField : public BitField<bool, 3, 1> {};
   class ProfilerTicksField : public BitField<int, 4, 28> {};
 
   // Flags layout.  BitField<type, shift, size>.
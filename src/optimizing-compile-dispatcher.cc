@@ -5,6 +5,7 @@
 #include "src/optimizing-compile-dispatcher.h"
 
 #include "src/base/atomicops.h"
+#include "src/base/platform/elapsed-timer.h"
 #include "src/full-codegen/full-codegen.h"
 #include "src/hydrogen.h"
 #include "src/isolate.h"
@@ -32,6 +33,7 @@ void DisposeOptimizedCompileJob(OptimizedCompileJob* job,
       function->ReplaceCode(function->shared()->code());
     }
   }
+  job->ReleaseLLVMChunk();
   delete info;
 }
 
@@ -40,7 +42,8 @@ void DisposeOptimizedCompileJob(OptimizedCompileJob* job,
 
 class OptimizingCompileDispatcher::CompileTask : public v8::Task {
  public:
-  explicit CompileTask(Isolate* isolate) : isolate_(isolate) {
+  CompileTask(Isolate* isolate, int worker_id)
+      : isolate_(isolate), worker_id_(worker_id) {
     OptimizingCompileDispatcher* dispatcher =
         isolate_->optimizing_compile_dispatcher();
     base::LockGuard<base::Mutex> lock_guard(&dispatcher->ref_count_mutex_);
@@ -58,7 +61,10 @@ class OptimizingCompileDispatcher::CompileTask : public v8::Task {
 
     OptimizingCompileDispatcher* dispatcher =
         isolate_->optimizing_compile_dispatcher();
-    {
+    WorkerStats* stats = &dispatcher->workers_[worker_id_];
+    // Keep draining the input queue (hottest job first) until it is empty.
+    // While flushing, NextInput() disposes of the jobs instead.
+    do {
       TimerEventScope<TimerEventRecompileConcurrent> timer(isolate_);
 
       if (dispatcher->recompilation_delay_ != 0) {
@@ -66,8 +72,22 @@ class OptimizingCompileDispatcher::CompileTask : public v8::Task {
             dispatcher->recompilation_delay_));
       }
 
-      dispatcher->CompileNext(dispatcher->NextInput(true));
-    }
+      OptimizedCompileJob* job = dispatcher->NextInput(true);
+      if (job == NULL) continue;
+      // The job belongs to the main thread as soon as CompileNext() queues
+      // it for install, so look at it beforehand.  LLVM jobs come by twice
+      // (see OptimizedCompileJob::LowerToLLVM) but only count once.
+      bool first_trip = !job->graph_optimized();
+      bool use_llvm = job->use_llvm();
+      base::ElapsedTimer compile_timer;
+      compile_timer.Start();
+      dispatcher->CompileNext(job);
+      stats->time_compiling += compile_timer.Elapsed();
+      if (first_trip) {
+        stats->jobs++;
+        if (use_llvm) stats->llvm_jobs++;
+      }
+    } while (!dispatcher->ReleaseWorkerIfIdle(worker_id_));
     {
       base::LockGuard<base::Mutex> lock_guard(&dispatcher->ref_count_mutex_);
       if (--dispatcher->ref_count_ == 0) {
@@ -77,6 +97,7 @@ class OptimizingCompileDispatcher::CompileTask : public v8::Task {
   }
 
   Isolate* isolate_;
+  int worker_id_;
 
   DISALLOW_COPY_AND_ASSIGN(CompileTask);
 };
@@ -91,6 +112,8 @@ OptimizingCompileDispatcher::~OptimizingCompileDispatcher() {
 #endif
   DCHECK_EQ(0, input_queue_length_);
   DeleteArray(input_queue_);
+  DeleteArray(input_queue_priority_);
+  DeleteArray(workers_);
   if (FLAG_concurrent_osr) {
 #ifdef DEBUG
     for (int i = 0; i < osr_buffer_capacity_; i++) {
@@ -106,8 +129,22 @@ OptimizedCompileJob* OptimizingCompileDispatcher::NextInput(
     bool check_if_flushing) {
   base::LockGuard<base::Mutex> access_input_queue_(&input_queue_mutex_);
   if (input_queue_length_ == 0) return NULL;
-  OptimizedCompileJob* job = input_queue_[InputQueueIndex(0)];
+  // Pick the hottest job, the earliest queued one among equals.
+  int hottest = 0;
+  for (int i = 1; i < input_queue_length_; i++) {
+    if (input_queue_priority_[InputQueueIndex(i)] >
+        input_queue_priority_[InputQueueIndex(hottest)]) {
+      hottest = i;
+    }
+  }
+  OptimizedCompileJob* job = input_queue_[InputQueueIndex(hottest)];
   DCHECK_NOT_NULL(job);
+  // Close the gap by moving the jobs in front of it back by one.
+  for (int i = hottest; i > 0; i--) {
+    input_queue_[InputQueueIndex(i)] = input_queue_[InputQueueIndex(i - 1)];
+    input_queue_priority_[InputQueueIndex(i)] =
+        input_queue_priority_[InputQueueIndex(i - 1)];
+  }
   input_queue_shift_ = InputQueueIndex(1);
   input_queue_length_--;
   if (check_if_flushing) {
@@ -190,7 +227,8 @@ void OptimizingCompileDispatcher::Stop() {
   {
     base::LockGuard<base::Mutex> lock_guard(&ref_count_mutex_);
     while (ref_count_ > 0) ref_count_zero_.Wait(&ref_count_mutex_);
-    base::Release_Store(&mode_, static_cast<base::AtomicWord>(COMPILE));
+    // Stay in FLUSH mode so that InstallOptimizedFunctions() compiles LLVM
+    // jobs right away rather than requeue them for workers that are gone.
   }
 
   if (recompilation_delay_ != 0) {
@@ -208,6 +246,18 @@ void OptimizingCompileDispatcher::Stop() {
       FLAG_concurrent_osr) {
     PrintF("[COSR hit rate %d / %d]\n", osr_hits_, osr_attempts_);
   }
+
+  if (FLAG_trace_opt_stats) PrintWorkerStats();
+}
+
+
+void OptimizingCompileDispatcher::PrintWorkerStats() {
+  for (int i = 0; i < max_workers_; i++) {
+    WorkerStats* stats = &workers_[i];
+    PrintF("[concurrent recompilation worker %d: %d jobs (%d LLVM)"
+           " in %0.3f ms]\n", i, stats->jobs, stats->llvm_jobs,
+           stats->time_compiling.InMillisecondsF());
+  }
 }
 
 
@@ -231,13 +281,18 @@ void OptimizingCompileDispatcher::InstallOptimizedFunctions() {
         PrintF(" is ready for install and entry at AST id %d]\n",
                info->osr_ast_id().ToInt());
       }
+      if (LowerToLLVM(job)) continue;
       job->WaitForInstall();
       // Remove stack check that guards OSR entry on original code.
       Handle<Code> code = info->unoptimized_code();
       uint32_t offset = code->TranslateAstIdToPcOffset(info->osr_ast_id());
       BackEdgeTable::RemoveStackCheck(code, offset);
     } else {
-      if (function->IsOptimized()) {
+      // Functions promoted to LLVM keep running their Crankshaft code
+      // while they are being recompiled (see Compiler::GetOptimizedCode).
+      bool promoted = job->use_llvm() && function->IsOptimized() &&
+                      !function->code()->is_llvmed();
+      if (function->IsOptimized() && !promoted) {
         if (FLAG_trace_concurrent_recompilation) {
           PrintF("  ** Aborting compilation for ");
           function->ShortPrint();
@@ -245,15 +300,56 @@ void OptimizingCompileDispatcher::InstallOptimizedFunctions() {
         }
         DisposeOptimizedCompileJob(job, false);
       } else {
+        if (LowerToLLVM(job)) continue;
         Handle<Code> code = Compiler::GetConcurrentlyOptimizedCode(job);
-        function->ReplaceCode(code.is_null() ? function->shared()->code()
-                                             : *code);
+        if (!code.is_null()) {
+          function->ReplaceCode(*code);
+        } else if (!promoted) {
+          function->ReplaceCode(function->shared()->code());
+        }
       }
     }
   }
 }
 
 
+bool OptimizingCompileDispatcher::LowerToLLVM(OptimizedCompileJob* job) {
+  if (!job->IsAwaitingLLVMLowering()) return false;
+  if (job->LowerToLLVM() != OptimizedCompileJob::SUCCEEDED) return false;
+  if (RequeueForOptimization(job)) return true;
+  // No room (or no workers) left, so finish the job here.
+  OptimizedCompileJob::Status status = job->OptimizeGraph();
+  USE(status);  // Prevent an unused-variable error in release mode.
+  DCHECK(status != OptimizedCompileJob::FAILED);
+  return false;
+}
+
+
+bool OptimizingCompileDispatcher::RequeueForOptimization(
+    OptimizedCompileJob* job) {
+  if (static_cast<ModeFlag>(base::Acquire_Load(&mode_)) == FLUSH) {
+    return false;
+  }
+  {
+    base::LockGuard<base::Mutex> access_input_queue(&input_queue_mutex_);
+    if (input_queue_length_ == input_queue_capacity_) return false;
+    // Add job to the front of the input queue.  OSR jobs are still in the
+    // OSR buffer from the first trip.
+    input_queue_shift_ = InputQueueIndex(input_queue_capacity_ - 1);
+    input_queue_[InputQueueIndex(0)] = job;
+    // Half done already, and maybe keeping its Crankshaft code waiting.
+    input_queue_priority_[InputQueueIndex(0)] = kMaxInt;
+    input_queue_length_++;
+  }
+  if (FLAG_block_concurrent_recompilation) {
+    blocked_jobs_++;
+  } else {
+    StartWorkerIfNeeded();
+  }
+  return true;
+}
+
+
 void OptimizingCompileDispatcher::QueueForOptimization(
     OptimizedCompileJob* job) {
   DCHECK(IsQueueAvailable());
@@ -267,32 +363,64 @@ void OptimizingCompileDispatcher::QueueForOptimization(
     // Move shift_ back by one.
     input_queue_shift_ = InputQueueIndex(input_queue_capacity_ - 1);
     input_queue_[InputQueueIndex(0)] = job;
+    // Somebody is stuck in a loop waiting for this one.
+    input_queue_priority_[InputQueueIndex(0)] = kMaxInt;
     input_queue_length_++;
   } else {
+    // The more often the runtime profiler has seen the function on the
+    // stack, the sooner we want its optimized code.
+    int priority = info->shared_info()->profiler_ticks();
     // Add job to the back of the input queue.
     base::LockGuard<base::Mutex> access_input_queue(&input_queue_mutex_);
     DCHECK_LT(input_queue_length_, input_queue_capacity_);
     input_queue_[InputQueueIndex(input_queue_length_)] = job;
+    input_queue_priority_[InputQueueIndex(input_queue_length_)] = priority;
     input_queue_length_++;
   }
   if (FLAG_block_concurrent_recompilation) {
     blocked_jobs_++;
   } else {
-    V8::GetCurrentPlatform()->CallOnBackgroundThread(
-        new CompileTask(isolate_), v8::Platform::kShortRunningTask);
+    StartWorkerIfNeeded();
   }
 }
 
 
 void OptimizingCompileDispatcher::Unblock() {
   while (blocked_jobs_ > 0) {
-    V8::GetCurrentPlatform()->CallOnBackgroundThread(
-        new CompileTask(isolate_), v8::Platform::kShortRunningTask);
+    StartWorkerIfNeeded();
     blocked_jobs_--;
   }
 }
 
 
+void OptimizingCompileDispatcher::StartWorkerIfNeeded() {
+  int worker_id = -1;
+  {
+    base::LockGuard<base::Mutex> access_input_queue(&input_queue_mutex_);
+    for (int i = 0; i < max_workers_; i++) {
+      if (!workers_[i].busy) {
+        workers_[i].busy = true;
+        worker_id = i;
+        break;
+      }
+    }
+  }
+  // All the workers are busy, one of them will pick the job up.
+  if (worker_id < 0) return;
+  V8::GetCurrentPlatform()->CallOnBackgroundThread(
+      new CompileTask(isolate_, worker_id), v8::Platform::kShortRunningTask);
+}
+
+
+bool OptimizingCompileDispatcher::ReleaseWorkerIfIdle(int worker_id) {
+  base::LockGuard<base::Mutex> access_input_queue(&input_queue_mutex_);
+  if (input_queue_length_ > 0) return false;
+  DCHECK(workers_[worker_id].busy);
+  workers_[worker_id].busy = false;
+  return true;
+}
+
+
 OptimizedCompileJob* OptimizingCompileDispatcher::FindReadyOSRCandidate(
     Handle<JSFunction> function, BailoutId osr_ast_id) {
   for (int i = 0; i < osr_buffer_capacity_; i++) {
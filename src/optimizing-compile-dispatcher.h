@@ -34,9 +34,12 @@ class OptimizingCompileDispatcher {
         osr_attempts_(0),
         blocked_jobs_(0),
         ref_count_(0),
+        max_workers_(Max(1, FLAG_concurrent_recompilation_workers)),
         recompilation_delay_(FLAG_concurrent_recompilation_delay) {
     base::NoBarrier_Store(&mode_, static_cast<base::AtomicWord>(COMPILE));
     input_queue_ = NewArray<OptimizedCompileJob*>(input_queue_capacity_);
+    input_queue_priority_ = NewArray<int>(input_queue_capacity_);
+    workers_ = NewArray<WorkerStats>(max_workers_);
     if (FLAG_concurrent_osr) {
       // Allocate and mark OSR buffer slots as empty.
       osr_buffer_ = NewArray<OptimizedCompileJob*>(osr_buffer_capacity_);
@@ -77,11 +80,39 @@ class OptimizingCompileDispatcher {
 
   enum ModeFlag { COMPILE, FLUSH };
 
+  // Per-worker bookkeeping.  A slot is owned by at most one running
+  // CompileTask; its counters are only written by that task and are read
+  // on the main thread once all the workers have finished (see Stop()).
+  struct WorkerStats {
+    WorkerStats() : busy(false), jobs(0), llvm_jobs(0) {}
+    bool busy;
+    int jobs;
+    int llvm_jobs;
+    base::TimeDelta time_compiling;
+  };
+
   void FlushOutputQueue(bool restore_function_code);
   void FlushOsrBuffer(bool restore_function_code);
   void CompileNext(OptimizedCompileJob* job);
+
+  // Lowers an LLVM job that is back from its first trip to the concurrent
+  // thread (see OptimizedCompileJob::LowerToLLVM).  Returns true if the job
+  // went back to the input queue; otherwise it is ready for install.
+  bool LowerToLLVM(OptimizedCompileJob* job);
+  // Like QueueForOptimization() but at the front of the queue, and without
+  // touching the OSR buffer.  Returns false if the job can't be queued.
+  bool RequeueForOptimization(OptimizedCompileJob* job);
   OptimizedCompileJob* NextInput(bool check_if_flushing = false);
 
+  // Post a new CompileTask unless max_workers_ of them are already draining
+  // the input queue.
+  void StartWorkerIfNeeded();
+  // Called by a worker whose last NextInput() came back empty-handed.
+  // Returns true (and gives up the worker's slot) if there is nothing left
+  // to compile, so that a job queued afterwards starts a new worker.
+  bool ReleaseWorkerIfIdle(int worker_id);
+  void PrintWorkerStats();
+
   // Add a recompilation task for OSR to the cyclic buffer, awaiting OSR entry.
   // Tasks evicted from the cyclic buffer are discarded.
   void AddToOsrBuffer(OptimizedCompileJob* compiler);
@@ -96,7 +127,11 @@ class OptimizingCompileDispatcher {
   Isolate* isolate_;
 
   // Circular queue of incoming recompilation tasks (including OSR).
+  // NextInput() hands out the hottest job first rather than the oldest one.
   OptimizedCompileJob** input_queue_;
+  // Profiler ticks of the queued function at the time it was queued,
+  // indexed like input_queue_.  OSR jobs get kMaxInt.
+  int* input_queue_priority_;
   int input_queue_capacity_;
   int input_queue_length_;
   int input_queue_shift_;
@@ -124,6 +159,10 @@ class OptimizingCompileDispatcher {
   base::Mutex ref_count_mutex_;
   base::ConditionVariable ref_count_zero_;
 
+  // Pool of background workers, guarded by input_queue_mutex_.
+  int max_workers_;
+  WorkerStats* workers_;
+
   // Copy of FLAG_concurrent_recompilation_delay that will be used from the
   // background thread.
   //
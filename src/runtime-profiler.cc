@@ -13,6 +13,7 @@
 #include "src/frames-inl.h"
 #include "src/full-codegen/full-codegen.h"
 #include "src/global-handles.h"
+#include "src/llvm/llvm-chunk.h"
 #include "src/scopeinfo.h"
 
 namespace v8 {
@@ -105,6 +106,52 @@ void RuntimeProfiler::Optimize(JSFunction* function, const char* reason) {
 }
 
 
+void RuntimeProfiler::TierUpToLLVM(JSFunction* function, const char* reason) {
+  if (FLAG_trace_opt && function->PassesFilter(FLAG_hydrogen_filter)) {
+    PrintF("[marking ");
+    function->ShortPrint();
+    PrintF(" for llvm recompilation, reason: %s]\n", reason);
+  }
+
+  Code* unoptimized = function->shared()->code();
+  unoptimized->set_tier_up_to_llvm(true);
+  // Go through the regular recompilation path. The Crankshaft code stays in
+  // the optimized code map, Compiler::GetOptimizedCode() puts the function
+  // right back on it while LLVM is busy.
+  function->ReplaceCode(unoptimized);
+  function->AttemptConcurrentOptimization();
+}
+
+
+// static
+void RuntimeProfiler::ResetTierUpToLLVM(SharedFunctionInfo* shared) {
+  if (!FLAG_llvm_tier_up) return;
+  Code* shared_code = shared->code();
+  if (shared_code->kind() != Code::FUNCTION) return;
+  shared_code->set_tier_up_to_llvm(false);
+  shared_code->set_profiler_ticks(0);
+}
+
+
+void RuntimeProfiler::MaybeTierUpToLLVM(JSFunction* function) {
+  // Promote a function at most once (until it deoptimizes).
+  if (function->code()->is_llvmed()) return;
+  Code* shared_code = function->shared()->code();
+  if (shared_code->tier_up_to_llvm()) return;
+  // The ticks of the unoptimized code are reset once the Crankshaft code is
+  // installed and whenever the function deoptimizes (see ResetTierUpToLLVM),
+  // so from here on they count the time spent in the former without a deopt.
+  int ticks = shared_code->profiler_ticks();
+  // LLVM would not be used anyway (see OptimizedCompileJob::CreateGraph).
+  if (!LLVMChunk::SupportsFlags()) return;
+  if (ticks >= FLAG_llvm_tier_up_ticks) {
+    TierUpToLLVM(function, "hot and stable in crankshaft code");
+  } else {
+    shared_code->set_profiler_ticks(ticks + 1);
+  }
+}
+
+
 void RuntimeProfiler::AttemptOnStackReplacement(JSFunction* function,
                                                 int loop_nesting_levels) {
   SharedFunctionInfo* shared = function->shared();
@@ -215,7 +262,12 @@ void RuntimeProfiler::OptimizeNow() {
       }
       continue;
     }
-    if (function->IsOptimized()) continue;
+    if (function->IsOptimized()) {
+      // Functions still running unoptimized code were dealt with above,
+      // so this tick was spent in the optimized code.
+      if (FLAG_llvm_tier_up) MaybeTierUpToLLVM(function);
+      continue;
+    }
 
     int ticks = shared_code->profiler_ticks();
 
@@ -18,6 +18,7 @@ namespace internal {
 class Isolate;
 class JSFunction;
 class Object;
+class SharedFunctionInfo;
 
 class RuntimeProfiler {
  public:
@@ -29,8 +30,15 @@ class RuntimeProfiler {
 
   void AttemptOnStackReplacement(JSFunction* function, int nesting_levels = 1);
 
+  // Called when the optimized code of the function deoptimizes or is
+  // discarded: the function is no longer stable enough to be promoted
+  // to LLVM (see MaybeTierUpToLLVM), nor to stay promoted.
+  static void ResetTierUpToLLVM(SharedFunctionInfo* shared);
+
  private:
   void Optimize(JSFunction* function, const char* reason);
+  void TierUpToLLVM(JSFunction* function, const char* reason);
+  void MaybeTierUpToLLVM(JSFunction* function);
 
   bool CodeSizeOKForOSR(Code* shared_code);
 
@@ -280,8 +280,8 @@ RUNTIME_FUNCTION(Runtime_CompileForOnStackReplacement) {
     DeoptimizationInputData* data =
         DeoptimizationInputData::cast(result->deoptimization_data());
 
-    if (data->OsrPcOffset()->value() >= 0 || result->is_llvmed()) {
-      // DCHECK(BailoutId(data->OsrAstId()->value()) == ast_id);
+    if (data->OsrPcOffset()->value() >= 0) {
+      DCHECK(BailoutId(data->OsrAstId()->value()) == ast_id);
       if (FLAG_trace_osr) {
         PrintF("[OSR - Entry at AST id %d, offset %d in optimized code]\n",
                ast_id.ToInt(), data->OsrPcOffset()->value());
@@ -290,8 +290,10 @@ RUNTIME_FUNCTION(Runtime_CompileForOnStackReplacement) {
       // match. Fix heuristics for reenabling optimizations!
       function->shared()->increment_deopt_count();
 
-      if (result->is_turbofanned()) {
+      if (result->is_turbofanned() || result->is_llvmed()) {
         // TurboFanned OSR code cannot be installed into the function.
+        // Neither can llvmed one, which is only prepared to be entered
+        // through its OSR entry (see LLVMChunk::EmitOsrEntry).
         // But the function is obviously hot, so optimize it next time.
         function->ReplaceCode(
             isolate->builtins()->builtin(Builtins::kCompileOptimized));
@@ -862,6 +862,8 @@
         '../../src/lithium-inl.h',
         '../../src/llvm/llvm-chunk.cc',
         '../../src/llvm/llvm-chunk.h',
+        '../../src/llvm/llvm-code-cache.cc',
+        '../../src/llvm/llvm-code-cache.h',
         '../../src/llvm/llvm-headers.h',
         '../../src/llvm/llvm-stackmaps.cc',
         '../../src/llvm/llvm-stackmaps.h',